@@ -0,0 +1,254 @@
+/*
+ * DecodeSession.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeSession.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/DecodeResult.h"
+#include "decoder/WellDecoder.h"
+
+#include <dmtx.h>
+#include <OpenThreads/ScopedLock>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+namespace dmscanlib {
+
+const unsigned DecodeSession::PRIOR_MIN_WELLS = 24;
+
+const double DecodeSession::PRIOR_MIN_SHARE = 0.95;
+
+const unsigned DecodeSession::PRIOR_WINDOW = 960;
+
+DecodeSession::DecodeSession(unsigned loggingLevel) :
+        dmScanLib(loggingLevel, false),
+        symbolSizeTotal(0),
+        symbolSizePrior(DmtxSymbolSquareAuto),
+        palletCount(0)
+{
+    dmScanLib.setImageFilenames("", "");
+}
+
+DecodeSession::~DecodeSession() {
+}
+
+int DecodeSession::decodeImageWells(
+        const char * filename,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    return finishDecode(
+            dmScanLib.decodeImageWells(filename, *options, wellRects));
+}
+
+int DecodeSession::decodeImageWells(
+        const unsigned char * encodedImage,
+        unsigned length,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    return finishDecode(
+            dmScanLib.decodeImageWells(encodedImage, length, *options, wellRects));
+}
+
+int DecodeSession::decodeImageWells(
+        const unsigned char * pixels,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat format,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    return finishDecode(
+            dmScanLib.decodeImageWells(pixels, width, height, stride, format, *options,
+                    wellRects));
+}
+
+std::unique_ptr<const DecodeResult> DecodeSession::decode(
+        const char * filename,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    DmScanLib decodeLib;
+    decodeLib.setImageFilenames("", "");
+    const int result = decodeLib.decodeImageWells(filename, *options, wellRects);
+    return createResult(result, decodeLib);
+}
+
+std::unique_ptr<const DecodeResult> DecodeSession::decode(
+        const unsigned char * encodedImage,
+        unsigned length,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    DmScanLib decodeLib;
+    decodeLib.setImageFilenames("", "");
+    const int result = decodeLib.decodeImageWells(encodedImage, length, *options, wellRects);
+    return createResult(result, decodeLib);
+}
+
+std::unique_ptr<const DecodeResult> DecodeSession::decode(
+        const unsigned char * pixels,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat format,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    std::unique_ptr<DecodeOptions> options = createSessionOptions(decodeOptions);
+    DmScanLib decodeLib;
+    decodeLib.setImageFilenames("", "");
+    const int result = decodeLib.decodeImageWells(pixels, width, height, stride, format,
+            *options, wellRects);
+    return createResult(result, decodeLib);
+}
+
+/*
+ * The result is copied out before decodeLib, and the decoder it holds, go away.
+ */
+std::unique_ptr<const DecodeResult> DecodeSession::createResult(
+        int result, const DmScanLib & decodeLib) {
+    std::unique_ptr<const DecodeResult> decodeResult(new DecodeResult(
+            result, decodeLib.getDecodeReport(), decodeLib.getWellDecoders()));
+
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(priorMutex);
+        ++palletCount;
+    }
+
+    const std::map<std::string, const WellResult *> & decodedWells =
+            decodeResult->getDecodedWells();
+    for (std::map<std::string, const WellResult *>::const_iterator ii =
+            decodedWells.begin(); ii != decodedWells.end(); ++ii) {
+        addSymbolSize(ii->second->symbolSize);
+    }
+    return decodeResult;
+}
+
+int DecodeSession::finishDecode(int result) {
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(priorMutex);
+        ++palletCount;
+    }
+
+    if (result == SC_SUCCESS) {
+        const std::map<std::string, const WellDecoder *> & decodedWells = getDecodedWells();
+        for (std::map<std::string, const WellDecoder *>::const_iterator ii =
+                decodedWells.begin(); ii != decodedWells.end(); ++ii) {
+            addSymbolSize(ii->second->getSymbolSize());
+        }
+    }
+    return result;
+}
+
+const std::map<std::string, const WellDecoder *> & DecodeSession::getDecodedWells() const {
+    return dmScanLib.getDecodedWells();
+}
+
+const std::vector<std::unique_ptr<WellDecoder> > & DecodeSession::getWellDecoders() const {
+    return dmScanLib.getWellDecoders();
+}
+
+const DecodeReport & DecodeSession::getDecodeReport() const {
+    return dmScanLib.getDecodeReport();
+}
+
+int DecodeSession::getSymbolSizePrior() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(priorMutex);
+    return symbolSizePrior;
+}
+
+unsigned DecodeSession::getPalletCount() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(priorMutex);
+    return palletCount;
+}
+
+void DecodeSession::addSymbolSize(int symbolSize) {
+    if (symbolSize < 0) {
+        return;
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(priorMutex);
+
+    if (symbolSizeTotal >= PRIOR_WINDOW) {
+        symbolSizeTotal = 0;
+        for (std::map<int, unsigned>::iterator ii = symbolSizeCounts.begin();
+                ii != symbolSizeCounts.end(); ++ii) {
+            ii->second /= 2;
+            symbolSizeTotal += ii->second;
+        }
+    }
+
+    ++symbolSizeCounts[symbolSize];
+    ++symbolSizeTotal;
+    updateSymbolSizePrior();
+}
+
+/*
+ * Called with the prior mutex held.
+ */
+void DecodeSession::updateSymbolSizePrior() {
+    const int previousPrior = symbolSizePrior;
+    symbolSizePrior = DmtxSymbolSquareAuto;
+
+    if (symbolSizeTotal >= PRIOR_MIN_WELLS) {
+        for (std::map<int, unsigned>::const_iterator ii = symbolSizeCounts.begin();
+                ii != symbolSizeCounts.end(); ++ii) {
+            if (ii->second >= PRIOR_MIN_SHARE * symbolSizeTotal) {
+                symbolSizePrior = ii->first;
+                break;
+            }
+        }
+    }
+
+    if (symbolSizePrior != previousPrior) {
+        VLOG(2) << "symbol size prior: " << previousPrior << " -> " << symbolSizePrior;
+    }
+}
+
+/*
+ * With a prior, the ladder is the caller's one preceded by a copy of its first
+ * profile fixed to the learned symbol size.
+ */
+std::unique_ptr<DecodeOptions> DecodeSession::createSessionOptions(
+        const DecodeOptions & decodeOptions) const {
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    const int prior = getSymbolSizePrior();
+
+    std::vector<std::unique_ptr<const DecodeProfile> > sessionProfiles;
+    for (unsigned i = 0, n = profiles.size(); i < n; ++i) {
+        const DecodeProfile & profile = *profiles[i];
+        if ((i == 0) && (prior != DmtxSymbolSquareAuto)
+                && (profile.symbolSize == DmtxSymbolSquareAuto)) {
+            sessionProfiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+                    profile.scale,
+                    profile.scanGapFactor,
+                    profile.squareDev,
+                    profile.edgeThresh,
+                    profile.corrections,
+                    profile.subPixel,
+                    prior)));
+        }
+        sessionProfiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+                profile.scale,
+                profile.scanGapFactor,
+                profile.squareDev,
+                profile.edgeThresh,
+                profile.corrections,
+                profile.subPixel,
+                profile.symbolSize)));
+    }
+
+    std::unique_ptr<DecodeOptions> options(new DecodeOptions(
+            decodeOptions.minEdgeFactor, decodeOptions.maxEdgeFactor, sessionProfiles));
+    options->setSpeculativeDecode(decodeOptions.getSpeculativeDecode());
+    return options;
+}
+
+} /* namespace */
@@ -0,0 +1,140 @@
+#ifndef DECODESESSION_H_
+#define DECODESESSION_H_
+
+/*
+ * DecodeSession.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <OpenThreads/Mutex>
+
+namespace dmscanlib {
+
+class DecodeResult;
+
+/**
+ * Decodes a sequence of pallets with the same DmScanLib, so that the scanner,
+ * the logging configuration and the state learned from earlier pallets are kept
+ * from one decode to the next. Used by the Java API, which holds a session as a
+ * handle for as long as the scanner is in use.
+ *
+ * The session learns the symbol size of the tubes: once nearly all the wells it
+ * has decoded used the same DmtxSymbolSize, every pallet is first tried with the
+ * first profile fixed to that size. Wells that do not decode with it go through
+ * the caller's ladder unchanged, so a wrong prior costs time but not wells.
+ *
+ * The decodeImageWells() methods keep the results of the most recent decode in
+ * the session, so they must not be called by more than one thread at once. The
+ * decode() methods are reentrant: each call decodes with its own DmScanLib and
+ * returns its own DecodeResult, so several threads may decode different pallets
+ * with the same session, sharing the learned prior.
+ *
+ * Sessions decode at the same time as each other, so they do not write the
+ * scanned.png and decode.png files a DmScanLib writes by default.
+ */
+class DecodeSession {
+public:
+    DecodeSession(unsigned loggingLevel);
+
+    virtual ~DecodeSession();
+
+    int decodeImageWells(
+            const char * filename,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    int decodeImageWells(
+            const unsigned char * encodedImage,
+            unsigned length,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    int decodeImageWells(
+            const unsigned char * pixels,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    std::unique_ptr<const DecodeResult> decode(
+            const char * filename,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    std::unique_ptr<const DecodeResult> decode(
+            const unsigned char * encodedImage,
+            unsigned length,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    std::unique_ptr<const DecodeResult> decode(
+            const unsigned char * pixels,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    /*
+     * The results of the most recent decodeImageWells().
+     */
+    const std::map<std::string, const WellDecoder *> & getDecodedWells() const;
+
+    const std::vector<std::unique_ptr<WellDecoder> > & getWellDecoders() const;
+
+    const DecodeReport & getDecodeReport() const;
+
+    /*
+     * Returns the learned symbol size, or DmtxSymbolSquareAuto while there is none.
+     */
+    int getSymbolSizePrior() const;
+
+    /*
+     * Counts one decoded well of the given symbol size towards the prior.
+     */
+    void addSymbolSize(int symbolSize);
+
+    unsigned getPalletCount() const;
+
+    // decoded wells needed before a prior is used
+    static const unsigned PRIOR_MIN_WELLS;
+
+    // fraction of the decoded wells that must share the symbol size
+    static const double PRIOR_MIN_SHARE;
+
+    // the counts are halved past this many wells, so the prior follows a change of tubes
+    static const unsigned PRIOR_WINDOW;
+
+private:
+    std::unique_ptr<DecodeOptions> createSessionOptions(
+            const DecodeOptions & decodeOptions) const;
+
+    int finishDecode(int result);
+
+    std::unique_ptr<const DecodeResult> createResult(int result, const DmScanLib & decodeLib);
+
+    void updateSymbolSizePrior();
+
+    DmScanLib dmScanLib;
+    std::map<int, unsigned> symbolSizeCounts;
+    unsigned symbolSizeTotal;
+    int symbolSizePrior;
+    unsigned palletCount;
+
+    // guards the prior and the pallet count
+    mutable OpenThreads::Mutex priorMutex;
+};
+
+} /* namespace */
+
+#endif /* DECODESESSION_H_ */
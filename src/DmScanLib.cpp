@@ -30,17 +30,29 @@
 #include "DmScanLib.h"
 #include "imgscanner/ImgScanner.h"
 #include "decoder/Decoder.h"
+#include "decoder/DecodeCapture.h"
 #include "decoder/DecodeOptions.h"
+#include "decoder/DecodePlan.h"
+#include "decoder/DecodeReport.h"
+#include "decoder/ImageCache.h"
+#include "decoder/ThreadMgr.h"
 #include "decoder/WellDecoder.h"
 #include "Image.h"
+#include "utils/DmClock.h"
+#include "utils/DmProbes.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/PerfCounters.h"
+#include "utils/TraceRecorder.h"
 
 #include <stdio.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 #include <glog/logging.h>
+#include <OpenThreads/ScopedLock>
 
 #if defined(USE_NVWA)
 #   include "debug_new.h"
@@ -52,13 +64,27 @@ const std::string DmScanLib::LIBRARY_NAME("dmscanlib");
 
 bool DmScanLib::loggingInitialized = false;
 
+OpenThreads::Mutex DmScanLib::staticMutex;
+
+bool DmScanLib::traceActive = false;
+
+std::string DmScanLib::metricsFilename;
+std::string DmScanLib::traceFilename;
+std::string DmScanLib::heatmapFilename;
+
 DmScanLib::DmScanLib() :
-        imgScanner(std::move(ImgScanner::create()))
+        imgScanner(std::move(ImgScanner::create())),
+        tracing(false),
+        scannedImageFilename("scanned.png"),
+        decodedImageFilename("decode.png")
 {
 }
 
 DmScanLib::DmScanLib(unsigned loggingLevel, bool logToFile) :
-        imgScanner(std::move(ImgScanner::create()))
+        imgScanner(std::move(ImgScanner::create())),
+        tracing(false),
+        scannedImageFilename("scanned.png"),
+        decodedImageFilename("decode.png")
 {
     configLogging(loggingLevel, logToFile);
 }
@@ -78,6 +104,7 @@ int DmScanLib::getScannerCapability() {
 }
 
 void DmScanLib::configLogging(unsigned level, bool useFile) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
     if (loggingInitialized)
         return;
 
@@ -91,6 +118,57 @@ void DmScanLib::configLogging(unsigned level, bool useFile) {
     loggingInitialized = true;
 }
 
+void DmScanLib::setImageFilenames(
+        const std::string & scannedFilename,
+        const std::string & decodedFilename) {
+    scannedImageFilename = scannedFilename;
+    decodedImageFilename = decodedFilename;
+}
+
+void DmScanLib::setMetricsFilename(const std::string & filename) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+    metricsFilename = filename;
+}
+
+void DmScanLib::setTraceFilename(const std::string & filename) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+    traceFilename = filename;
+}
+
+void DmScanLib::setHeatmapFilename(const std::string & filename) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+    heatmapFilename = filename;
+}
+
+void DmScanLib::setDecodeThreadCount(unsigned count) {
+    decoder::ThreadMgr::setThreadCount(count);
+}
+
+void DmScanLib::setImageCacheSize(size_t bytes) {
+    decoder::ImageCache::getInstance().setMaxBytes(bytes);
+}
+
+void DmScanLib::invalidateImageCache(const std::string & filename) {
+    decoder::ImageCache & cache = decoder::ImageCache::getInstance();
+    if (filename.empty()) {
+        cache.clear();
+    } else {
+        cache.invalidate(filename);
+    }
+}
+
+void DmScanLib::setPerfCountersEnabled(bool enable) {
+    util::PerfCounters::setEnabled(enable);
+}
+
+void DmScanLib::setCapture(
+        const std::string & directory,
+        unsigned sampleEvery,
+        unsigned latencyThresholdMillis,
+        bool wellsOnly) {
+    DecodeCapture::configure(directory, sampleEvery, latencyThresholdMillis, wellsOnly);
+}
+
 int DmScanLib::scanImage(
         const unsigned dpi,
         const int brightness,
@@ -162,19 +240,41 @@ int DmScanLib::scanAndDecode(
 
     HANDLE h;
     int result;
+    const util::dmUint64 start = util::DmClock::nowNanos();
 
-    h = imgScanner->acquireImage(dpi, brightness, contrast, region);
+    startDecode();
+    const TraceGuard traceGuard(*this);
+    {
+        StageTimer timer(*decodeReport, STAGE_IMAGE_LOAD);
+        h = imgScanner->acquireImage(dpi, brightness, contrast, region);
+    }
     if (h == NULL) {
         VLOG(1) << "could not acquire image";
         return imgScanner->getErrorCode();
     }
 
-    Image image(h);
-    image.write("scanned.png");
-    result = decodeCommon(image, decodeOptions, "decode.png", wellRects);
-
+    // the image has its own copy of the pixels
+    std::unique_ptr<Image> image;
+    try {
+        StageTimer timer(*decodeReport, STAGE_IMAGE_LOAD);
+        image = std::unique_ptr<Image>(new Image(h));
+    } catch (...) {
+        imgScanner->freeImage(h);
+        throw;
+    }
     imgScanner->freeImage(h);
+
+    if (!scannedImageFilename.empty()) {
+        image->write(scannedImageFilename);
+    }
+    std::shared_ptr<const DecodePlan> plan(new DecodePlan(decodeOptions, wellRects));
+    result = decodeCommon(*image, std::shared_ptr<const Image>(), plan, decodedImageFilename);
+
+    decodeReport->setTotalNanos(util::DmClock::nowNanos() - start);
+    recordMetrics();
+    captureDecode(*image, *plan, result);
     VLOG(1) << "decodeCommon returned: " << result;
+    VLOG(2) << "decode report: " << *decodeReport;
     return result;
 }
 
@@ -183,26 +283,184 @@ int DmScanLib::decodeImageWells(
         const DecodeOptions & decodeOptions,
         std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
 
+    return decodeImageWells(filename, std::shared_ptr<const DecodePlan>(
+            new DecodePlan(decodeOptions, wellRects)));
+}
+
+int DmScanLib::decodeImageWells(
+        const char * filename,
+        const std::shared_ptr<const DecodePlan> & plan) {
+
     VLOG(1) << "decodeImageWells: filename/" << filename
-            << " numWellRects/" << wellRects.size()
-            << " " << decodeOptions;
+            << " numWellRects/" << plan->getWellRects().size()
+            << " " << plan->getDecodeOptions();
+
+    const util::dmUint64 start = util::DmClock::nowNanos();
+    startDecode();
+    const TraceGuard traceGuard(*this);
+    std::shared_ptr<const decoder::CachedImage> cached = loadImage(filename);
+    return decodeLoadedImage(start, *cached->image, cached->workingImage, plan);
+}
+
+/*
+ * With the image cache on, a file that has not changed since it was last decoded
+ * is neither loaded nor filtered again. Otherwise the working image is left for
+ * the decoder to make.
+ */
+std::shared_ptr<const decoder::CachedImage> DmScanLib::loadImage(const char * filename) {
+    decoder::ImageCache & cache = decoder::ImageCache::getInstance();
+    decoder::ImageCache::Key key;
+    const bool cacheable = cache.isEnabled() && decoder::ImageCache::getKey(filename, key);
+    if (cacheable) {
+        std::shared_ptr<const decoder::CachedImage> cached = cache.find(key);
+        if (cached.get() != NULL) {
+            return cached;
+        }
+    }
+
+    std::shared_ptr<const Image> image;
+    {
+        StageTimer timer(*decodeReport, STAGE_IMAGE_LOAD);
+        image = std::shared_ptr<const Image>(new Image(filename));
+    }
+    if (!cacheable || !image->isValid()) {
+        return std::shared_ptr<const decoder::CachedImage>(
+                new decoder::CachedImage(image, std::shared_ptr<const Image>()));
+    }
+
+    std::shared_ptr<const decoder::CachedImage> cached(new decoder::CachedImage(
+            image, Decoder::createWorkingImage(*image, *decodeReport)));
+    cache.insert(key, cached);
+    return cached;
+}
+
+int DmScanLib::decodeImageWells(
+        const unsigned char * encodedImage,
+        unsigned length,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+
+    return decodeImageWells(encodedImage, length, std::shared_ptr<const DecodePlan>(
+            new DecodePlan(decodeOptions, wellRects)));
+}
+
+int DmScanLib::decodeImageWells(
+        const unsigned char * encodedImage,
+        unsigned length,
+        const std::shared_ptr<const DecodePlan> & plan) {
+
+    VLOG(1) << "decodeImageWells: encoded length/" << length
+            << " numWellRects/" << plan->getWellRects().size()
+            << " " << plan->getDecodeOptions();
+
+    const util::dmUint64 start = util::DmClock::nowNanos();
+    startDecode();
+    const TraceGuard traceGuard(*this);
+    std::unique_ptr<Image> image;
+    {
+        StageTimer timer(*decodeReport, STAGE_IMAGE_LOAD);
+        image = std::unique_ptr<Image>(new Image(encodedImage, length));
+    }
+    return decodeLoadedImage(start, *image, std::shared_ptr<const Image>(), plan);
+}
 
-    Image image(filename);
+int DmScanLib::decodeImageWells(
+        const unsigned char * pixels,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat format,
+        const DecodeOptions & decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+
+    return decodeImageWells(pixels, width, height, stride, format,
+            std::shared_ptr<const DecodePlan>(new DecodePlan(decodeOptions, wellRects)));
+}
+
+int DmScanLib::decodeImageWells(
+        const unsigned char * pixels,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat format,
+        const std::shared_ptr<const DecodePlan> & plan) {
+
+    VLOG(1) << "decodeImageWells: pixels/" << width << "x" << height
+            << " stride/" << stride << " format/" << format
+            << " numWellRects/" << plan->getWellRects().size()
+            << " " << plan->getDecodeOptions();
+
+    const util::dmUint64 start = util::DmClock::nowNanos();
+    startDecode();
+    const TraceGuard traceGuard(*this);
+    std::unique_ptr<Image> image;
+    {
+        StageTimer timer(*decodeReport, STAGE_IMAGE_LOAD);
+        image = std::unique_ptr<Image>(new Image(pixels, width, height, stride, format));
+    }
+    return decodeLoadedImage(start, *image, std::shared_ptr<const Image>(), plan);
+}
+
+/*
+ * The results of the previous pallet are dropped so that they are not mistaken for
+ * those of this one if it fails early. The static settings are copied so that the
+ * whole decode sees the same ones.
+ */
+void DmScanLib::startDecode() {
+    decodeReport = std::unique_ptr<DecodeReport>(new DecodeReport());
+    decoder.reset();
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+        decodeMetricsFilename = metricsFilename;
+        decodeTraceFilename = traceFilename;
+        decodeHeatmapFilename = heatmapFilename;
+    }
+    startTrace();
+}
+
+int DmScanLib::decodeLoadedImage(
+        util::dmUint64 start,
+        const Image & image,
+        const std::shared_ptr<const Image> & workingImage,
+        const std::shared_ptr<const DecodePlan> & plan) {
     if (!image.isValid()) {
         return SC_INVALID_IMAGE;
     }
 
-    return decodeCommon(image, decodeOptions, "decode.png", wellRects);
+    int result = decodeCommon(image, workingImage, plan, decodedImageFilename);
+    decodeReport->setTotalNanos(util::DmClock::nowNanos() - start);
+    recordMetrics();
+    captureDecode(image, *plan, result);
+    VLOG(2) << "decode report: " << *decodeReport;
+    return result;
 }
 
 int DmScanLib::decodeCommon(const Image & image,
-        const DecodeOptions & decodeOptions,
-        const std::string &decodedDibFilename,
-        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+        const std::shared_ptr<const Image> & workingImage,
+        const std::shared_ptr<const DecodePlan> & plan,
+        const std::string &decodedDibFilename) {
+
+    DM_PROBE1(pallet__begin, plan->getWellRects().size());
+#if defined(HAVE_SYS_SDT_H)
+    // only read by the pallet__end probe
+    const util::dmUint64 start = util::DmClock::nowNanos();
+#endif
 
-    decoder = std::unique_ptr<Decoder>(new Decoder(image, decodeOptions, wellRects));
+    if (workingImage.get() != NULL) {
+        decoder = std::unique_ptr<Decoder>(new Decoder(workingImage, plan, *decodeReport));
+    } else {
+        decoder = std::unique_ptr<Decoder>(new Decoder(image, plan, *decodeReport));
+    }
     int result = decoder->decodeWellRects();
 
+    DM_PROBE3(pallet__end, result, decoder->getDecodedWellCount(),
+            util::DmClock::nowNanos() - start);
+
+    // written even when nothing decoded, that is when the costs matter most
+    if (!decodeHeatmapFilename.empty()) {
+        writeHeatmapImage(image, decodeHeatmapFilename);
+    }
+
     if (result != SC_SUCCESS) {
         return result;
     }
@@ -213,7 +471,9 @@ int DmScanLib::decodeCommon(const Image & image,
         return SC_INVALID_NOTHING_DECODED;
     }
 
-    writeDecodedImage(image, decodedDibFilename);
+    if (!decodedDibFilename.empty()) {
+        writeDecodedImage(image, decodedDibFilename);
+    }
 
     return SC_SUCCESS;
 }
@@ -223,6 +483,7 @@ void DmScanLib::writeDecodedImage(
         const std::string & decodedDibFilename) {
 
     CHECK_NOTNULL(decoder.get());
+    StageTimer timer(*decodeReport, STAGE_IMAGE_WRITE);
 
     std::vector<std::unique_ptr<WellDecoder> > & wellDecoders = decoder->getWellDecoders();
     CHECK(wellDecoders.size() > 0);
@@ -256,6 +517,118 @@ void DmScanLib::writeDecodedImage(
     decodedImage.write(decodedDibFilename.c_str());
 }
 
+/*
+ * Each well is shaded from blue to red by the number of pixels libdmtx sampled
+ * while searching it, relative to the most expensive well on the pallet, and is
+ * labelled with the count and the number of regions rejected.
+ */
+void DmScanLib::writeHeatmapImage(const Image & image, const std::string & heatmapFilename) {
+    CHECK_NOTNULL(decoder.get());
+    StageTimer timer(*decodeReport, STAGE_IMAGE_WRITE);
+
+    std::vector<std::unique_ptr<WellDecoder> > & wellDecoders = decoder->getWellDecoders();
+    std::vector<DmtxDecodeStats> stats(wellDecoders.size());
+    long maxPixels = 1;
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        stats[i] = wellDecoders[i]->getDecodeStats();
+        maxPixels = std::max(maxPixels, stats[i].pixelsSampled);
+    }
+
+    cv::Scalar colorWhite(255, 255, 255);
+    Image heatmapImage(image);
+
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        const WellDecoder & wellDecoder = *wellDecoders[i];
+        const DmtxDecodeStats & wellStats = stats[i];
+        const double cost = static_cast<double>(wellStats.pixelsSampled) / maxPixels;
+        const cv::Rect & wellBbox = wellDecoder.getWellRectangle();
+        const long rejected = wellStats.failOrientation + wellStats.failTopEdge
+                + wellStats.failRightEdge + wellStats.failFindSize + wellStats.failDecode;
+
+        heatmapImage.fillRectangle(wellBbox, cv::Scalar(255 * cost, 0, 255 * (1 - cost)), 0.5);
+
+        std::ostringstream pixelsText;
+        pixelsText << (wellStats.pixelsSampled + 500) / 1000 << "k px";
+        heatmapImage.drawText(pixelsText.str(), wellBbox.tl() + cv::Point(2, 12), colorWhite);
+
+        std::ostringstream rejectedText;
+        rejectedText << rejected << " rej";
+        heatmapImage.drawText(rejectedText.str(), wellBbox.tl() + cv::Point(2, 24), colorWhite);
+    }
+    heatmapImage.write(heatmapFilename);
+}
+
+void DmScanLib::recordMetrics() {
+    CHECK_NOTNULL(decoder.get());
+    CHECK_NOTNULL(decodeReport.get());
+
+    util::MetricsRegistry & metrics = util::MetricsRegistry::getInstance();
+    metrics.addPallet(decodeReport->getTotalNanos());
+
+    std::vector<std::unique_ptr<WellDecoder> > & wellDecoders = decoder->getWellDecoders();
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        const WellDecoder & wellDecoder = *wellDecoders[i];
+        metrics.addWell(!wellDecoder.getMessage().empty(),
+                wellDecoder.getDecodeStats().regionsFound > 0, wellDecoder.getDecodeNanos());
+    }
+
+    if (!decodeMetricsFilename.empty() && !metrics.writeTextFile(decodeMetricsFilename)) {
+        VLOG(1) << "could not write metrics file: " << decodeMetricsFilename;
+    }
+}
+
+void DmScanLib::captureDecode(const Image & image, const DecodePlan & plan, int result) {
+    if (!DecodeCapture::shouldCapture(decodeReport->getTotalNanos())) {
+        return;
+    }
+    DecodeCapture::write(
+            image,
+            plan.getDecodeOptions(),
+            plan.getWellRects(),
+            (decoder.get() != NULL) ? &decoder->getDecodedWells() : NULL,
+            result,
+            *decodeReport);
+}
+
+/*
+ * Tracing is only turned on while a pallet is being decoded, so the disabled
+ * path is all that other callers of the library pay for. While one pallet is
+ * traced, the pallets started by other threads are not, and since their threads
+ * work for other trace ids they leave no events in its timeline.
+ */
+void DmScanLib::startTrace() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+    if (decodeTraceFilename.empty() || traceActive) {
+        return;
+    }
+    traceActive = true;
+    tracing = true;
+    traceContext = std::unique_ptr<util::TraceContext>(
+            new util::TraceContext(util::TraceRecorder::start()));
+    util::TraceRecorder::record('B', "pallet", 0);
+}
+
+/*
+ * The traced pallet's wells have all been decoded by now, no other thread records
+ * into the trace while it is written.
+ */
+void DmScanLib::finishTrace() {
+    if (!tracing) {
+        return;
+    }
+    util::TraceRecorder::record('E', "pallet", 0);
+    util::TraceRecorder::stop();
+    traceContext.reset();
+
+    if (!util::TraceRecorder::writeJson(decodeTraceFilename)) {
+        VLOG(1) << "could not write trace file: " << decodeTraceFilename;
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(staticMutex);
+    traceActive = false;
+    tracing = false;
+}
+
 const unsigned DmScanLib::getDecodedWellCount() {
     if (decoder == NULL) {
         throw std::logic_error("decoder is null");
@@ -268,6 +641,21 @@ const std::map<std::string, const WellDecoder *> & DmScanLib::getDecodedWells()
     return decoder->getDecodedWells();
 }
 
+const std::vector<std::unique_ptr<WellDecoder> > & DmScanLib::getWellDecoders() const {
+    static const std::vector<std::unique_ptr<WellDecoder> > noWellDecoders;
+    if (decoder.get() == NULL) {
+        return noWellDecoders;
+    }
+    return decoder->getWellDecoders();
+}
+
+const DecodeReport & DmScanLib::getDecodeReport() const {
+    if (decodeReport.get() == NULL) {
+        throw std::logic_error("nothing has been decoded");
+    }
+    return *decodeReport;
+}
+
 Orientation DmScanLib::getOrientationFromString(std::string & orientationStr) {
     Orientation orientation = ORIENTATION_MAX;
 
@@ -294,7 +682,11 @@ BarcodePosition DmScanLib::getBarcodePositionFromString(std::string & positionSt
 
 void DmScanLib::sbsLabelingFromRowCol(unsigned row, unsigned col, std::string & labelStr) {
     std::ostringstream label;
-    label << (char) ('A' + row) << (col  + 1);
+    // pallets with more than 26 rows continue with AA, AB, ...
+    if (row >= 26) {
+        label << (char) ('A' + row / 26 - 1);
+    }
+    label << (char) ('A' + row % 26) << (col  + 1);
     labelStr.assign(label.str());
 }
 
@@ -22,12 +22,14 @@
  */
 
 #include "decoder/WellRectangle.h"
+#include "utils/DmClock.h"
 #include "utils/DmTime.h"
 
 #include <string>
 #include <memory>
 #include <vector>
 #include <map>
+#include <OpenThreads/Mutex>
 
 namespace dmscanlib {
 
@@ -54,6 +56,16 @@ class Decoder;
 class ImgScanner;
 class WellDecoder;
 class DecodeOptions;
+class DecodePlan;
+class DecodeReport;
+
+namespace decoder {
+class CachedImage;
+}
+
+namespace util {
+class TraceContext;
+}
 
 enum Orientation { LANDSCAPE, PORTRAIT, ORIENTATION_MAX };
 
@@ -61,6 +73,23 @@ enum BarcodePosition { TUBE_TOPS, TUBE_BOTTOMS, BARCODE_POSITION_MAX };
 
 enum PalletSize { PSIZE_8x12, PSIZE_10x10, PSIZE_12x12, PSIZE_9x9, PSIZE_1x1, PSIZE_MAX };
 
+/**
+ * Layouts of the raw pixel buffers that can be decoded, 8 bits per channel.
+ */
+enum PixelFormat {
+    PIXEL_GRAY8,
+    PIXEL_BGR24,
+    PIXEL_RGB24,
+    PIXEL_BGRA32,
+    PIXEL_RGBA32,
+    PIXEL_FORMAT_MAX
+};
+
+/**
+ * One DmScanLib decodes one pallet at a time, but separate objects may decode at
+ * the same time from different threads. Their wells are then decoded by the
+ * threads of the process wide decoder::WorkerPool, taking turns.
+ */
 class DmScanLib {
 public:
     DmScanLib();
@@ -107,12 +136,142 @@ public:
             const DecodeOptions & decodeOptions,
             std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
 
+    /*
+     * Decodes an image file already in memory, in any format the file version
+     * accepts (BMP, PNG, JPEG, ...).
+     */
+    int decodeImageWells(
+            const unsigned char * encodedImage,
+            unsigned length,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    /*
+     * Decodes a raw pixel buffer, stride is the number of bytes between the start
+     * of two rows. The pixels are used in place, without a copy, and are not
+     * modified.
+     */
+    int decodeImageWells(
+            const unsigned char * pixels,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    /*
+     * The same three ways of decoding, with a plan built beforehand for the type
+     * of pallet. The plan's options and well rectangles are used, repeated decodes
+     * then only do the pixel work.
+     */
+    int decodeImageWells(
+            const char * filename,
+            const std::shared_ptr<const DecodePlan> & plan);
+
+    int decodeImageWells(
+            const unsigned char * encodedImage,
+            unsigned length,
+            const std::shared_ptr<const DecodePlan> & plan);
+
+    int decodeImageWells(
+            const unsigned char * pixels,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format,
+            const std::shared_ptr<const DecodePlan> & plan);
+
+    /*
+     * The scanned image, and the image with the decoded wells drawn on it, are
+     * written to these files after each decode, by default scanned.png and
+     * decode.png in the current directory. Objects decoding at the same time need
+     * files of their own, an empty filename turns the file off.
+     */
+    void setImageFilenames(const std::string & scannedFilename,
+            const std::string & decodedFilename);
+
     static void configLogging(unsigned level, bool useFile = true);
 
+    /*
+     * When set, the process wide metrics are written to this file, in the text
+     * exposition format, after every pallet. An empty filename turns this off.
+     */
+    static void setMetricsFilename(const std::string & filename);
+
+    /*
+     * When set, every pallet is traced and the timeline is written to this file in
+     * the Chrome trace event format. An empty filename turns tracing off.
+     */
+    static void setTraceFilename(const std::string & filename);
+
+    /*
+     * When set, the libdmtx search effort for each well is drawn as a heatmap over
+     * the pallet image and written to this file after every pallet. An empty
+     * filename turns this off.
+     */
+    static void setHeatmapFilename(const std::string & filename);
+
+    /*
+     * Sets the number of threads used to decode the wells of a pallet, the default
+     * is ThreadMgr::DEFAULT_THREAD_NUM. Pallets decoded at the same time share the
+     * same pool of this many threads. Throws std::invalid_argument if the count is
+     * zero.
+     */
+    static void setDecodeThreadCount(unsigned count);
+
+    /*
+     * Turns on the hardware performance counters, which are then added to the
+     * decode report for each stage and each well. Where the counters are not
+     * available the report only has timings.
+     */
+    static void setPerfCountersEnabled(bool enable);
+
+    /*
+     * Keeps up to this many bytes of the images decoded from files, together with
+     * the working images made from them, so that decoding the same file again goes
+     * straight to the wells. A file is only decoded from the cache while its size
+     * and modification time are the same. The modification time is compared to the
+     * nanosecond where the file system keeps it, and to the second on Windows, so a
+     * file rewritten there within a second to the same size needs
+     * invalidateImageCache(). The least recently used images are dropped first.
+     * Zero, the default, turns the cache off.
+     */
+    static void setImageCacheSize(size_t bytes);
+
+    /*
+     * Drops the cached images of the file, or of every file when the filename is
+     * empty.
+     */
+    static void invalidateImageCache(const std::string & filename);
+
+    /*
+     * Records the inputs and timings of decodes to capture files in the directory,
+     * for the replay tool. One decode in every sampleEvery is captured, as well as
+     * those that take longer than latencyThresholdMillis, zero turns either off.
+     * When wellsOnly is set, only the well rectangles of the image are kept. An
+     * empty directory turns capturing off.
+     */
+    static void setCapture(
+            const std::string & directory,
+            unsigned sampleEvery,
+            unsigned latencyThresholdMillis,
+            bool wellsOnly);
+
     const unsigned getDecodedWellCount();
 
     const std::map<std::string, const WellDecoder *> & getDecodedWells() const;
 
+    /*
+     * All the wells of the most recent decode, decoded or not, in the order of
+     * the well rectangles. Empty when the image could not be decoded at all.
+     */
+    const std::vector<std::unique_ptr<WellDecoder> > & getWellDecoders() const;
+
+    /*
+     * Stage timings for the most recent scanAndDecode() or decodeImageWells().
+     */
+    const DecodeReport & getDecodeReport() const;
 
     static Orientation getOrientationFromString(std::string & orientationStr);
 
@@ -132,22 +291,99 @@ public:
     static PalletSize getPalletSizeFromString(std::string & palletSizeStr);
 
 protected:
+    /*
+     * The working image is made from the image when it is NULL.
+     */
     int decodeCommon(
             const Image & image,
-            const DecodeOptions & decodeOptions,
-            const std::string &decodedDibFilename,
-            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+            const std::shared_ptr<const Image> & workingImage,
+            const std::shared_ptr<const DecodePlan> & plan,
+            const std::string &decodedDibFilename);
+
+    void startDecode();
+
+    std::shared_ptr<const decoder::CachedImage> loadImage(const char * filename);
+
+    int decodeLoadedImage(
+            util::dmUint64 start,
+            const Image & image,
+            const std::shared_ptr<const Image> & workingImage,
+            const std::shared_ptr<const DecodePlan> & plan);
 
     void writeDecodedImage(const Image & image, const std::string & decodedDibFilename);
 
+    void writeHeatmapImage(const Image & image, const std::string & heatmapFilename);
+
+    void recordMetrics();
+
+    void captureDecode(const Image & image, const DecodePlan & plan, int result);
+
+    void startTrace();
+
+    /*
+     * Does nothing when this object's pallet is not being traced.
+     */
+    void finishTrace();
+
+    /*
+     * Finishes the trace however the decode ends, exceptions included.
+     */
+    class TraceGuard {
+    public:
+        TraceGuard(DmScanLib & _dmScanLib) :
+                dmScanLib(_dmScanLib) {
+        }
+
+        ~TraceGuard() {
+            dmScanLib.finishTrace();
+        }
+
+    private:
+        TraceGuard(const TraceGuard &);
+        TraceGuard & operator=(const TraceGuard &);
+
+        DmScanLib & dmScanLib;
+    };
+
     static const std::string LIBRARY_NAME;
 
     std::unique_ptr<ImgScanner> imgScanner;
 
+    // true while this object's pallet is the one being traced
+    bool tracing;
+
+    // the calling thread works for the traced pallet while this is set
+    std::unique_ptr<util::TraceContext> traceContext;
+
+    std::string scannedImageFilename;
+
+    std::string decodedImageFilename;
+
+    // the static filenames, copied when a decode starts
+    std::string decodeMetricsFilename;
+
+    std::string decodeTraceFilename;
+
+    std::string decodeHeatmapFilename;
+
     std::unique_ptr<Decoder> decoder;
 
+    std::unique_ptr<DecodeReport> decodeReport;
+
     static bool loggingInitialized;
 
+    static OpenThreads::Mutex staticMutex;
+
+    // only one pallet is traced at a time
+    static bool traceActive;
+
+    // set and read with staticMutex held
+    static std::string metricsFilename;
+
+    static std::string traceFilename;
+
+    static std::string heatmapFilename;
+
 };
 
 std::ostream & operator<<(std::ostream &os, Orientation m);
@@ -14,7 +14,7 @@
 
 namespace dmscanlib {
 
-Image::Image(const std::string & _filename) : filename(_filename) {
+Image::Image(const std::string & _filename) : format(PIXEL_BGR24), filename(_filename) {
 	image = cv::imread(filename.c_str());
 
     valid = (image.data != NULL);
@@ -27,12 +27,90 @@ Image::Image(const std::string & _filename) : filename(_filename) {
     }
 }
 
-Image::Image(const Image & that) : filename("") {
+Image::Image(const unsigned char * encodedImage, unsigned length) :
+        format(PIXEL_BGR24),
+        filename("")
+{
+    if ((encodedImage != NULL) && (length > 0)) {
+        const cv::Mat encoded(1, length, CV_8UC1, const_cast<unsigned char *>(encodedImage));
+        image = cv::imdecode(encoded, CV_LOAD_IMAGE_COLOR);
+    }
+
+    valid = (image.data != NULL);
+
+    if (valid) {
+        VLOG(1) << "Image::Image: width: " << image.cols
+                << ", height: " << image.rows
+                << ", depth: " << image.elemSize()
+                << ", step: " << image.step1();
+    }
+}
+
+Image::Image(
+        const unsigned char * pixels,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat _format) :
+        valid(false),
+        format(_format),
+        filename("")
+{
+    int type;
+    unsigned channels;
+    switch (format) {
+    case PIXEL_GRAY8:
+        type = CV_8UC1;
+        channels = 1;
+        break;
+    case PIXEL_BGR24:
+    case PIXEL_RGB24:
+        type = CV_8UC3;
+        channels = 3;
+        break;
+    case PIXEL_BGRA32:
+    case PIXEL_RGBA32:
+        type = CV_8UC4;
+        channels = 4;
+        break;
+    default:
+        return;
+    }
+
+    if ((pixels == NULL) || (width == 0) || (height == 0) || (stride < width * channels)) {
+        return;
+    }
+
+    image = cv::Mat(height, width, type, const_cast<unsigned char *>(pixels), stride);
+    valid = true;
+
+    VLOG(1) << "Image::Image: width: " << image.cols
+            << ", height: " << image.rows
+            << ", depth: " << image.elemSize()
+            << ", step: " << image.step1();
+}
+
+Image::Image(const Image & that) : format(PIXEL_BGR24), filename("") {
     if (that.image.data == NULL) {
         throw std::invalid_argument("parameter is null");
     }
 
-    image = that.image;
+    switch (that.format) {
+    case PIXEL_GRAY8:
+        cv::cvtColor(that.image, image, CV_GRAY2BGR);
+        break;
+    case PIXEL_RGB24:
+        cv::cvtColor(that.image, image, CV_RGB2BGR);
+        break;
+    case PIXEL_BGRA32:
+        cv::cvtColor(that.image, image, CV_BGRA2BGR);
+        break;
+    case PIXEL_RGBA32:
+        cv::cvtColor(that.image, image, CV_RGBA2BGR);
+        break;
+    default:
+        image = that.image.clone();
+    }
     valid = true;
 
     VLOG(5) << "Image::Image: width: " << image.cols
@@ -41,7 +119,7 @@ Image::Image(const Image & that) : filename("") {
             << ", step: " << image.step1();
 }
 
-Image::Image(const cv::Mat & mat) : filename("") {
+Image::Image(const cv::Mat & mat) : format(PIXEL_BGR24), filename("") {
     if (mat.data == NULL) {
         throw std::invalid_argument("parameter is null");
     }
@@ -55,7 +133,7 @@ Image::Image(const cv::Mat & mat) : filename("") {
             << ", step: " << image.step1();
 }
 
-Image::Image(HANDLE handle) : filename("") {
+Image::Image(HANDLE handle) : format(PIXEL_BGR24), filename("") {
 #ifdef WIN32
     BITMAPINFOHEADER *dibHeaderPtr = (BITMAPINFOHEADER *) GlobalLock(handle);
 
@@ -110,20 +188,39 @@ Image::~Image() {
 }
 
 void Image::grayscale(Image & that) const {
-    cv::cvtColor(image, that.image, CV_BGR2GRAY);
+    switch (format) {
+    case PIXEL_GRAY8:
+        that.image = image;
+        break;
+    case PIXEL_RGB24:
+        cv::cvtColor(image, that.image, CV_RGB2GRAY);
+        break;
+    case PIXEL_BGRA32:
+        cv::cvtColor(image, that.image, CV_BGRA2GRAY);
+        break;
+    case PIXEL_RGBA32:
+        cv::cvtColor(image, that.image, CV_RGBA2GRAY);
+        break;
+    default:
+        cv::cvtColor(image, that.image, CV_BGR2GRAY);
+    }
+    that.format = PIXEL_GRAY8;
 }
 
+const double Image::FILTER_SIGMA = 15;
+const double Image::FILTER_THRESHOLD = 5;
+const double Image::FILTER_AMOUNT = 1;
+
 // from: https://github.com/radeonwu/DMTag/blob/master/dm_localization/src/dm_localize.cpp
 void Image::applyFilters(Image & that) const {
     cv::Mat blurredImage;
     cv::Mat enhancedImage;
 
-    double sigma = 15, threshold = 5, amount = 1;
-
-    cv::GaussianBlur(image, blurredImage, cv::Size(0, 0), sigma);
-    cv::Mat lowContrastMask = abs(image - blurredImage) < threshold;
-    that.image = image * (1 + amount) + blurredImage * (-amount);
+    cv::GaussianBlur(image, blurredImage, cv::Size(0, 0), FILTER_SIGMA);
+    cv::Mat lowContrastMask = abs(image - blurredImage) < FILTER_THRESHOLD;
+    that.image = image * (1 + FILTER_AMOUNT) + blurredImage * (-FILTER_AMOUNT);
     image.copyTo(that.image, lowContrastMask);
+    that.format = format;
 }
 
 
@@ -153,6 +250,18 @@ std::unique_ptr<const Image> Image::crop(
     return std::unique_ptr<Image>(new Image(croppedImage));
 }
 
+std::unique_ptr<const Image> Image::keepRegions(const std::vector<cv::Rect> & rects) const {
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    cv::Mat regionsImage = cv::Mat::zeros(image.size(), image.type());
+    for (unsigned i = 0, n = rects.size(); i < n; ++i) {
+        const cv::Rect rect = rects[i] & bounds;
+        image(rect).copyTo(regionsImage(rect));
+    }
+    std::unique_ptr<Image> regions(new Image(regionsImage));
+    regions->format = format;
+    return std::move(regions);
+}
+
 void Image::drawRectangle(const cv::Rect & rect, const cv::Scalar & color) {
     cv::rectangle(image, rect, color);
 }
@@ -161,8 +270,22 @@ void Image::drawLine(const cv::Point & pt1, const cv::Point & pt2, const cv::Sca
     cv::line(image, pt1, pt2, color, 2);
 }
 
+void Image::fillRectangle(const cv::Rect & rect, const cv::Scalar & color, double alpha) {
+    cv::Mat roi = image(rect & cv::Rect(0, 0, image.cols, image.rows));
+    cv::Mat overlay(roi.size(), roi.type(), color);
+    cv::addWeighted(overlay, alpha, roi, 1.0 - alpha, 0.0, roi);
+}
+
+void Image::drawText(const std::string & text, const cv::Point & origin, const cv::Scalar & color) {
+    cv::putText(image, text, origin, cv::FONT_HERSHEY_SIMPLEX, 0.4, color);
+}
+
 int Image::write(const std::string & filename) const {
     VLOG(1) << "write: " << filename;
+    if ((format != PIXEL_GRAY8) && (format != PIXEL_BGR24)) {
+        // image files are written in BGR order
+        return Image(*this).write(filename);
+    }
     IplImage saveImage = image;
     int result = cvSaveImage(filename.c_str(), &saveImage);
     return result;
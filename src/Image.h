@@ -10,10 +10,13 @@
 
 #define _CRT_SECURE_NO_DEPRECATE
 
+#include "DmScanLib.h"
+
 #include <dmtx.h>
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #if defined (WIN32) && ! defined(__MINGW32__)
 #   define NOMINMAX
@@ -28,9 +31,26 @@ namespace dmscanlib {
 
 class Image {
 public:
-    Image(): valid(false) {}
+    Image(): valid(false), format(PIXEL_BGR24) {}
     Image(const std::string & filename);
     Image(HANDLE handle);
+
+    /*
+     * Decodes an image file held in memory.
+     */
+    Image(const unsigned char * encodedImage, unsigned length);
+
+    /*
+     * Wraps the caller's pixels without copying them, they must outlive this image.
+     * The image is not valid when the stride is too small for the width.
+     */
+    Image(const unsigned char * pixels, unsigned width, unsigned height, unsigned stride,
+            PixelFormat format);
+
+    /*
+     * The copy is a BGR image with its own pixels, so drawing on it leaves the
+     * original untouched.
+     */
     Image(const Image & that);
     virtual ~Image();
 
@@ -54,14 +74,31 @@ public:
 
     void applyFilters(Image & that) const;
 
+    // the unsharp mask applied by applyFilters()
+    static const double FILTER_SIGMA;
+    static const double FILTER_THRESHOLD;
+    static const double FILTER_AMOUNT;
+
     DmtxImage * dmtxImage() const;
 
     std::unique_ptr<const Image> crop(unsigned x, unsigned y, unsigned width, unsigned height) const;
 
+    /*
+     * A copy of the image that is black outside the rectangles.
+     */
+    std::unique_ptr<const Image> keepRegions(const std::vector<cv::Rect> & rects) const;
+
     void drawRectangle(const cv::Rect & rect, const cv::Scalar & color);
 
     void drawLine(const cv::Point & pt1, const cv::Point & pt2, const cv::Scalar & color);
 
+    /*
+     * Blends the color into the rectangle, alpha is the weight given to the color.
+     */
+    void fillRectangle(const cv::Rect & rect, const cv::Scalar & color, double alpha);
+
+    void drawText(const std::string & text, const cv::Point & origin, const cv::Scalar & color);
+
     int write(const std::string & filename) const;
 
 
@@ -70,6 +107,7 @@ private:
 
     cv::Mat image;
     bool valid;
+    PixelFormat format;
     const std::string filename;
 };
 
@@ -0,0 +1,312 @@
+/*
+ * DmScanLibC.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLibC.h"
+#include "DecodeSession.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeReport.h"
+#include "decoder/WellDecoder.h"
+#include "decoder/WellRectangle.h"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string.h>
+#include <vector>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+using namespace dmscanlib;
+
+/*
+ * The decode options are rebuilt only when the caller's settings change, a batch
+ * or a run of decodes with the same settings shares them.
+ */
+struct DmScanSession {
+    DmScanSession(unsigned loggingLevel) :
+            session(loggingLevel)
+    {
+        memset(&options, 0, sizeof(options));
+    }
+
+    const DecodeOptions & getDecodeOptions(const DmScanOptions & _options);
+
+    DecodeSession session;
+    DmScanOptions options;
+    std::unique_ptr<DecodeOptions> decodeOptions;
+};
+
+struct DmScanLayout {
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+};
+
+namespace {
+
+bool sameOptions(const DmScanOptions & a, const DmScanOptions & b) {
+    return (a.minEdgeFactor == b.minEdgeFactor)
+            && (a.maxEdgeFactor == b.maxEdgeFactor)
+            && (a.scanGapFactor == b.scanGapFactor)
+            && (a.squareDev == b.squareDev)
+            && (a.edgeThresh == b.edgeThresh)
+            && (a.corrections == b.corrections)
+            && (a.shrink == b.shrink)
+            && ((a.speculativeDecode != 0) == (b.speculativeDecode != 0));
+}
+
+bool validImage(const DmScanImage & image) {
+    if (image.data == NULL) {
+        return false;
+    }
+    if (image.width == 0) {
+        return image.length > 0;
+    }
+    return (image.height > 0) && (image.format >= 0) && (image.format < PIXEL_FORMAT_MAX);
+}
+
+void clearWellResult(DmScanWellResult & wellResult) {
+    wellResult.status = DMSCAN_WELL_NOT_DECODED;
+    wellResult.tier = -1;
+    wellResult.symbolSize = -1;
+    wellResult.messageLength = 0;
+    wellResult.decodeNanos = 0;
+    for (unsigned c = 0; c < 8; ++c) {
+        wellResult.quad[c] = 0;
+    }
+    wellResult.message[0] = '\0';
+}
+
+void copyWellResult(const WellDecoder & wellDecoder, DmScanWellResult & wellResult) {
+    const std::string & message = wellDecoder.getMessage();
+    const std::vector<cv::Point> & quad = wellDecoder.getDecodedQuad();
+    const unsigned length = std::min<unsigned>(message.size(), DMSCAN_MESSAGE_MAX - 1);
+
+    if (message.empty()) {
+        wellResult.status = DMSCAN_WELL_NOT_DECODED;
+    } else if (length < message.size()) {
+        wellResult.status = DMSCAN_WELL_TRUNCATED;
+    } else {
+        wellResult.status = DMSCAN_WELL_DECODED;
+    }
+    wellResult.tier = wellDecoder.getDecodeTier();
+    wellResult.symbolSize = wellDecoder.getSymbolSize();
+    wellResult.messageLength = static_cast<int32_t>(length);
+    wellResult.decodeNanos = static_cast<int64_t>(wellDecoder.getDecodeNanos());
+    for (unsigned c = 0; c < 4; ++c) {
+        wellResult.quad[2 * c] = (c < quad.size()) ? static_cast<float>(quad[c].x) : 0;
+        wellResult.quad[2 * c + 1] = (c < quad.size()) ? static_cast<float>(quad[c].y) : 0;
+    }
+    memcpy(wellResult.message, message.data(), length);
+    wellResult.message[length] = '\0';
+}
+
+/*
+ * Decodes one image and fills in the caller's results, the arguments have
+ * already been checked.
+ */
+int32_t decodeImage(
+        DmScanSession & session,
+        const DmScanLayout & layout,
+        const DecodeOptions & decodeOptions,
+        const DmScanImage & image,
+        DmScanWellResult * wells,
+        DmScanImageResult & imageResult) {
+    // the decoder only reads the rectangles
+    std::vector<std::unique_ptr<const WellRectangle> > & wellRects =
+            const_cast<DmScanLayout &>(layout).wellRects;
+    const unsigned wellCount = wellRects.size();
+
+    for (unsigned i = 0; i < wellCount; ++i) {
+        clearWellResult(wells[i]);
+    }
+    imageResult.decodedWells = 0;
+    imageResult.totalNanos = 0;
+
+    if (!validImage(image)) {
+        imageResult.result = DMSCAN_INVALID_IMAGE;
+        return imageResult.result;
+    }
+
+    int result;
+    if (image.width == 0) {
+        result = session.session.decodeImageWells(
+                image.data, image.length, decodeOptions, wellRects);
+    } else {
+        result = session.session.decodeImageWells(
+                image.data, image.width, image.height, image.stride,
+                static_cast<PixelFormat>(image.format), decodeOptions, wellRects);
+    }
+
+    const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders =
+            session.session.getWellDecoders();
+    for (unsigned i = 0, n = std::min<unsigned>(wellDecoders.size(), wellCount); i < n; ++i) {
+        copyWellResult(*wellDecoders[i], wells[i]);
+    }
+
+    // a failed decode may have no decoder left to ask
+    imageResult.result = result;
+    imageResult.decodedWells = (result == SC_SUCCESS)
+            ? session.session.getDecodedWells().size() : 0;
+    imageResult.totalNanos = static_cast<int64_t>(session.session.getDecodeReport().getTotalNanos());
+    return result;
+}
+
+} /* namespace */
+
+const DecodeOptions & DmScanSession::getDecodeOptions(const DmScanOptions & _options) {
+    if ((decodeOptions.get() == NULL) || !sameOptions(options, _options)) {
+        decodeOptions = std::unique_ptr<DecodeOptions>(new DecodeOptions(
+                _options.minEdgeFactor,
+                _options.maxEdgeFactor,
+                _options.scanGapFactor,
+                _options.squareDev,
+                _options.edgeThresh,
+                _options.corrections,
+                _options.shrink));
+        decodeOptions->setSpeculativeDecode(_options.speculativeDecode != 0);
+        options = _options;
+    }
+    return *decodeOptions;
+}
+
+/*
+ * No exception may cross into the caller's code, they are logged and reported as
+ * DMSCAN_FAIL or a NULL handle.
+ */
+extern "C" {
+
+DmScanSession * dmscan_session_open(uint32_t loggingLevel) {
+    try {
+        return new DmScanSession(loggingLevel);
+    } catch (const std::exception & ex) {
+        LOG(ERROR) << "dmscan_session_open: " << ex.what();
+        return NULL;
+    }
+}
+
+void dmscan_session_close(DmScanSession * session) {
+    delete session;
+}
+
+DmScanLayout * dmscan_layout_create(
+        const float * corners,
+        const char * const * labels,
+        uint32_t wellCount) {
+    if ((corners == NULL) || (wellCount == 0)) {
+        return NULL;
+    }
+
+    try {
+        std::unique_ptr<DmScanLayout> layout(new DmScanLayout());
+        for (unsigned i = 0; i < wellCount; ++i) {
+            const float * wellCorners = corners + 8 * i;
+            float xmin = wellCorners[0];
+            float ymin = wellCorners[1];
+            float xmax = wellCorners[0];
+            float ymax = wellCorners[1];
+
+            for (unsigned c = 1; c < 4; ++c) {
+                xmin = std::min(xmin, wellCorners[2 * c]);
+                ymin = std::min(ymin, wellCorners[2 * c + 1]);
+                xmax = std::max(xmax, wellCorners[2 * c]);
+                ymax = std::max(ymax, wellCorners[2 * c + 1]);
+            }
+
+            if ((xmin < 0) || (ymin < 0) || (xmax - xmin < 1) || (ymax - ymin < 1)) {
+                LOG(ERROR) << "dmscan_layout_create: invalid corners for well " << i;
+                return NULL;
+            }
+
+            std::ostringstream label;
+            if ((labels != NULL) && (labels[i] != NULL)) {
+                label << labels[i];
+            } else {
+                label << i;
+            }
+
+            layout->wellRects.push_back(std::unique_ptr<const WellRectangle>(
+                    new WellRectangle(label.str().c_str(),
+                            static_cast<unsigned>(xmin),
+                            static_cast<unsigned>(ymin),
+                            static_cast<unsigned>(xmax - xmin),
+                            static_cast<unsigned>(ymax - ymin))));
+        }
+        return layout.release();
+    } catch (const std::exception & ex) {
+        LOG(ERROR) << "dmscan_layout_create: " << ex.what();
+        return NULL;
+    }
+}
+
+void dmscan_layout_release(DmScanLayout * layout) {
+    delete layout;
+}
+
+uint32_t dmscan_layout_well_count(const DmScanLayout * layout) {
+    return (layout == NULL) ? 0 : layout->wellRects.size();
+}
+
+int32_t dmscan_decode(
+        DmScanSession * session,
+        const DmScanLayout * layout,
+        const DmScanOptions * options,
+        const DmScanImage * image,
+        DmScanWellResult * wells,
+        uint32_t wellCapacity,
+        DmScanImageResult * result) {
+    if ((session == NULL) || (layout == NULL) || (options == NULL) || (image == NULL)
+            || (wells == NULL) || (result == NULL)) {
+        return DMSCAN_INVALID_ARGUMENT;
+    }
+    if (wellCapacity < layout->wellRects.size()) {
+        return DMSCAN_BUFFER_TOO_SMALL;
+    }
+
+    try {
+        return decodeImage(*session, *layout, session->getDecodeOptions(*options), *image,
+                wells, *result);
+    } catch (const std::exception & ex) {
+        LOG(ERROR) << "dmscan_decode: " << ex.what();
+        result->result = DMSCAN_FAIL;
+        return DMSCAN_FAIL;
+    }
+}
+
+int32_t dmscan_decode_batch(
+        DmScanSession * session,
+        const DmScanLayout * layout,
+        const DmScanOptions * options,
+        const DmScanImage * images,
+        uint32_t imageCount,
+        DmScanWellResult * wells,
+        DmScanImageResult * results) {
+    if ((session == NULL) || (layout == NULL) || (options == NULL) || (images == NULL)
+            || (wells == NULL) || (results == NULL)) {
+        return DMSCAN_INVALID_ARGUMENT;
+    }
+
+    try {
+        const DecodeOptions & decodeOptions = session->getDecodeOptions(*options);
+        const unsigned wellCount = layout->wellRects.size();
+
+        for (unsigned i = 0; i < imageCount; ++i) {
+            try {
+                decodeImage(*session, *layout, decodeOptions, images[i],
+                        wells + i * wellCount, results[i]);
+            } catch (const std::exception & ex) {
+                LOG(ERROR) << "dmscan_decode_batch: image " << i << ": " << ex.what();
+                results[i].result = DMSCAN_FAIL;
+            }
+        }
+        return DMSCAN_SUCCESS;
+    } catch (const std::exception & ex) {
+        LOG(ERROR) << "dmscan_decode_batch: " << ex.what();
+        return DMSCAN_FAIL;
+    }
+}
+
+} /* extern "C" */
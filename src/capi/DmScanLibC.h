@@ -0,0 +1,167 @@
+#ifndef DMSCANLIBC_H_
+#define DMSCANLIBC_H_
+
+/*
+ * DmScanLibC.h
+ *
+ *  Created on: 2026-10-18
+ *
+ *  Plain C interface to the decoder, for programs that cannot use the C++ API
+ *  (Python through ctypes or cffi, Go through cgo). Only fixed size structures
+ *  and opaque handles cross this interface, and the results are written into
+ *  arrays owned by the caller.
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#   if defined(BUILD_DLL)
+#       define DMSCAN_API __declspec(dllexport)
+#   else
+#       define DMSCAN_API __declspec(dllimport)
+#   endif
+#else
+#   define DMSCAN_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Return codes, those above -100 are the SC_ codes of the C++ API.
+ */
+#define DMSCAN_SUCCESS                    0
+#define DMSCAN_FAIL                      -1
+#define DMSCAN_NOTHING_DECODED           -4
+#define DMSCAN_INVALID_IMAGE             -5
+#define DMSCAN_NOTHING_TO_DECODE         -6
+#define DMSCAN_INVALID_ARGUMENT        -100
+#define DMSCAN_BUFFER_TOO_SMALL        -101
+
+/* Values of DmScanImage.format, the same as the PixelFormat of the C++ API. */
+#define DMSCAN_PIXEL_GRAY8                0
+#define DMSCAN_PIXEL_BGR24                1
+#define DMSCAN_PIXEL_RGB24                2
+#define DMSCAN_PIXEL_BGRA32               3
+#define DMSCAN_PIXEL_RGBA32               4
+
+/* Values of DmScanWellResult.status. */
+#define DMSCAN_WELL_NOT_DECODED           0
+#define DMSCAN_WELL_DECODED               1
+#define DMSCAN_WELL_TRUNCATED             2
+
+/* Longest message returned, including the terminating NUL. */
+#define DMSCAN_MESSAGE_MAX              128
+
+typedef struct DmScanSession DmScanSession;
+
+typedef struct DmScanLayout DmScanLayout;
+
+/*
+ * The settings of the two tier decode ladder built by the legacy DecodeOptions
+ * constructor.
+ */
+typedef struct DmScanOptions {
+    double minEdgeFactor;
+    double maxEdgeFactor;
+    double scanGapFactor;
+    int32_t squareDev;
+    int32_t edgeThresh;
+    int32_t corrections;
+    int32_t shrink;
+    int32_t speculativeDecode;
+} DmScanOptions;
+
+/*
+ * An image held by the caller. When width is zero, data holds length bytes of an
+ * encoded image file (BMP, PNG, JPEG, ...). Otherwise data holds raw pixels in
+ * the given format, stride bytes apart from one row to the next, and length is
+ * not used. The image is read in place and is not modified.
+ */
+typedef struct DmScanImage {
+    const unsigned char * data;
+    uint32_t length;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    int32_t format;
+} DmScanImage;
+
+/*
+ * The result for one well, in the order of the layout. The quad holds the (x, y)
+ * pairs of the corners of the decoded symbol in image coordinates. A message that
+ * does not fit is cut short, and the status is then DMSCAN_WELL_TRUNCATED.
+ */
+typedef struct DmScanWellResult {
+    int32_t status;
+    int32_t tier;
+    int32_t symbolSize;
+    int32_t messageLength;
+    int64_t decodeNanos;
+    float quad[8];
+    char message[DMSCAN_MESSAGE_MAX];
+} DmScanWellResult;
+
+typedef struct DmScanImageResult {
+    int32_t result;
+    uint32_t decodedWells;
+    int64_t totalNanos;
+} DmScanImageResult;
+
+/*
+ * A session decodes one image at a time and must not be used by more than one
+ * thread at once. Returns NULL on failure.
+ */
+DMSCAN_API DmScanSession * dmscan_session_open(uint32_t loggingLevel);
+
+DMSCAN_API void dmscan_session_close(DmScanSession * session);
+
+/*
+ * corners holds eight values per well: the (x, y) pairs of its four corners.
+ * labels holds one label per well, or is NULL to label the wells by their index.
+ * Both are copied. Returns NULL if a well is empty or the arguments are invalid.
+ */
+DMSCAN_API DmScanLayout * dmscan_layout_create(
+        const float * corners,
+        const char * const * labels,
+        uint32_t wellCount);
+
+DMSCAN_API void dmscan_layout_release(DmScanLayout * layout);
+
+DMSCAN_API uint32_t dmscan_layout_well_count(const DmScanLayout * layout);
+
+/*
+ * Decodes the wells of one image. wells must have room for the layout's well
+ * count, or DMSCAN_BUFFER_TOO_SMALL is returned before anything is decoded.
+ * Returns the decode result, which is also stored in result.
+ */
+DMSCAN_API int32_t dmscan_decode(
+        DmScanSession * session,
+        const DmScanLayout * layout,
+        const DmScanOptions * options,
+        const DmScanImage * image,
+        DmScanWellResult * wells,
+        uint32_t wellCapacity,
+        DmScanImageResult * result);
+
+/*
+ * Decodes several images with the same layout and options. wells holds
+ * imageCount * the layout's well count results, the wells of image i starting at
+ * i * that count, and results one entry per image. Returns DMSCAN_SUCCESS once
+ * every image has been tried, the outcome of each is in its results entry.
+ */
+DMSCAN_API int32_t dmscan_decode_batch(
+        DmScanSession * session,
+        const DmScanLayout * layout,
+        const DmScanOptions * options,
+        const DmScanImage * images,
+        uint32_t imageCount,
+        DmScanWellResult * wells,
+        DmScanImageResult * results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMSCANLIBC_H_ */
@@ -0,0 +1,204 @@
+/*
+ * DecodeCapture.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "decoder/DecodeCapture.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/DecodeReport.h"
+#include "decoder/ThreadMgr.h"
+#include "decoder/WellDecoder.h"
+#include "decoder/WellRectangle.h"
+#include "Image.h"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <OpenThreads/ScopedLock>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+namespace dmscanlib {
+
+const int DecodeCapture::FORMAT_VERSION = 1;
+
+OpenThreads::Mutex DecodeCapture::mutex;
+std::string DecodeCapture::directory;
+unsigned DecodeCapture::sampleEvery = 0;
+unsigned DecodeCapture::latencyThresholdMillis = 0;
+bool DecodeCapture::wellsOnly = false;
+unsigned DecodeCapture::decodeCount = 0;
+unsigned DecodeCapture::captureCount = 0;
+
+namespace {
+
+void writeEscaped(std::ostream & os, const std::string & str) {
+    os << '"';
+    for (unsigned i = 0, n = str.size(); i < n; ++i) {
+        if ((str[i] == '"') || (str[i] == '\\')) {
+            os << '\\';
+        }
+        os << str[i];
+    }
+    os << '"';
+}
+
+} /* namespace */
+
+void DecodeCapture::configure(
+        const std::string & _directory,
+        unsigned _sampleEvery,
+        unsigned _latencyThresholdMillis,
+        bool _wellsOnly) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    directory = _directory;
+    sampleEvery = _sampleEvery;
+    latencyThresholdMillis = _latencyThresholdMillis;
+    wellsOnly = _wellsOnly;
+    decodeCount = 0;
+}
+
+bool DecodeCapture::shouldCapture(util::dmUint64 totalNanos) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    if (directory.empty()) {
+        return false;
+    }
+
+    ++decodeCount;
+    if ((sampleEvery > 0) && (decodeCount % sampleEvery == 0)) {
+        return true;
+    }
+    return (latencyThresholdMillis > 0)
+            && (totalNanos >= static_cast<util::dmUint64>(latencyThresholdMillis) * 1000000ULL);
+}
+
+std::string DecodeCapture::write(
+        const Image & image,
+        const DecodeOptions & decodeOptions,
+        const std::vector<std::unique_ptr<const WellRectangle> > & wellRects,
+        const std::map<std::string, const WellDecoder *> * decodedWells,
+        int result,
+        const DecodeReport & decodeReport) {
+    std::string basename;
+    bool onlyWells;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+
+        char timestamp[32];
+        const time_t now = time(NULL);
+        strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", localtime(&now));
+
+        std::ostringstream name;
+        name << "capture-" << timestamp << "-" << std::setw(4) << std::setfill('0')
+             << ++captureCount;
+        basename = name.str();
+        onlyWells = wellsOnly;
+        if (!directory.empty()) {
+            basename = directory + "/" + basename;
+        }
+    }
+
+    const std::string imageFilename = basename + ".png";
+    const std::string captureFilename = basename + ".cap";
+
+    if (onlyWells) {
+        std::vector<cv::Rect> rects;
+        for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+            rects.push_back(wellRects[i]->getRectangle());
+        }
+        image.keepRegions(rects)->write(imageFilename);
+    } else {
+        image.write(imageFilename);
+    }
+
+    std::ofstream file(captureFilename.c_str());
+
+    // the image is found relative to the capture file
+    const std::string::size_type slash = imageFilename.find_last_of("/\\");
+    const std::string imageName = (slash == std::string::npos)
+            ? imageFilename : imageFilename.substr(slash + 1);
+
+    // libconfig needs a decimal point in floating point values
+    file << std::showpoint;
+
+    file << "version = " << FORMAT_VERSION << ";" << std::endl;
+    file << "imageFilename = ";
+    writeEscaped(file, imageName);
+    file << ";" << std::endl;
+    file << "wellsOnly = " << (onlyWells ? "true" : "false") << ";" << std::endl;
+    file << "decodeThreads = " << decoder::ThreadMgr::getThreadCount() << ";" << std::endl;
+
+    file << "decodeOptions = {" << std::endl
+         << "  minEdgeFactor = " << decodeOptions.minEdgeFactor << ";" << std::endl
+         << "  maxEdgeFactor = " << decodeOptions.maxEdgeFactor << ";" << std::endl
+         << "  speculativeDecode = "
+         << (decodeOptions.getSpeculativeDecode() ? "true" : "false") << ";" << std::endl
+         << "  profiles = (" << std::endl;
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    for (unsigned i = 0, n = profiles.size(); i < n; ++i) {
+        const DecodeProfile & profile = *profiles[i];
+        file << "    { scale = " << profile.scale
+             << "; scanGapFactor = " << profile.scanGapFactor
+             << "; squareDev = " << profile.squareDev
+             << "; edgeThresh = " << profile.edgeThresh
+             << "; corrections = " << profile.corrections
+             << "; subPixel = " << (profile.subPixel ? "true" : "false")
+             << "; symbolSize = " << profile.symbolSize
+             << "; }" << ((i + 1 < n) ? "," : "") << std::endl;
+    }
+    file << "  );" << std::endl << "};" << std::endl;
+
+    // the decoded wells are keyed by message
+    std::map<std::string, std::string> labelMessages;
+    if (decodedWells != NULL) {
+        for (std::map<std::string, const WellDecoder *>::const_iterator it =
+                decodedWells->begin(); it != decodedWells->end(); ++it) {
+            labelMessages[it->second->getLabel()] = it->first;
+        }
+    }
+
+    file << "wells = (" << std::endl;
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        const WellRectangle & wellRect = *wellRects[i];
+        const cv::Rect & rect = wellRect.getRectangle();
+        const std::map<std::string, std::string>::const_iterator it =
+                labelMessages.find(wellRect.getLabel());
+        const std::string message = (it != labelMessages.end()) ? it->second : "";
+
+        file << "  { label = ";
+        writeEscaped(file, wellRect.getLabel());
+        file << "; x = " << rect.x
+             << "; y = " << rect.y
+             << "; width = " << rect.width
+             << "; height = " << rect.height
+             << "; message = ";
+        writeEscaped(file, message);
+        file << "; }" << ((i + 1 < n) ? "," : "") << std::endl;
+    }
+    file << ");" << std::endl;
+
+    file << "result = " << result << ";" << std::endl;
+    file << "totalNanos = " << decodeReport.getTotalNanos() << "L;" << std::endl;
+    file << "stageNanos = {" << std::endl;
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        const DecodeStage stage = static_cast<DecodeStage>(i);
+        file << "  " << DecodeReport::getStageName(stage) << " = "
+             << decodeReport.getStageNanos(stage) << "L;" << std::endl;
+    }
+    file << "};" << std::endl;
+
+    if (!file.good()) {
+        VLOG(1) << "could not write decode capture: " << captureFilename;
+        return "";
+    }
+
+    VLOG(1) << "decode captured: " << captureFilename;
+    return captureFilename;
+}
+
+} /* namespace */
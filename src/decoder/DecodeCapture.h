@@ -0,0 +1,84 @@
+#ifndef DECODECAPTURE_H_
+#define DECODECAPTURE_H_
+
+/*
+ * DecodeCapture.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <OpenThreads/Mutex>
+
+namespace dmscanlib {
+
+class Image;
+class DecodeOptions;
+class DecodeReport;
+class WellDecoder;
+class WellRectangle;
+
+/**
+ * Records the inputs and outcome of a decode so that it can be reproduced
+ * offline with the replay tool, see src/tools/DecodeReplay.cpp.
+ *
+ * A capture is a text file, in the libconfig format, holding the decode options,
+ * the well rectangles, the decoded messages and the stage timings, next to a PNG
+ * of the image. When only the wells are kept, everything outside the well
+ * rectangles is blacked out, which PNG compresses to next to nothing.
+ *
+ * Decodes are captured one in every sampleEvery, and also whenever a decode
+ * takes longer than the latency threshold.
+ */
+class DecodeCapture {
+public:
+    /*
+     * An empty directory turns capturing off. A sampleEvery or a threshold of zero
+     * turns that trigger off.
+     */
+    static void configure(
+            const std::string & directory,
+            unsigned sampleEvery,
+            unsigned latencyThresholdMillis,
+            bool wellsOnly);
+
+    /*
+     * Called once per decode, counts it towards the sampling.
+     */
+    static bool shouldCapture(util::dmUint64 totalNanos);
+
+    /*
+     * Returns the name of the capture file, or an empty string if it could not be
+     * written. decodedWells, keyed by message as Decoder::getDecodedWells(), may be
+     * null.
+     */
+    static std::string write(
+            const Image & image,
+            const DecodeOptions & decodeOptions,
+            const std::vector<std::unique_ptr<const WellRectangle> > & wellRects,
+            const std::map<std::string, const WellDecoder *> * decodedWells,
+            int result,
+            const DecodeReport & decodeReport);
+
+    static const int FORMAT_VERSION;
+
+private:
+    DecodeCapture();
+
+    static OpenThreads::Mutex mutex;
+    static std::string directory;
+    static unsigned sampleEvery;
+    static unsigned latencyThresholdMillis;
+    static bool wellsOnly;
+    static unsigned decodeCount;
+    static unsigned captureCount;
+};
+
+} /* namespace */
+
+#endif /* DECODECAPTURE_H_ */
@@ -7,6 +7,7 @@
 
 #include "DecodeOptions.h"
 #include <stddef.h>
+#include <stdexcept>
 #include <jni.h>
 
 namespace dmscanlib {
@@ -23,14 +24,50 @@ DecodeOptions::DecodeOptions(
         maxEdgeFactor(_maxEdgeFactor),
         scanGapFactor(_scanGapFactor),
         squareDev(_squareDev),
-                edgeThresh(_edgeThresh),
-                corrections(_corrections),
-                shrink(_shrink) {
+        edgeThresh(_edgeThresh),
+        corrections(_corrections),
+        shrink(_shrink),
+        speculativeDecode(false)
+{
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+            shrink, scanGapFactor, squareDev, edgeThresh, corrections)));
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+            shrink + 1, scanGapFactor, squareDev, edgeThresh, corrections)));
+}
+
+/*
+ * The single valued settings are taken from the first profile in the ladder.
+ */
+DecodeOptions::DecodeOptions(
+        const double _minEdgeFactor,
+        const double _maxEdgeFactor,
+        std::vector<std::unique_ptr<const DecodeProfile> > & _profiles) :
+        minEdgeFactor(_minEdgeFactor),
+        maxEdgeFactor(_maxEdgeFactor),
+        scanGapFactor(firstProfile(_profiles).scanGapFactor),
+        squareDev(firstProfile(_profiles).squareDev),
+        edgeThresh(firstProfile(_profiles).edgeThresh),
+        corrections(firstProfile(_profiles).corrections),
+        shrink(firstProfile(_profiles).scale),
+        speculativeDecode(false)
+{
+    for (unsigned i = 0, n = _profiles.size(); i < n; ++i) {
+        profiles.push_back(std::move(_profiles[i]));
+    }
+    _profiles.clear();
 }
 
 DecodeOptions::~DecodeOptions() {
 }
 
+const DecodeProfile & DecodeOptions::firstProfile(
+        const std::vector<std::unique_ptr<const DecodeProfile> > & profiles) {
+    if (profiles.empty() || (profiles[0].get() == NULL)) {
+        throw std::invalid_argument("decode options require at least one profile");
+    }
+    return *profiles[0];
+}
+
 std::unique_ptr<DecodeOptions> DecodeOptions::getDecodeOptionsViaJni(
         JNIEnv *env, jobject decodeOptionsObj) {
     jclass decodeOptionsJavaClass = env->GetObjectClass(decodeOptionsObj);
@@ -90,7 +127,11 @@ std::ostream & operator<<(std::ostream &os, const DecodeOptions & m) {
             << " squareDev/" << m.squareDev
             << " edgeThresh/" << m.edgeThresh
             << " corrections/" << m.corrections
-            << " shrink/" << m.shrink;
+            << " shrink/" << m.shrink
+            << " speculativeDecode/" << m.speculativeDecode;
+    for (unsigned i = 0, n = m.profiles.size(); i < n; ++i) {
+        os << "\n    tier " << i << ": " << *m.profiles[i];
+    }
     return os;
 }
 
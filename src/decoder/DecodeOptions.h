@@ -8,14 +8,27 @@
  *      Author: nelson
  */
 
+#include "DecodeProfile.h"
+
 #include <jni.h>
 #include <ostream>
 #include <memory>
+#include <vector>
 
 namespace dmscanlib {
 
 class Decoder;
 
+/**
+ * Options used to decode the wells in an image.
+ *
+ * The decode attempts are described by an ordered ladder of DecodeProfile objects.
+ * The legacy constructor builds a two tier ladder: the given shrink, followed by
+ * shrink + 1 with the same settings.
+ *
+ * When speculative decoding is enabled, threads that become idle once every well
+ * has been started try the later tiers on the wells still being decoded.
+ */
 class DecodeOptions {
 public:
     DecodeOptions(
@@ -26,8 +39,26 @@ public:
             const long edgeThresh,
             const long corrections,
             const long shrink);
+
+    DecodeOptions(
+            const double minEdgeFactor,
+            const double maxEdgeFactor,
+            std::vector<std::unique_ptr<const DecodeProfile> > & profiles);
+
     virtual ~DecodeOptions();
 
+    const std::vector<std::unique_ptr<const DecodeProfile> > & getProfiles() const {
+        return profiles;
+    }
+
+    void setSpeculativeDecode(bool speculative) {
+        speculativeDecode = speculative;
+    }
+
+    bool getSpeculativeDecode() const {
+        return speculativeDecode;
+    }
+
     static std::unique_ptr<DecodeOptions> getDecodeOptionsViaJni(
             JNIEnv *env,
             jobject decodeOptionsObj);
@@ -41,6 +72,12 @@ public:
     const long shrink;
 
 private:
+    static const DecodeProfile & firstProfile(
+            const std::vector<std::unique_ptr<const DecodeProfile> > & profiles);
+
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    bool speculativeDecode;
+
     friend class Decoder;
     friend std::ostream & operator<<(std::ostream & os, const DecodeOptions & m);
 };
@@ -0,0 +1,174 @@
+/*
+ * DecodePlan.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "decoder/DecodePlan.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace dmscanlib {
+
+DecodePlan::DecodePlan(
+        const DecodeOptions & _decodeOptions,
+        const std::vector<std::unique_ptr<const WellRectangle> > & _wellRects) :
+        decodeOptions(copyOptions(_decodeOptions))
+{
+    for (unsigned i = 0, n = _wellRects.size(); i < n; ++i) {
+        const WellRectangle & wellRect = *_wellRects[i];
+        const cv::Rect & rect = wellRect.getRectangle();
+        wellRects.push_back(std::unique_ptr<const WellRectangle>(new WellRectangle(
+                wellRect.getLabel().c_str(), rect.x, rect.y, rect.width, rect.height)));
+    }
+    init();
+}
+
+DecodePlan::DecodePlan(
+        const DecodeOptions & _decodeOptions,
+        const cv::Rect & bbox,
+        unsigned rows,
+        unsigned cols,
+        Orientation orientation,
+        BarcodePosition position) :
+        decodeOptions(copyOptions(_decodeOptions))
+{
+    getWellRectsForBoundingBox(bbox, rows, cols, orientation, position, wellRects);
+    init();
+}
+
+DecodePlan::~DecodePlan() {
+}
+
+std::unique_ptr<DecodeOptions> DecodePlan::copyOptions(const DecodeOptions & decodeOptions) {
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+
+    std::vector<std::unique_ptr<const DecodeProfile> > planProfiles;
+    for (unsigned i = 0, n = profiles.size(); i < n; ++i) {
+        planProfiles.push_back(std::unique_ptr<const DecodeProfile>(
+                new DecodeProfile(*profiles[i])));
+    }
+
+    std::unique_ptr<DecodeOptions> options(new DecodeOptions(
+            decodeOptions.minEdgeFactor, decodeOptions.maxEdgeFactor, planProfiles));
+    options->setSpeculativeDecode(decodeOptions.getSpeculativeDecode());
+    return options;
+}
+
+void DecodePlan::init() {
+    wellSetupIndexes.resize(wellRects.size());
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        const cv::Size size = wellRects[i]->getRectangle().size();
+
+        unsigned index = 0;
+        while ((index < wellSetups.size()) && (wellSetups[index]->size != size)) {
+            ++index;
+        }
+        if (index == wellSetups.size()) {
+            addWellSetup(size);
+        }
+        wellSetupIndexes[i] = index;
+    }
+
+    VLOG(3) << "DecodePlan: wells/" << wellRects.size()
+            << " well sizes/" << wellSetups.size();
+}
+
+/*
+ * The values are the ones the decoder used to set as libdmtx properties, one at a
+ * time, for every well. A value libdmtx refuses, such as a scan gap below one or a
+ * square deviation of zero, is replaced by the libdmtx default.
+ */
+void DecodePlan::addWellSetup(const cv::Size & size) {
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions->getProfiles();
+    const unsigned mindim = std::min(size.width, size.height);
+
+    std::unique_ptr<WellSetup> setup(new WellSetup(size));
+    setup->settings.resize(profiles.size());
+    for (unsigned tier = 0, n = profiles.size(); tier < n; ++tier) {
+        const DecodeProfile & profile = *profiles[tier];
+        DmtxDecodeSettings & settings = setup->settings[tier];
+
+        if (dmtxDecodeSettingsInit(
+                &settings,
+                static_cast<int>(decodeOptions->minEdgeFactor * mindim),
+                static_cast<int>(decodeOptions->maxEdgeFactor * mindim),
+                static_cast<int>(profile.scanGapFactor * mindim),
+                profile.squareDev,
+                profile.symbolSize,
+                profile.edgeThresh,
+                profile.subPixel ? 1 : 0) != DmtxPass) {
+            VLOG(1) << "DecodePlan: invalid libdmtx settings for well size " << size
+                    << ", tier " << tier << ": " << profile;
+        }
+
+        setup->grids.push_back(dmtxScanGridCreate(
+                size.width, size.height, profile.scale, settings.scanGap));
+    }
+    wellSetups.push_back(std::move(setup));
+}
+
+const DmtxDecodeSettings & DecodePlan::getSettings(unsigned well, unsigned tier) const {
+    return wellSetups[wellSetupIndexes.at(well)]->settings.at(tier);
+}
+
+const DmtxScanGrid & DecodePlan::getScanGrid(unsigned well, unsigned tier) const {
+    return wellSetups[wellSetupIndexes.at(well)]->grids.at(tier);
+}
+
+void DecodePlan::getWellRectsForBoundingBox(
+        const cv::Rect & bbox,
+        unsigned rows,
+        unsigned cols,
+        Orientation orientation,
+        BarcodePosition position,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+
+    float wellWidth = bbox.width / static_cast<float>(cols);
+    float wellHeight = bbox.height / static_cast<float>(rows);
+
+    // round off the cell size so image dimensions are not exceeded
+    cv::Size cellSize(
+            static_cast<unsigned>(0.999f * wellWidth),
+            static_cast<unsigned>(0.999f * wellHeight));
+
+    float horOffset;
+    float verOffset = static_cast<float>(bbox.y);
+
+    for (unsigned row = 0; row < rows; ++row) {
+        horOffset = static_cast<float>(bbox.x);
+
+        for (unsigned col = 0; col < cols; ++col) {
+            std::string label;
+            DmScanLib::getLabelForPosition(row, col, rows, cols, orientation, position, label);
+
+            std::unique_ptr<WellRectangle> wellRect(
+                    new WellRectangle(
+                            label.c_str(),
+                            static_cast<unsigned>(horOffset),
+                            static_cast<unsigned>(verOffset),
+                            cellSize.width,
+                            cellSize.height));
+            const cv::Rect & wRect = wellRect->getRectangle();
+            if (!bbox.contains(wRect.tl()) || !bbox.contains(wRect.br())) {
+                throw std::logic_error("well rectangle outside image: " + label);
+            }
+
+            VLOG(5) << "getWellRectsForBoundingBox: " << *wellRect;
+            wellRects.push_back(std::move(wellRect));
+
+            horOffset += wellWidth;
+        }
+        verOffset += wellHeight;
+    }
+}
+
+} /* namespace */
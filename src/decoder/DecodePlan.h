@@ -0,0 +1,130 @@
+#ifndef DECODEPLAN_H_
+#define DECODEPLAN_H_
+
+/*
+ * DecodePlan.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+#include "decoder/WellRectangle.h"
+
+#include <dmtx.h>
+#include <opencv/cv.h>
+#include <memory>
+#include <vector>
+
+namespace dmscanlib {
+
+class DecodeOptions;
+
+/**
+ * Everything about a decode that only depends on the type of pallet and the
+ * decode options: the well rectangles and their labels, and for every tier of
+ * the decode ladder the libdmtx settings and scan grid of each well.
+ *
+ * A plan is immutable once built, so one plan can be shared by any number of
+ * decodes, including decodes running at the same time. Built once for a rack
+ * type, repeated decodes go straight to the pixel work. Wells of the same size
+ * share their settings and scan grids, on a regular pallet that is one set per
+ * tier.
+ *
+ * The legacy decode calls build a plan from their arguments for every decode.
+ */
+class DecodePlan {
+public:
+    /*
+     * The options and the well rectangles are copied.
+     */
+    DecodePlan(
+            const DecodeOptions & decodeOptions,
+            const std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+    /*
+     * The wells of a pallet of rows by cols tubes that fills the bounding box,
+     * labelled for the orientation and barcode position.
+     */
+    DecodePlan(
+            const DecodeOptions & decodeOptions,
+            const cv::Rect & bbox,
+            unsigned rows,
+            unsigned cols,
+            Orientation orientation,
+            BarcodePosition position);
+
+    virtual ~DecodePlan();
+
+    const DecodeOptions & getDecodeOptions() const {
+        return *decodeOptions;
+    }
+
+    const std::vector<std::unique_ptr<const WellRectangle> > & getWellRects() const {
+        return wellRects;
+    }
+
+    /*
+     * The libdmtx settings for a well when decoded with a tier of the ladder.
+     */
+    const DmtxDecodeSettings & getSettings(unsigned well, unsigned tier) const;
+
+    /*
+     * The scan grid for a well when decoded with a tier of the ladder, it is copied
+     * into each libdmtx decode.
+     */
+    const DmtxScanGrid & getScanGrid(unsigned well, unsigned tier) const;
+
+    /*
+     * The number of different sets of settings, one per well size.
+     */
+    unsigned getWellSizeCount() const {
+        return wellSetups.size();
+    }
+
+    /*
+     * Appends the wells of a pallet of rows by cols tubes that fills the bounding
+     * box. Throws std::logic_error if a well falls outside the bounding box.
+     */
+    static void getWellRectsForBoundingBox(
+            const cv::Rect & bbox,
+            unsigned rows,
+            unsigned cols,
+            Orientation orientation,
+            BarcodePosition position,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+private:
+    /*
+     * Settings and scan grids, one per tier, for the wells of one size.
+     */
+    class WellSetup {
+    public:
+        WellSetup(const cv::Size & size) :
+                size(size)
+        {
+        }
+
+        const cv::Size size;
+        std::vector<DmtxDecodeSettings> settings;
+        std::vector<DmtxScanGrid> grids;
+    };
+
+    DecodePlan(const DecodePlan &);
+    DecodePlan & operator=(const DecodePlan &);
+
+    static std::unique_ptr<DecodeOptions> copyOptions(const DecodeOptions & decodeOptions);
+
+    void init();
+    void addWellSetup(const cv::Size & size);
+
+    const std::unique_ptr<const DecodeOptions> decodeOptions;
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    std::vector<std::unique_ptr<const WellSetup> > wellSetups;
+
+    // index in wellSetups of each well
+    std::vector<unsigned> wellSetupIndexes;
+};
+
+} /* namespace */
+
+#endif /* DECODEPLAN_H_ */
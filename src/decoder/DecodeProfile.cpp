@@ -0,0 +1,45 @@
+/*
+ * DecodeProfile.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeProfile.h"
+
+#include <stdexcept>
+
+namespace dmscanlib {
+
+DecodeProfile::DecodeProfile(
+        const long _scale,
+        const double _scanGapFactor,
+        const long _squareDev,
+        const long _edgeThresh,
+        const long _corrections,
+        const bool _subPixel,
+        const int _symbolSize) :
+        scale(_scale),
+        scanGapFactor(_scanGapFactor),
+        squareDev(_squareDev),
+        edgeThresh(_edgeThresh),
+        corrections(_corrections),
+        subPixel(_subPixel),
+        symbolSize(_symbolSize)
+{
+    if (scale < 1) {
+        throw std::invalid_argument("decode profile scale must be at least 1");
+    }
+}
+
+std::ostream & operator<<(std::ostream &os, const DecodeProfile & m) {
+    os << "scale/" << m.scale
+            << " scanGapFactor/" << m.scanGapFactor
+            << " squareDev/" << m.squareDev
+            << " edgeThresh/" << m.edgeThresh
+            << " corrections/" << m.corrections
+            << " subPixel/" << m.subPixel
+            << " symbolSize/" << m.symbolSize;
+    return os;
+}
+
+} /* namespace */
@@ -0,0 +1,61 @@
+#ifndef DECODEPROFILE_H_
+#define DECODEPROFILE_H_
+
+/*
+ * DecodeProfile.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include <dmtx.h>
+#include <ostream>
+
+namespace dmscanlib {
+
+/**
+ * The libdmtx settings used for one decode attempt on a well.
+ *
+ * DecodeOptions holds an ordered ladder of these. Every well is first tried with
+ * the first profile, and only the wells that are still undecoded move on to the
+ * next one, so cheap profiles should come first.
+ *
+ * A sub-pixel profile is meant for low resolution scans of 2 to 4 pixels per
+ * module: libdmtx refines the symbol outline to sub-pixel accuracy and reads
+ * module colors by bilinear interpolation instead of rounding to the nearest
+ * pixel.
+ *
+ * The symbol size is a DmtxSymbolSize value. A fixed size saves libdmtx from
+ * trying every size on each region it finds, but regions of any other size are
+ * then not decoded.
+ */
+class DecodeProfile {
+public:
+    DecodeProfile(
+            const long scale,
+            const double scanGapFactor,
+            const long squareDev,
+            const long edgeThresh,
+            const long corrections,
+            const bool subPixel = false,
+            const int symbolSize = DmtxSymbolSquareAuto);
+
+    virtual ~DecodeProfile() {
+    }
+
+    const long scale;
+    const double scanGapFactor;
+    const long squareDev;
+    const long edgeThresh;
+    const long corrections;
+    const bool subPixel;
+    const int symbolSize;
+
+private:
+    friend std::ostream & operator<<(std::ostream & os, const DecodeProfile & m);
+};
+
+std::ostream & operator<<(std::ostream & os, const DecodeProfile & m);
+
+} /* namespace */
+
+#endif /* DECODEPROFILE_H_ */
@@ -0,0 +1,137 @@
+/*
+ * DecodeReport.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeReport.h"
+
+#include <stdexcept>
+#include <iomanip>
+#include <OpenThreads/ScopedLock>
+
+namespace dmscanlib {
+
+DecodeReport::DecodeReport() :
+        countersAdded(false),
+        totalNanos(0)
+{
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        stageNanos[i] = 0;
+        stageCounts[i] = 0;
+    }
+}
+
+void DecodeReport::addStageTime(DecodeStage stage, util::dmUint64 nanos) {
+    if (stage >= STAGE_MAX) {
+        throw std::invalid_argument("invalid decode stage");
+    }
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    stageNanos[stage] += nanos;
+    ++stageCounts[stage];
+}
+
+util::dmUint64 DecodeReport::getStageNanos(DecodeStage stage) const {
+    if (stage >= STAGE_MAX) {
+        throw std::invalid_argument("invalid decode stage");
+    }
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return stageNanos[stage];
+}
+
+unsigned DecodeReport::getStageCount(DecodeStage stage) const {
+    if (stage >= STAGE_MAX) {
+        throw std::invalid_argument("invalid decode stage");
+    }
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return stageCounts[stage];
+}
+
+double DecodeReport::getStageMillis(DecodeStage stage) const {
+    return static_cast<double>(getStageNanos(stage)) / 1000000.0;
+}
+
+void DecodeReport::addStageCounters(DecodeStage stage, const util::PerfCounterValues & counters) {
+    if (stage >= STAGE_MAX) {
+        throw std::invalid_argument("invalid decode stage");
+    }
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    stageCounters[stage] += counters;
+    countersAdded = true;
+}
+
+util::PerfCounterValues DecodeReport::getStageCounters(DecodeStage stage) const {
+    if (stage >= STAGE_MAX) {
+        throw std::invalid_argument("invalid decode stage");
+    }
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return stageCounters[stage];
+}
+
+void DecodeReport::addWellCounters(
+        const std::string & label,
+        const util::PerfCounterValues & counters) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    wellCounters[label] += counters;
+    countersAdded = true;
+}
+
+bool DecodeReport::getWellCounters(
+        const std::string & label,
+        util::PerfCounterValues & counters) const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    std::map<std::string, util::PerfCounterValues>::const_iterator it = wellCounters.find(label);
+    if (it == wellCounters.end()) {
+        return false;
+    }
+    counters = it->second;
+    return true;
+}
+
+bool DecodeReport::hasCounters() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return countersAdded;
+}
+
+void DecodeReport::setTotalNanos(util::dmUint64 nanos) {
+    totalNanos = nanos;
+}
+
+const char * DecodeReport::getStageName(DecodeStage stage) {
+    switch (stage) {
+    case STAGE_IMAGE_LOAD: return "imageLoad";
+    case STAGE_GRAYSCALE: return "grayscale";
+    case STAGE_FILTER: return "filter";
+    case STAGE_WELL_CROP: return "wellCrop";
+    case STAGE_REGION_SEARCH: return "regionSearch";
+    case STAGE_MODULE_SAMPLING: return "moduleSampling";
+    case STAGE_ERROR_CORRECTION: return "errorCorrection";
+    case STAGE_IMAGE_WRITE: return "imageWrite";
+    default:
+        throw std::invalid_argument("invalid decode stage");
+    }
+}
+
+std::ostream & operator<<(std::ostream &os, const DecodeReport & m) {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    const bool counters = m.hasCounters();
+
+    os << std::fixed << std::setprecision(3)
+       << "total/" << static_cast<double>(m.getTotalNanos()) / 1000000.0 << "ms";
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        DecodeStage stage = static_cast<DecodeStage>(i);
+        os << " " << DecodeReport::getStageName(stage) << "/" << m.getStageMillis(stage)
+           << "ms(" << m.getStageCount(stage) << ")";
+        if (counters) {
+            os << "[" << m.getStageCounters(stage) << "]";
+        }
+    }
+
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+} /* namespace */
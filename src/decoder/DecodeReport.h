@@ -0,0 +1,113 @@
+#ifndef DECODEREPORT_H_
+#define DECODEREPORT_H_
+
+/*
+ * DecodeReport.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+#include "utils/PerfCounters.h"
+#include "utils/ScopedTimer.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <OpenThreads/Mutex>
+
+namespace dmscanlib {
+
+enum DecodeStage {
+    STAGE_IMAGE_LOAD,
+    STAGE_GRAYSCALE,
+    STAGE_FILTER,
+    STAGE_WELL_CROP,
+    STAGE_REGION_SEARCH,
+    STAGE_MODULE_SAMPLING,
+    STAGE_ERROR_CORRECTION,
+    STAGE_IMAGE_WRITE,
+    STAGE_MAX
+};
+
+/**
+ * Where the time went for one decode of a pallet image.
+ *
+ * Each stage keeps the total time spent in it and the number of times it was
+ * entered. The per-well stages (crop, region search, module sampling and error
+ * correction) run on several threads at once, so their totals are CPU time
+ * summed over the threads and can add up to more than the elapsed time.
+ *
+ * When util::PerfCounters are on and available, each stage and each well also
+ * gets the hardware counters of the threads that ran it.
+ */
+class DecodeReport {
+public:
+    DecodeReport();
+
+    virtual ~DecodeReport() {
+    }
+
+    /*
+     * Called by multiple threads.
+     */
+    void addStageTime(DecodeStage stage, util::dmUint64 nanos);
+
+    util::dmUint64 getStageNanos(DecodeStage stage) const;
+
+    unsigned getStageCount(DecodeStage stage) const;
+
+    double getStageMillis(DecodeStage stage) const;
+
+    /*
+     * Called by multiple threads.
+     */
+    void addStageCounters(DecodeStage stage, const util::PerfCounterValues & counters);
+
+    util::PerfCounterValues getStageCounters(DecodeStage stage) const;
+
+    /*
+     * Called by multiple threads.
+     */
+    void addWellCounters(const std::string & label, const util::PerfCounterValues & counters);
+
+    /*
+     * Returns false if no counters were added for the well.
+     */
+    bool getWellCounters(const std::string & label, util::PerfCounterValues & counters) const;
+
+    /*
+     * True once any counters were added, false when only timings are available.
+     */
+    bool hasCounters() const;
+
+    void setTotalNanos(util::dmUint64 nanos);
+
+    util::dmUint64 getTotalNanos() const {
+        return totalNanos;
+    }
+
+    static const char * getStageName(DecodeStage stage);
+
+private:
+    util::dmUint64 stageNanos[STAGE_MAX];
+    unsigned stageCounts[STAGE_MAX];
+    util::PerfCounterValues stageCounters[STAGE_MAX];
+    std::map<std::string, util::PerfCounterValues> wellCounters;
+    bool countersAdded;
+    util::dmUint64 totalNanos;
+    mutable OpenThreads::Mutex mutex;
+
+    friend std::ostream & operator<<(std::ostream & os, const DecodeReport & m);
+};
+
+/*
+ * Times the enclosing scope into a stage of a DecodeReport.
+ */
+typedef util::ScopedTimer<DecodeReport, DecodeStage> StageTimer;
+
+std::ostream & operator<<(std::ostream & os, const DecodeReport & m);
+
+} /* namespace */
+
+#endif /* DECODEREPORT_H_ */
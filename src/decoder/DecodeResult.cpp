@@ -0,0 +1,52 @@
+/*
+ * DecodeResult.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeResult.h"
+#include "DmScanLib.h"
+#include "WellDecoder.h"
+
+namespace dmscanlib {
+
+WellResult::WellResult(const WellDecoder & wellDecoder) :
+        label(wellDecoder.getLabel()),
+        message(wellDecoder.getMessage()),
+        tier(wellDecoder.getDecodeTier()),
+        symbolSize(wellDecoder.getSymbolSize()),
+        decodeNanos(wellDecoder.getDecodeNanos()),
+        decodedQuad(wellDecoder.getDecodedQuad())
+{
+}
+
+DecodeResult::DecodeResult(
+        int _result,
+        const DecodeReport & decodeReport,
+        const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders) :
+        result(_result),
+        totalNanos(decodeReport.getTotalNanos())
+{
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        stageNanos[i] = decodeReport.getStageNanos(static_cast<DecodeStage>(i));
+    }
+
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        wells.push_back(std::unique_ptr<const WellResult>(new WellResult(*wellDecoders[i])));
+    }
+
+    if (result != SC_SUCCESS) {
+        return;
+    }
+
+    for (unsigned i = 0, n = wells.size(); i < n; ++i) {
+        if (!wells[i]->message.empty()) {
+            decodedWells[wells[i]->message] = wells[i].get();
+        }
+    }
+}
+
+DecodeResult::~DecodeResult() {
+}
+
+} /* namespace */
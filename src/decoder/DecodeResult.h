@@ -0,0 +1,101 @@
+#ifndef DECODERESULT_H_
+#define DECODERESULT_H_
+
+/*
+ * DecodeResult.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeReport.h"
+#include "utils/DmClock.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv/cv.h>
+
+namespace dmscanlib {
+
+class WellDecoder;
+
+/**
+ * The outcome for one well, copied from its WellDecoder.
+ */
+class WellResult {
+public:
+    WellResult(const WellDecoder & wellDecoder);
+
+    virtual ~WellResult() {
+    }
+
+    const std::string label;
+    // empty if the well was not decoded
+    const std::string message;
+    // -1 if the well was not decoded
+    const int tier;
+    const int symbolSize;
+    const util::dmUint64 decodeNanos;
+    const std::vector<cv::Point> decodedQuad;
+};
+
+/**
+ * Everything a decode of one pallet produced, copied out of the decoder once it
+ * has finished. Nothing in it changes afterwards, so it can be read from any
+ * thread and kept for as long as needed, independently of the session or the
+ * DmScanLib that produced it.
+ */
+class DecodeResult {
+public:
+    DecodeResult(
+            int result,
+            const DecodeReport & decodeReport,
+            const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders);
+
+    virtual ~DecodeResult();
+
+    int getResult() const {
+        return result;
+    }
+
+    util::dmUint64 getTotalNanos() const {
+        return totalNanos;
+    }
+
+    util::dmUint64 getStageNanos(DecodeStage stage) const {
+        return stageNanos[stage];
+    }
+
+    /*
+     * All the wells, decoded or not, in the order of the well rectangles.
+     */
+    const std::vector<std::unique_ptr<const WellResult> > & getWells() const {
+        return wells;
+    }
+
+    /*
+     * The decoded wells by message, empty unless the decode succeeded.
+     */
+    const std::map<std::string, const WellResult *> & getDecodedWells() const {
+        return decodedWells;
+    }
+
+    unsigned getDecodedWellCount() const {
+        return decodedWells.size();
+    }
+
+private:
+    DecodeResult(const DecodeResult &);
+    DecodeResult & operator=(const DecodeResult &);
+
+    const int result;
+    const util::dmUint64 totalNanos;
+    util::dmUint64 stageNanos[STAGE_MAX];
+    std::vector<std::unique_ptr<const WellResult> > wells;
+    std::map<std::string, const WellResult *> decodedWells;
+};
+
+} /* namespace */
+
+#endif /* DECODERESULT_H_ */
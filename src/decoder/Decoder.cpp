@@ -23,9 +23,14 @@
 
 #include "decoder/Decoder.h"
 #include "decoder/DecodeOptions.h"
+#include "decoder/DecodePlan.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/DecodeReport.h"
 #include "decoder/WellDecoder.h"
 #include "decoder/ThreadMgr.h"
 #include "decoder/DmtxDecodeHelper.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/TraceRecorder.h"
 #include "Image.h"
 #include "DmScanLib.h"
 
@@ -46,22 +51,59 @@ namespace dmscanlib {
 
 using namespace decoder;
 
+const long Decoder::CANCEL_CHECK_MSEC = 10;
+
 Decoder::Decoder(
         const Image & image,
-        const DecodeOptions & _decodeOptions,
-        std::vector<std::unique_ptr<const WellRectangle> > & _wellRects) :
-        decodeOptions(_decodeOptions),
-        wellRects(_wellRects),
-        decodeSuccessful(false)
+        const std::shared_ptr<const DecodePlan> & _plan,
+        DecodeReport & _decodeReport) :
+        workingImage(createWorkingImage(image, _decodeReport)),
+        plan(_plan),
+        decodeOptions(plan->getDecodeOptions()),
+        wellRects(plan->getWellRects()),
+        decodeSuccessful(false),
+        decodeReport(_decodeReport),
+        traceId(util::TraceRecorder::getContext())
+{
+    checkWellRects();
+}
+
+Decoder::Decoder(
+        const std::shared_ptr<const Image> & _workingImage,
+        const std::shared_ptr<const DecodePlan> & _plan,
+        DecodeReport & _decodeReport) :
+        workingImage(_workingImage),
+        plan(_plan),
+        decodeOptions(plan->getDecodeOptions()),
+        wellRects(plan->getWellRects()),
+        decodeSuccessful(false),
+        decodeReport(_decodeReport),
+        traceId(util::TraceRecorder::getContext())
 {
+    checkWellRects();
+}
+
+std::shared_ptr<const Image> Decoder::createWorkingImage(
+        const Image & image,
+        DecodeReport & decodeReport) {
     Image tmpImage;
-    image.grayscale(tmpImage);
-    tmpImage.applyFilters(grayscaleImage);
+    std::shared_ptr<Image> workingImage(new Image());
+    {
+        StageTimer timer(decodeReport, STAGE_GRAYSCALE);
+        image.grayscale(tmpImage);
+    }
+    {
+        StageTimer timer(decodeReport, STAGE_FILTER);
+        tmpImage.applyFilters(*workingImage);
+    }
     if (VLOG_IS_ON(2)) {
-        grayscaleImage.write("filtered.png");
+        workingImage->write("filtered.png");
     }
+    return workingImage;
+}
 
-    cv::Size size = grayscaleImage.size();
+void Decoder::checkWellRects() {
+    cv::Size size = workingImage->size();
     cv::Rect imageRect(0, 0, size.width, size.height);
     float width = static_cast<float>(size.width);
     float height = static_cast<float>(size.height);
@@ -96,48 +138,105 @@ int Decoder::decodeWellRects() {
 
         VLOG(5) << "well rect: " << wellRect;
 
-        const cv::Rect & rect = wellRect.getRectangle();
-
-        std::unique_ptr<WellRectangle> convertedWellRect(
-                new WellRectangle(
-                        wellRect.getLabel().c_str(),
-                        rect.x,
-                        rect.y,
-                        rect.width,
-                        rect.height
-                ));
-
-        wellDecoders[i] = std::unique_ptr<WellDecoder>(
-                new WellDecoder(*this, std::move(convertedWellRect)));
+        wellDecoders[i] = std::unique_ptr<WellDecoder>(new WellDecoder(*this, wellRect, i));
+    }
+    if (decodeOptions.getSpeculativeDecode()) {
+        return decodeSpeculative();
     }
     return decodeMultiThreaded();
     //return decodeSingleThreaded();
 }
 
+/*
+ * Each tier of the decode ladder is only applied to the wells that the previous
+ * tiers could not decode.
+ */
 int Decoder::decodeSingleThreaded() {
-    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
-        wellDecoders[i]->run();
-        if (!wellDecoders[i]->getMessage().empty()) {
-            decodedWells[wellDecoders[i]->getMessage()] = wellDecoders[i].get();
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    tierDecodeCounts.assign(profiles.size(), 0);
+
+    std::vector<WellDecoder *> undecoded;
+    for (unsigned tier = 0, n = profiles.size(); tier < n; ++tier) {
+        getUndecodedWells(undecoded);
+        if (undecoded.empty()) {
+            break;
+        }
+
+        for (unsigned i = 0, m = undecoded.size(); i < m; ++i) {
+            undecoded[i]->decode(*profiles[tier], tier, false);
         }
     }
-    return SC_SUCCESS;
+    return buildDecodedWells();
 }
 
 int Decoder::decodeMultiThreaded() {
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    tierDecodeCounts.assign(profiles.size(), 0);
+
     decoder::ThreadMgr threadMgr;
-    threadMgr.decodeWells(wellDecoders);
+    std::vector<WellDecoder *> undecoded;
+    for (unsigned tier = 0, n = profiles.size(); tier < n; ++tier) {
+        getUndecodedWells(undecoded);
+        if (undecoded.empty()) {
+            break;
+        }
+
+        VLOG(3) << "decodeMultiThreaded: tier " << tier << ": wells/" << undecoded.size()
+                << " profile: " << *profiles[tier];
+        threadMgr.decodeWells(undecoded, *profiles[tier], tier);
+    }
+    return buildDecodedWells();
+}
+
+/*
+ * Wells move through the ladder without waiting for the other wells to finish a
+ * tier. Once every well has been started, idle threads try the later tiers on the
+ * wells that are still being decoded. The first tier to decode a well cancels the
+ * other attempts on the same well.
+ */
+int Decoder::decodeSpeculative() {
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    tierDecodeCounts.assign(profiles.size(), 0);
+
+    std::vector<WellDecoder *> undecoded;
+    getUndecodedWells(undecoded);
+
+    decoder::ThreadMgr threadMgr;
+    threadMgr.decodeWellsSpeculative(undecoded, profiles);
+    return buildDecodedWells();
+}
 
+void Decoder::getUndecodedWells(std::vector<WellDecoder *> & undecoded) const {
+    undecoded.clear();
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        if (wellDecoders[i]->getMessage().empty()) {
+            undecoded.push_back(wellDecoders[i].get());
+        }
+    }
+}
+
+int Decoder::buildDecodedWells() {
     for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
         WellDecoder & wellDecoder = *wellDecoders[i];
         VLOG(5) << wellDecoder;
         if (!wellDecoder.getMessage().empty()) {
             if (decodedWells.find(wellDecoder.getMessage()) != decodedWells.end()) {
                 VLOG(1) << "duplicate decode message found: " << wellDecoder.getMessage();
+                util::MetricsRegistry::getInstance().addDuplicate();
                 return SC_FAIL;
             }
 
             decodedWells[wellDecoder.getMessage()] = &wellDecoder;
+            ++tierDecodeCounts[wellDecoder.getDecodeTier()];
+        }
+    }
+
+    if (VLOG_IS_ON(2)) {
+        for (unsigned tier = 0, n = tierDecodeCounts.size(); tier < n; ++tier) {
+            VLOG(2) << "decode tier " << tier << ": wells decoded/" << tierDecodeCounts[tier];
         }
     }
     decodeSuccessful = true;
@@ -161,56 +260,91 @@ const std::map<std::string, const WellDecoder *> & Decoder::getDecodedWells() co
 /*
  * Called by multiple threads.
  */
-void Decoder::decodeWellRect(const Image & wellRectImage, WellDecoder & wellDecoder) const {
+void Decoder::decodeWellRect(
+        const Image & wellRectImage,
+        WellDecoder & wellDecoder,
+        const DecodeProfile & profile,
+        unsigned tier,
+        bool cancellable) const {
     DmtxImage * dmtxImage = wellRectImage.dmtxImage();
     CHECK_NOTNULL(dmtxImage);
 
     std::unique_ptr<DmtxDecodeHelper> dec =
-            createDmtxDecode(dmtxImage, wellDecoder, decodeOptions.shrink);
-    decodeWellRect(wellDecoder, dec->getDecode());
+            createDmtxDecode(dmtxImage, wellDecoder, profile, tier);
+    decodeWellRect(wellDecoder, dec->getDecode(), profile.corrections, tier, cancellable);
     VLOG(5) << "decodeWellRect: " << wellDecoder;
 
-    if (wellDecoder.getMessage().empty()) {
-        dec = std::move(createDmtxDecode(
-                dmtxImage, wellDecoder, decodeOptions.shrink + 1));
-        decodeWellRect(wellDecoder, dec->getDecode());
-        VLOG(5) << "decodeWellRect: second attempt " << wellDecoder;
-    }
+    // the decode structure references the image, it has to be destroyed first
+    dec.reset();
     dmtxImageDestroy(&dmtxImage);
 }
 
 std::unique_ptr<DmtxDecodeHelper> Decoder::createDmtxDecode(
         DmtxImage * dmtxImage,
         WellDecoder & wellDecoder,
-        int scale) const {
-    std::unique_ptr<DmtxDecodeHelper> dec(new DmtxDecodeHelper(dmtxImage, scale));
-
-    cv::Rect bbox = wellDecoder.getWellRectangle();
-
-    unsigned mindim = std::min(bbox.width, bbox.height);
-
-    dec->setProperty(DmtxPropEdgeMin, static_cast<int>(decodeOptions.minEdgeFactor * mindim));
-    dec->setProperty(DmtxPropEdgeMax, static_cast<int>(decodeOptions.maxEdgeFactor * mindim));
-    dec->setProperty(DmtxPropScanGap, static_cast<int>(decodeOptions.scanGapFactor * mindim));
-
-    dec->setProperty(DmtxPropSymbolSize, DmtxSymbolSquareAuto);
-    dec->setProperty(DmtxPropSquareDevn, decodeOptions.squareDev);
-    dec->setProperty(DmtxPropEdgeThresh, decodeOptions.edgeThresh);
-
-    return dec;
+        const DecodeProfile & profile,
+        unsigned tier) const {
+    const unsigned well = wellDecoder.getWellIndex();
+    return std::unique_ptr<DmtxDecodeHelper>(new DmtxDecodeHelper(
+            dmtxImage,
+            profile.scale,
+            plan->getSettings(well, tier),
+            &plan->getScanGrid(well, tier)));
 }
 
-void Decoder::decodeWellRect(WellDecoder & wellDecoder, DmtxDecode *dec) const {
+/*
+ * When the attempt is cancellable the region search is done in short time slices so
+ * that it can stop once another attempt has decoded the well.
+ */
+void Decoder::decodeWellRect(
+        WellDecoder & wellDecoder,
+        DmtxDecode *dec,
+        long corrections,
+        unsigned tier,
+        bool cancellable) const {
     DmtxRegion * reg;
+    DmtxTime timeout;
     while (1) {
-        reg = dmtxRegionFindNext(dec, NULL);
-        if (reg == NULL) {
-            break;
+        if (cancellable) {
+            if (wellDecoder.isDecodedByOtherTier(tier)) {
+                VLOG(3) << "decodeWellRect: tier " << tier << " cancelled: "
+                        << wellDecoder.getLabel();
+                break;
+            }
+
+            timeout = dmtxTimeAdd(dmtxTimeNow(), CANCEL_CHECK_MSEC);
+            {
+                StageTimer timer(decodeReport, STAGE_REGION_SEARCH);
+                reg = dmtxRegionFindNext(dec, &timeout);
+            }
+            if (reg == NULL) {
+                if (dmtxTimeExceeded(timeout)) {
+                    // time slice used up, the scan grid continues where it left off
+                    continue;
+                }
+                break;
+            }
+        } else {
+            {
+                StageTimer timer(decodeReport, STAGE_REGION_SEARCH);
+                reg = dmtxRegionFindNext(dec, NULL);
+            }
+            if (reg == NULL) {
+                break;
+            }
         }
 
-        DmtxMessage *msg = dmtxDecodeMatrixRegion(dec, reg, decodeOptions.corrections);
+        DmtxMessage *msg;
+        {
+            StageTimer timer(decodeReport, STAGE_MODULE_SAMPLING);
+            msg = dmtxDecodeMatrixRegionPopulate(dec, reg);
+        }
+        if (msg != NULL) {
+            StageTimer timer(decodeReport, STAGE_ERROR_CORRECTION);
+            msg = dmtxDecodeMatrixRegionFinish(dec, reg, msg, corrections);
+        }
         if (msg != NULL) {
-            getDecodeInfo(dec, reg, msg, wellDecoder);
+            getDecodeInfo(dec, reg, msg, wellDecoder, tier);
 
             if (VLOG_IS_ON(5)) {
                 showStats(dec, reg, msg);
@@ -219,6 +353,7 @@ void Decoder::decodeWellRect(WellDecoder & wellDecoder, DmtxDecode *dec) const {
         }
         dmtxRegionDestroy(&reg);
     }
+    wellDecoder.addDecodeStats(dmtxDecodeGetStats(dec));
 
     if (VLOG_IS_ON(5)) {
         writeDiagnosticImage(dec, wellDecoder.getLabel());
@@ -230,15 +365,14 @@ void Decoder::getDecodeInfo(
         DmtxDecode *dec,
         DmtxRegion *reg,
         DmtxMessage *msg,
-        WellDecoder & wellDecoder) const {
+        WellDecoder & wellDecoder,
+        unsigned tier) const {
     CHECK_NOTNULL(dec);
     CHECK_NOTNULL(reg);
     CHECK_NOTNULL(msg);
 
     DmtxVector2 p00, p10, p11, p01;
 
-    wellDecoder.setMessage((char *) msg->output, msg->outputIdx);
-
     int height = dmtxDecodeGetProp(dec, DmtxPropHeight);
     p00.X = p00.Y = p10.Y = p01.X = 0.0;
     p10.X = p01.Y = p11.X = p11.Y = 1.0;
@@ -259,7 +393,11 @@ void Decoder::getDecodeInfo(
             cv::Point2f(static_cast<float>(p01.X), static_cast<float>(p01.Y)) * dec->scale
     };
 
-    wellDecoder.setDecodeQuad(points);
+    if (!wellDecoder.setDecodeResult((char *) msg->output, msg->outputIdx, points, tier,
+            reg->sizeIdx)) {
+        VLOG(3) << "getDecodeInfo: tier " << tier << " lost the race for well "
+                << wellDecoder.getLabel();
+    }
 }
 
 void Decoder::showStats(DmtxDecode * dec, DmtxRegion * reg, DmtxMessage * msg) {
@@ -38,6 +38,9 @@
 namespace dmscanlib {
 
 class DecodeOptions;
+class DecodePlan;
+class DecodeProfile;
+class DecodeReport;
 class WellDecoder;
 
 namespace decoder {
@@ -46,14 +49,59 @@ class DmtxDecodeHelper;
 
 class Decoder {
 public:
-    Decoder(const Image & image, const DecodeOptions & decodeOptions,
-            std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+    Decoder(const Image & image, const std::shared_ptr<const DecodePlan> & plan,
+            DecodeReport & decodeReport);
+
+    /*
+     * Decodes a working image made beforehand by createWorkingImage(), which may be
+     * used by other decodes at the same time.
+     */
+    Decoder(const std::shared_ptr<const Image> & workingImage,
+            const std::shared_ptr<const DecodePlan> & plan,
+            DecodeReport & decodeReport);
+
     virtual ~Decoder();
     int decodeWellRects();
-    void decodeWellRect(const Image & wellRectImage, WellDecoder & wellDecoder) const;
+
+    /*
+     * The tier is the profile's index in the ladder of the plan's options.
+     */
+    void decodeWellRect(
+            const Image & wellRectImage,
+            WellDecoder & wellDecoder,
+            const DecodeProfile & profile,
+            unsigned tier,
+            bool cancellable) const;
+
+    const DecodePlan & getDecodePlan() const {
+        return *plan;
+    }
 
     const Image & getWorkingImage() const {
-        return grayscaleImage;
+        return *workingImage;
+    }
+
+    /*
+     * The grayscale, filtered, image the wells are decoded from. The time taken is
+     * added to the report.
+     */
+    static std::shared_ptr<const Image> createWorkingImage(
+            const Image & image,
+            DecodeReport & decodeReport);
+
+    /*
+     * Stage timings are added to this report as the decode progresses.
+     */
+    DecodeReport & getDecodeReport() const {
+        return decodeReport;
+    }
+
+    /*
+     * The trace id of the thread that made the decoder, the threads decoding its
+     * wells work for the same trace.
+     */
+    unsigned getTraceId() const {
+        return traceId;
     }
 
     const unsigned getDecodedWellCount();
@@ -62,32 +110,59 @@ public:
         return wellDecoders;
     }
 
+    const std::vector<std::unique_ptr<WellDecoder> > & getWellDecoders() const {
+        return wellDecoders;
+    }
+
     const std::map<std::string, const WellDecoder *> & getDecodedWells() const;
 
+    /*
+     * Returns the number of wells decoded by each tier of the decode ladder.
+     */
+    const std::vector<unsigned> & getTierDecodeCounts() const {
+        return tierDecodeCounts;
+    }
+
     static void showStats(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg);
 
     static void writeDiagnosticImage(DmtxDecode *dec, const std::string & id);
 
 private:
-    void applyFilters();
-    void decodeWellRect(WellDecoder & wellDecoder, DmtxDecode *dec) const;
+    static const long CANCEL_CHECK_MSEC;
+
+    void checkWellRects();
+
+    void decodeWellRect(
+            WellDecoder & wellDecoder,
+            DmtxDecode *dec,
+            long corrections,
+            unsigned tier,
+            bool cancellable) const;
     std::unique_ptr<decoder::DmtxDecodeHelper> createDmtxDecode(
             DmtxImage * dmtxImage,
             WellDecoder & wellDecoder,
-            int scale) const;
+            const DecodeProfile & profile,
+            unsigned tier) const;
 
     void getDecodeInfo(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg,
-            WellDecoder & wellDecoder) const;
+            WellDecoder & wellDecoder, unsigned tier) const;
 
     int decodeSingleThreaded();
     int decodeMultiThreaded();
+    int decodeSpeculative();
+    void getUndecodedWells(std::vector<WellDecoder *> & undecoded) const;
+    int buildDecodedWells();
 
-    Image grayscaleImage;
+    const std::shared_ptr<const Image> workingImage;
+    const std::shared_ptr<const DecodePlan> plan;
     const DecodeOptions & decodeOptions;
     const std::vector<std::unique_ptr<const WellRectangle> > & wellRects;
     std::vector<std::unique_ptr<WellDecoder> > wellDecoders;
     bool decodeSuccessful;
     std::map<std::string, const WellDecoder *> decodedWells;
+    std::vector<unsigned> tierDecodeCounts;
+    DecodeReport & decodeReport;
+    const unsigned traceId;
 };
 
 } /* namespace */
@@ -19,6 +19,16 @@ DmtxDecodeHelper::DmtxDecodeHelper(DmtxImage * dmtxImage, int scale) :
     CHECK_NOTNULL(dec);
 }
 
+DmtxDecodeHelper::DmtxDecodeHelper(
+        DmtxImage * dmtxImage,
+        int scale,
+        const DmtxDecodeSettings & settings,
+        const DmtxScanGrid * grid) :
+        dec(dmtxDecodeCreateWithSettings(dmtxImage, scale, &settings, grid))
+{
+    CHECK_NOTNULL(dec);
+}
+
 DmtxDecodeHelper::~DmtxDecodeHelper() {
     dmtxDecodeDestroy(&dec);
 }
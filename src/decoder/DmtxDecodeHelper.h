@@ -17,6 +17,17 @@ namespace decoder {
 class DmtxDecodeHelper {
 public:
     DmtxDecodeHelper(DmtxImage * dmtxImage, int scale);
+
+    /*
+     * All the properties are set at once. The scan grid is copied when it matches
+     * the image, it may be NULL.
+     */
+    DmtxDecodeHelper(
+            DmtxImage * dmtxImage,
+            int scale,
+            const DmtxDecodeSettings & settings,
+            const DmtxScanGrid * grid);
+
     virtual ~DmtxDecodeHelper();
 
     unsigned setProperty(int prop, int value);
@@ -0,0 +1,168 @@
+/*
+ * ImageCache.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "decoder/ImageCache.h"
+#include "Image.h"
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <OpenThreads/ScopedLock>
+
+namespace dmscanlib {
+
+namespace decoder {
+
+namespace {
+
+size_t getImageBytes(const std::shared_ptr<const Image> & image) {
+    if (image.get() == NULL) {
+        return 0;
+    }
+    const cv::Mat mat = image->getOriginalImage();
+    return mat.total() * mat.elemSize();
+}
+
+} /* namespace */
+
+CachedImage::CachedImage(
+        const std::shared_ptr<const Image> & _image,
+        const std::shared_ptr<const Image> & _workingImage) :
+        image(_image),
+        workingImage(_workingImage),
+        bytes(getImageBytes(image) + getImageBytes(workingImage))
+{
+}
+
+ImageCache::Key::Key() :
+        modifiedTime(0),
+        fileSize(0)
+{
+}
+
+bool ImageCache::Key::operator==(const Key & that) const {
+    return (filename == that.filename)
+            && (modifiedTime == that.modifiedTime)
+            && (fileSize == that.fileSize);
+}
+
+ImageCache ImageCache::instance;
+
+ImageCache::ImageCache() :
+        bytes(0),
+        maxBytes(0)
+{
+}
+
+bool ImageCache::getKey(const std::string & filename, Key & key) {
+    struct stat status;
+    if (stat(filename.c_str(), &status) != 0) {
+        return false;
+    }
+
+    key.filename = filename;
+#ifdef WIN32
+    key.modifiedTime = static_cast<long long>(status.st_mtime) * 1000000000LL;
+#else
+    key.modifiedTime = static_cast<long long>(status.st_mtim.tv_sec) * 1000000000LL
+            + status.st_mtim.tv_nsec;
+#endif
+    key.fileSize = status.st_size;
+    return true;
+}
+
+void ImageCache::setMaxBytes(size_t _maxBytes) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    maxBytes = _maxBytes;
+    evict();
+}
+
+size_t ImageCache::getMaxBytes() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return maxBytes;
+}
+
+size_t ImageCache::getBytes() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return bytes;
+}
+
+unsigned ImageCache::getImageCount() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return entries.size();
+}
+
+std::shared_ptr<const CachedImage> ImageCache::find(const Key & key) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    for (EntryList::iterator ii = entries.begin(); ii != entries.end(); ++ii) {
+        if (ii->first == key) {
+            entries.splice(entries.begin(), entries, ii);
+            VLOG(2) << "ImageCache: found " << key.filename;
+            return entries.front().second;
+        }
+    }
+    return std::shared_ptr<const CachedImage>();
+}
+
+void ImageCache::insert(const Key & key, const std::shared_ptr<const CachedImage> & image) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    remove(key.filename);
+    if (image->bytes > maxBytes) {
+        return;
+    }
+
+    entries.push_front(std::make_pair(key, image));
+    bytes += image->bytes;
+    evict();
+    VLOG(2) << "ImageCache: added " << key.filename << ", images/" << entries.size()
+            << " bytes/" << bytes;
+}
+
+void ImageCache::invalidate(const std::string & filename) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    remove(filename);
+}
+
+void ImageCache::clear() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    entries.clear();
+    bytes = 0;
+}
+
+/*
+ * Called with the mutex held.
+ */
+void ImageCache::remove(const std::string & filename) {
+    EntryList::iterator ii = entries.begin();
+    while (ii != entries.end()) {
+        if (ii->first.filename == filename) {
+            bytes -= ii->second->bytes;
+            ii = entries.erase(ii);
+        } else {
+            ++ii;
+        }
+    }
+}
+
+/*
+ * Called with the mutex held. Decodes still using a dropped image keep it until
+ * they finish.
+ */
+void ImageCache::evict() {
+    while (bytes > maxBytes) {
+        VLOG(2) << "ImageCache: dropped " << entries.back().first.filename;
+        bytes -= entries.back().second->bytes;
+        entries.pop_back();
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
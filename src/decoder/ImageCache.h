@@ -0,0 +1,134 @@
+#ifndef IMAGECACHE_H_
+#define IMAGECACHE_H_
+
+/*
+ * ImageCache.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include <stddef.h>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <OpenThreads/Mutex>
+
+namespace dmscanlib {
+
+class Image;
+
+namespace decoder {
+
+/**
+ * An image file as it was loaded, and the working image the decoder made from
+ * it. Neither is modified once cached, so several decodes can use them at once.
+ */
+class CachedImage {
+public:
+    CachedImage(
+            const std::shared_ptr<const Image> & image,
+            const std::shared_ptr<const Image> & workingImage);
+
+    const std::shared_ptr<const Image> image;
+    const std::shared_ptr<const Image> workingImage;
+
+    // pixel memory held by both images
+    const size_t bytes;
+};
+
+/**
+ * The images of the files decoded most recently, so that decoding the same file
+ * again, for instance after moving the wells or changing the options, starts at
+ * the wells instead of loading, converting and filtering the image again.
+ *
+ * An image is found only while the file has the same size and modification time.
+ * Modification times are kept in nanoseconds, at the resolution of the file
+ * system. Where that is whole seconds, as on Windows, a file rewritten within the
+ * same second to the same size has to be invalidated.
+ *
+ * The least recently used images are dropped once the cache holds more than its
+ * maximum number of bytes. The maximum is zero, and the cache off, by default.
+ * There are only a few images this large, they are searched in order.
+ */
+class ImageCache {
+public:
+    class Key {
+    public:
+        Key();
+
+        bool operator==(const Key & that) const;
+
+        std::string filename;
+        // nanoseconds since the epoch
+        long long modifiedTime;
+        long long fileSize;
+    };
+
+    static ImageCache & getInstance() {
+        return instance;
+    }
+
+    /*
+     * Returns false if the file cannot be read.
+     */
+    static bool getKey(const std::string & filename, Key & key);
+
+    /*
+     * Images already cached are dropped until the cache fits.
+     */
+    void setMaxBytes(size_t maxBytes);
+
+    size_t getMaxBytes() const;
+
+    bool isEnabled() const {
+        return getMaxBytes() > 0;
+    }
+
+    size_t getBytes() const;
+
+    unsigned getImageCount() const;
+
+    /*
+     * Returns NULL when the image is not cached.
+     */
+    std::shared_ptr<const CachedImage> find(const Key & key);
+
+    /*
+     * Replaces any image cached for an earlier version of the file. An image larger
+     * than the whole cache is not kept.
+     */
+    void insert(const Key & key, const std::shared_ptr<const CachedImage> & image);
+
+    /*
+     * Drops the images of the file.
+     */
+    void invalidate(const std::string & filename);
+
+    void clear();
+
+private:
+    typedef std::list<std::pair<Key, std::shared_ptr<const CachedImage> > > EntryList;
+
+    ImageCache();
+    ImageCache(const ImageCache &);
+    ImageCache & operator=(const ImageCache &);
+
+    void remove(const std::string & filename);
+    void evict();
+
+    static ImageCache instance;
+
+    mutable OpenThreads::Mutex mutex;
+
+    // most recently used first
+    EntryList entries;
+    size_t bytes;
+    size_t maxBytes;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* IMAGECACHE_H_ */
@@ -0,0 +1,112 @@
+/*
+ * PackedDecodeResult.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "PackedDecodeResult.h"
+#include "WellDecoder.h"
+
+#include <string.h>
+
+namespace dmscanlib {
+
+const int32_t PackedDecodeResult::FORMAT_VERSION = 1;
+
+const unsigned PackedDecodeResult::HEADER_LENGTH = 4 * sizeof(int32_t) + sizeof(int64_t);
+
+const unsigned PackedDecodeResult::WELL_LENGTH = 13 * sizeof(int32_t) + sizeof(int64_t);
+
+namespace {
+
+unsigned paddedLength(unsigned length) {
+    return (length + 3) & ~3u;
+}
+
+/*
+ * The buffer has no alignment guarantees, hence the copies.
+ */
+class RecordWriter {
+public:
+    RecordWriter(unsigned char * _buffer) :
+            buffer(_buffer),
+            offset(0)
+    {
+    }
+
+    void putInt(int32_t value) {
+        memcpy(buffer + offset, &value, sizeof(value));
+        offset += sizeof(value);
+    }
+
+    void putLong(int64_t value) {
+        memcpy(buffer + offset, &value, sizeof(value));
+        offset += sizeof(value);
+    }
+
+    void putBytes(const std::string & bytes) {
+        memcpy(buffer + offset, bytes.data(), bytes.size());
+        const unsigned length = paddedLength(bytes.size());
+        memset(buffer + offset + bytes.size(), 0, length - bytes.size());
+        offset += length;
+    }
+
+private:
+    unsigned char * buffer;
+    unsigned offset;
+};
+
+} /* namespace */
+
+unsigned PackedDecodeResult::getPackedLength(
+        const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders) {
+    unsigned length = HEADER_LENGTH;
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        length += WELL_LENGTH + paddedLength(wellDecoders[i]->getMessage().size());
+    }
+    return length;
+}
+
+unsigned PackedDecodeResult::pack(
+        int result,
+        util::dmUint64 totalNanos,
+        const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders,
+        unsigned char * buffer,
+        unsigned capacity) {
+    const unsigned length = getPackedLength(wellDecoders);
+    if (capacity < HEADER_LENGTH) {
+        return length;
+    }
+
+    RecordWriter writer(buffer);
+    writer.putInt(FORMAT_VERSION);
+    writer.putInt(result);
+    writer.putInt(static_cast<int32_t>(wellDecoders.size()));
+    writer.putInt(static_cast<int32_t>(length));
+    writer.putLong(static_cast<int64_t>(totalNanos));
+
+    if (capacity < length) {
+        return length;
+    }
+
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        const WellDecoder & wellDecoder = *wellDecoders[i];
+        const std::string & message = wellDecoder.getMessage();
+        const std::vector<cv::Point> & quad = wellDecoder.getDecodedQuad();
+
+        writer.putInt(static_cast<int32_t>(i));
+        writer.putInt(message.empty() ? WELL_NOT_DECODED : WELL_DECODED);
+        writer.putInt(wellDecoder.getDecodeTier());
+        writer.putInt(wellDecoder.getSymbolSize());
+        writer.putLong(static_cast<int64_t>(wellDecoder.getDecodeNanos()));
+        for (unsigned c = 0; c < 4; ++c) {
+            writer.putInt((c < quad.size()) ? quad[c].x : 0);
+            writer.putInt((c < quad.size()) ? quad[c].y : 0);
+        }
+        writer.putInt(static_cast<int32_t>(message.size()));
+        writer.putBytes(message);
+    }
+    return length;
+}
+
+} /* namespace */
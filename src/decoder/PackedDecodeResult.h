@@ -0,0 +1,68 @@
+#ifndef PACKEDDECODERESULT_H_
+#define PACKEDDECODERESULT_H_
+
+/*
+ * PackedDecodeResult.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace dmscanlib {
+
+class WellDecoder;
+
+/**
+ * Serializes the results of a pallet into one binary record, so that they can be
+ * handed to the caller in a single buffer. Values are in the native byte order:
+ *
+ *   header: int32 version, int32 result, int32 wellCount, int32 length,
+ *           int64 totalNanos
+ *   well:   int32 wellIndex, int32 status, int32 tier, int32 symbolSize,
+ *           int64 decodeNanos, int32 quad[8], int32 messageLength,
+ *           message bytes, zero padded to a multiple of 4
+ *
+ * There is one well record for each well rectangle, in the order they were given
+ * to the decode, and wellIndex is the position of the rectangle. The quad is the
+ * (x, y) pairs of the corners of the decoded symbol in image coordinates, zero
+ * when the well was not decoded. length is the size of the whole record in bytes.
+ */
+class PackedDecodeResult {
+public:
+    enum WellStatus {
+        WELL_NOT_DECODED = 0,
+        WELL_DECODED = 1
+    };
+
+    /*
+     * Writes the record to the buffer and returns its length. When the buffer is
+     * smaller than that only the header is written, so that the caller can retry
+     * with a buffer of the length given in it. Nothing is written to a buffer
+     * smaller than the header.
+     */
+    static unsigned pack(
+            int result,
+            util::dmUint64 totalNanos,
+            const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders,
+            unsigned char * buffer,
+            unsigned capacity);
+
+    static unsigned getPackedLength(
+            const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders);
+
+    static const int32_t FORMAT_VERSION;
+
+    static const unsigned HEADER_LENGTH;
+
+    // well record length without the message
+    static const unsigned WELL_LENGTH;
+};
+
+} /* namespace */
+
+#endif /* PACKEDDECODERESULT_H_ */
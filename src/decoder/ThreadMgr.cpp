@@ -23,63 +23,184 @@
 #include "ThreadMgr.h"
 #include "DmScanLib.h"
 #include "WellDecoder.h"
+#include "DecodeProfile.h"
 
 #include <algorithm>
+#include <stdexcept>
 #include <vector>
 #include <memory>
 #include <glog/logging.h>
-
-#ifdef WIN32
-#   define NOMINMAX
-#   include <windows.h>
-#   undef ERROR
-#endif
+#include <OpenThreads/ScopedLock>
 
 namespace dmscanlib {
 
 namespace decoder {
 
-const unsigned ThreadMgr::THREAD_NUM = 8;
+const unsigned ThreadMgr::DEFAULT_THREAD_NUM = 8;
+
+unsigned ThreadMgr::threadCount = ThreadMgr::DEFAULT_THREAD_NUM;
 
-ThreadMgr::ThreadMgr() {
+ThreadMgr::ThreadMgr() :
+        queue(NULL),
+        queueIndex(0),
+        profile(NULL),
+        tier(0),
+        speculative(false),
+        profiles(NULL)
+{
 }
 
 ThreadMgr::~ThreadMgr() {
 }
 
-void ThreadMgr::decodeWells(std::vector<std::unique_ptr<WellDecoder> > & wellDecoders) {
-    numThreads = wellDecoders.size();
-    allThreads.resize(numThreads);
+void ThreadMgr::decodeWells(
+        std::vector<WellDecoder *> & wellDecoders,
+        const DecodeProfile & _profile,
+        unsigned _tier) {
+    queue = &wellDecoders;
+    queueIndex = 0;
+    profile = &_profile;
+    tier = _tier;
+    speculative = false;
+
+    startWorkers(wellDecoders.size());
+
+    VLOG(5) << "decodeWells: tier " << tier << " finished: wells/" << wellDecoders.size();
 
-    for (unsigned i = 0; i < numThreads; ++i) {
-        allThreads[i] = wellDecoders[i].get();
+    queue = NULL;
+    profile = NULL;
+}
+
+void ThreadMgr::decodeWellsSpeculative(
+        std::vector<WellDecoder *> & wellDecoders,
+        const std::vector<std::unique_ptr<const DecodeProfile> > & _profiles) {
+    profiles = &_profiles;
+    speculative = true;
+
+    attempts.resize(wellDecoders.size());
+    for (unsigned i = 0, n = wellDecoders.size(); i < n; ++i) {
+        attempts[i].wellDecoder = wellDecoders[i];
+        attempts[i].nextTier = 0;
+        attempts[i].inFlight = 0;
     }
 
-    threadHandler();
+    // there can be more attempts in flight than wells, so all threads are used
+    startWorkers(wellDecoders.empty() ? 0 : threadCount);
+
+    VLOG(5) << "decodeWellsSpeculative: finished: wells/" << wellDecoders.size();
+
+    attempts.clear();
+    profiles = NULL;
+    speculative = false;
+}
+
+void ThreadMgr::setThreadCount(unsigned count) {
+    if (count == 0) {
+        throw std::invalid_argument("thread count must be at least 1");
+    }
+    threadCount = count;
+}
+
+unsigned ThreadMgr::getThreadCount() {
+    return threadCount;
+}
+
+/*
+ * The calling thread waits while the pool threads decode the wells.
+ */
+void ThreadMgr::startWorkers(unsigned numWells) {
+    WorkerPool::getInstance().run(*this, std::min(numWells, threadCount));
 }
 
-void ThreadMgr::threadHandler() {
-    unsigned first = 0;
-    unsigned last = std::min(numThreads, THREAD_NUM);
+PoolJob::TaskStatus ThreadMgr::runTask() {
+    if (!speculative) {
+        WellDecoder * wellDecoder = nextWell();
+        if (wellDecoder == NULL) {
+            return TASK_DONE;
+        }
+        wellDecoder->decode(*profile, tier, false);
+        return TASK_RAN;
+    }
 
-    do {
-        threadProcessRange(first, last);
-        VLOG(5) << "Threads for cells finished: " << first << "/" << last - 1;
+    unsigned wellIndex;
+    unsigned attemptTier;
+    AttemptStatus status = nextAttempt(wellIndex, attemptTier);
+    if (status == ATTEMPT_DONE) {
+        return TASK_DONE;
+    } else if (status == ATTEMPT_WAIT) {
+        // attempts still running may fail and leave more tiers to try
+        return TASK_WAIT;
+    }
 
-        first = last;
-        last = std::min(last + THREAD_NUM, numThreads);
-    } while (first < numThreads);
+    try {
+        attempts[wellIndex].wellDecoder->decode(*(*profiles)[attemptTier], attemptTier, true);
+    } catch (...) {
+        finishAttempt(wellIndex);
+        throw;
+    }
+    finishAttempt(wellIndex);
+    return TASK_RAN;
 }
 
-//first is inclusive , last is exclusive
-void ThreadMgr::threadProcessRange(unsigned first, unsigned last) {
-    for (unsigned int i = first; i < last; i++) {
-        allThreads[i]->start();
+WellDecoder * ThreadMgr::nextWell() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queueMutex);
+    if (queueIndex >= queue->size()) {
+        return NULL;
     }
+    return (*queue)[queueIndex++];
+}
 
-    for (unsigned int j = first; j < last; j++) {
-        allThreads[j]->join();
+/*
+ * Picks the next attempt to run. Wells that have no attempt running are served
+ * first, lowest tier first, so the cheap tiers still run before the expensive ones.
+ * Once none are left, the later tiers of the wells still being decoded are started,
+ * spreading them over the wells with the fewest attempts running.
+ */
+ThreadMgr::AttemptStatus ThreadMgr::nextAttempt(unsigned & wellIndex, unsigned & attemptTier) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queueMutex);
+
+    const unsigned numTiers = profiles->size();
+    int idle = -1;
+    int racing = -1;
+    bool running = false;
+
+    for (unsigned i = 0, n = attempts.size(); i < n; ++i) {
+        const WellAttempts & well = attempts[i];
+        running = running || (well.inFlight > 0);
+
+        if ((well.nextTier >= numTiers) || (well.wellDecoder->getDecodeTier() >= 0)) {
+            continue;
+        }
+
+        if (well.inFlight == 0) {
+            if ((idle < 0) || (well.nextTier < attempts[idle].nextTier)) {
+                idle = i;
+            }
+        } else if ((racing < 0) || (well.inFlight < attempts[racing].inFlight)) {
+            racing = i;
+        }
     }
+
+    int selected = (idle >= 0) ? idle : racing;
+    if (selected < 0) {
+        return running ? ATTEMPT_WAIT : ATTEMPT_DONE;
+    }
+
+    WellAttempts & well = attempts[selected];
+    wellIndex = selected;
+    attemptTier = well.nextTier++;
+    ++well.inFlight;
+
+    if (selected == racing) {
+        VLOG(3) << "nextAttempt: speculative tier " << attemptTier << " for well "
+                << well.wellDecoder->getLabel();
+    }
+    return ATTEMPT_READY;
+}
+
+void ThreadMgr::finishAttempt(unsigned wellIndex) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queueMutex);
+    --attempts[wellIndex].inFlight;
 }
 
 } /* namespace */
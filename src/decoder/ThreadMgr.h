@@ -21,10 +21,13 @@
  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "WorkerPool.h"
+
 #include <dmtx.h>
 #include <string>
 #include <memory>
 #include <vector>
+#include <OpenThreads/Mutex>
 
 #ifdef _VISUALC_
 #   include <functional>
@@ -33,24 +36,77 @@
 namespace dmscanlib {
 
 class WellDecoder;
+class DecodeProfile;
 
 namespace decoder {
 
-class ThreadMgr {
+/*
+ * Decodes wells on the threads of the WorkerPool, using at most the configured
+ * number of threads. Each task takes the next well from a shared queue until the
+ * queue is empty.
+ *
+ * In speculative mode the tasks are (well, tier) attempts instead, and threads
+ * that would otherwise be idle race the later tiers on wells still being decoded.
+ */
+class ThreadMgr : public PoolJob {
 public:
     ThreadMgr();
     ~ThreadMgr();
 
-    void decodeWells(std::vector<std::unique_ptr<dmscanlib::WellDecoder> > & wellDecoders);
+    void decodeWells(
+            std::vector<dmscanlib::WellDecoder *> & wellDecoders,
+            const DecodeProfile & profile,
+            unsigned tier);
 
-private:
-    static const unsigned THREAD_NUM;
+    void decodeWellsSpeculative(
+            std::vector<dmscanlib::WellDecoder *> & wellDecoders,
+            const std::vector<std::unique_ptr<const DecodeProfile> > & profiles);
 
-    void threadHandler();
-    void threadProcessRange(unsigned int first, unsigned int last);
+    /*
+     * Sets the number of worker threads used by the decodes that start after this
+     * call. Throws std::invalid_argument if the count is zero.
+     */
+    static void setThreadCount(unsigned count);
 
-    std::vector<dmscanlib::WellDecoder *> allThreads;
-    unsigned numThreads;
+    static unsigned getThreadCount();
+
+    static const unsigned DEFAULT_THREAD_NUM;
+
+    /*
+     * Called by the pool threads.
+     */
+    virtual TaskStatus runTask();
+
+private:
+    static unsigned threadCount;
+
+    enum AttemptStatus {
+        ATTEMPT_READY,
+        ATTEMPT_WAIT,
+        ATTEMPT_DONE
+    };
+
+    // scheduling state for one well in speculative mode
+    struct WellAttempts {
+        dmscanlib::WellDecoder * wellDecoder;
+        unsigned nextTier;
+        unsigned inFlight;
+    };
+
+    void startWorkers(unsigned numWells);
+    dmscanlib::WellDecoder * nextWell();
+    AttemptStatus nextAttempt(unsigned & wellIndex, unsigned & attemptTier);
+    void finishAttempt(unsigned wellIndex);
+
+    OpenThreads::Mutex queueMutex;
+    std::vector<dmscanlib::WellDecoder *> * queue;
+    unsigned queueIndex;
+    const DecodeProfile * profile;
+    unsigned tier;
+
+    bool speculative;
+    const std::vector<std::unique_ptr<const DecodeProfile> > * profiles;
+    std::vector<WellAttempts> attempts;
 };
 
 } /* namespace */
@@ -10,8 +10,17 @@
 #include "WellDecoder.h"
 #include "Image.h"
 #include "Decoder.h"
+#include "DecodeProfile.h"
+#include "DecodeReport.h"
+#include "utils/DmClock.h"
+#include "utils/DmProbes.h"
+#include "utils/MetricsRegistry.h"
+#include "utils/PerfCounters.h"
+#include "utils/TraceRecorder.h"
 
 #include <sstream>
+#include <string.h>
+#include <OpenThreads/ScopedLock>
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 #include <glog/logging.h>
@@ -25,58 +34,164 @@ namespace dmscanlib {
 
 WellDecoder::WellDecoder(
         const Decoder & _decoder,
-        std::unique_ptr<const WellRectangle> _wellRectangle) :
+        const WellRectangle & _wellRectangle,
+        unsigned _wellIndex) :
         decoder(_decoder),
-        wellRectangle(std::move(_wellRectangle)),
-        rectangle(wellRectangle->getRectangle()),
-        decodedQuad()
+        wellRectangle(_wellRectangle),
+        wellIndex(_wellIndex),
+        rectangle(wellRectangle.getRectangle()),
+        decodedQuad(),
+        decodeTier(-1),
+        symbolSize(DmtxUndefined),
+        decodeNanos(0)
 {
+    memset(&decodeStats, 0, sizeof(decodeStats));
     decodedQuad.reserve(4);
     VLOG(9) << "constructor: bounding box: " << rectangle
-            << ", rect: " << wellRectangle->getRectangle();
+            << ", rect: " << wellRectangle.getRectangle();
 }
 
 WellDecoder::~WellDecoder() {
 }
 
 /*
- * This method runs in its own thread.
+ * Called by the decoding threads. More than one thread may be decoding this well at
+ * the same time when speculative decoding is enabled, each with a different tier.
  */
-void WellDecoder::run() {
-    wellImage = decoder.getWorkingImage().crop(
-            rectangle.x,
-            rectangle.y,
-            rectangle.width,
-            rectangle.height);
-    decoder.decodeWellRect(*wellImage, *this);
-    if (!message.empty()) {
-        VLOG(3) << "run: " << *this;
-    } else {
-        VLOG(3) << "run: " << wellRectangle->getLabel() << " - could not be decoded";
+void WellDecoder::decode(const DecodeProfile & profile, unsigned tier, bool cancellable) {
+    if (tier > 0) {
+        util::MetricsRegistry::getInstance().addRetry();
     }
-}
 
-void WellDecoder::setMessage(const char * message, int messageLength) {
-    this->message.assign(message, messageLength);
-}
+    const util::TraceContext traceContext(decoder.getTraceId());
+    std::string detail;
+    if (util::TraceRecorder::isEnabled()) {
+        std::ostringstream ss;
+        ss << wellRectangle.getLabel() << " tier " << tier;
+        detail = ss.str();
+    }
+    util::TraceScope trace("decodeWell", detail.c_str());
 
+    DM_PROBE2(well__begin, getLabel().c_str(), tier);
 
-const cv::Rect WellDecoder::getWellRectangle() const {	
-    CHECK_NOTNULL(wellRectangle.get());
-	VLOG(9) << "getWellRectangle: bbox: " << wellRectangle->getRectangle();
+    const util::PerfCounterStart countersStart;
+    const util::dmUint64 start = util::DmClock::nowNanos();
+    decoder.decodeWellRect(getWellImage(), *this, profile, tier, cancellable);
+    const util::dmUint64 elapsed = util::DmClock::nowNanos() - start;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+        decodeNanos += elapsed;
+    }
+
+    DM_PROBE4(well__end, getLabel().c_str(), tier,
+            (getDecodeTier() == static_cast<int>(tier)) ? 1 : 0, elapsed);
+
+    util::PerfCounterValues counters;
+    if (countersStart.getElapsed(counters)) {
+        decoder.getDecodeReport().addWellCounters(getLabel(), counters);
+    }
+
+    VLOG(4) << "decode: tier " << tier << ": " << getLabel() << " search effort: "
+            << getDecodeStats();
 
-	return wellRectangle->getRectangle();
+    if (getDecodeTier() == static_cast<int>(tier)) {
+        VLOG(3) << "decode: tier " << tier << ": " << *this;
+    } else {
+        VLOG(3) << "decode: tier " << tier << ": " << wellRectangle.getLabel()
+                << " - could not be decoded";
+    }
+}
+
+/*
+ * The cropped well image is kept so that the following tiers do not have to crop
+ * it again.
+ */
+const Image & WellDecoder::getWellImage() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    if (wellImage.get() == NULL) {
+        StageTimer timer(decoder.getDecodeReport(), STAGE_WELL_CROP);
+        wellImage = decoder.getWorkingImage().crop(
+                rectangle.x,
+                rectangle.y,
+                rectangle.width,
+                rectangle.height);
+    }
+    return *wellImage;
 }
 
 // the quadrilateral passed in is in coordinates of the cropped image,
 // the quadrilateral has to be translated into the coordinates of the overall
 // image
-void WellDecoder::setDecodeQuad(const cv::Point2f (&points)[4]) {
+//
+// returns false if the well was already decoded by an attempt using a different tier
+bool WellDecoder::setDecodeResult(
+        const char * message,
+        int messageLength,
+        const cv::Point2f (&points)[4],
+        unsigned tier,
+        int _symbolSize) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    if ((decodeTier >= 0) && (decodeTier != static_cast<int>(tier))) {
+        return false;
+    }
+
+    this->message.assign(message, messageLength);
+
     const cv::Point & bboxTl = rectangle.tl();
+    decodedQuad.clear();
     for (unsigned i = 0; i < 4; ++i) {
         const cv::Point pt = points[i];
         decodedQuad.push_back(pt + bboxTl);
     }
+    decodeTier = tier;
+    symbolSize = _symbolSize;
+
+    DM_PROBE3(message__decoded, getLabel().c_str(), this->message.c_str(), tier);
+    return true;
+}
+
+int WellDecoder::getDecodeTier() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    return decodeTier;
+}
+
+int WellDecoder::getSymbolSize() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    return symbolSize;
+}
+
+util::dmUint64 WellDecoder::getDecodeNanos() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    return decodeNanos;
+}
+
+void WellDecoder::addDecodeStats(const DmtxDecodeStats & stats) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    decodeStats.gridLocations += stats.gridLocations;
+    decodeStats.seekEdgeCalls += stats.seekEdgeCalls;
+    decodeStats.failOrientation += stats.failOrientation;
+    decodeStats.failTopEdge += stats.failTopEdge;
+    decodeStats.failRightEdge += stats.failRightEdge;
+    decodeStats.failFindSize += stats.failFindSize;
+    decodeStats.failDecode += stats.failDecode;
+    decodeStats.regionsFound += stats.regionsFound;
+    decodeStats.pixelsSampled += stats.pixelsSampled;
+}
+
+DmtxDecodeStats WellDecoder::getDecodeStats() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    return decodeStats;
+}
+
+bool WellDecoder::isDecodedByOtherTier(unsigned tier) const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(resultMutex);
+    return (decodeTier >= 0) && (decodeTier != static_cast<int>(tier));
+}
+
+const cv::Rect WellDecoder::getWellRectangle() const {	
+	VLOG(9) << "getWellRectangle: bbox: " << wellRectangle.getRectangle();
+
+	return wellRectangle.getRectangle();
 }
 
 std::ostream & operator<<(std::ostream &os, const WellDecoder & m) {
@@ -84,4 +199,17 @@ std::ostream & operator<<(std::ostream &os, const WellDecoder & m) {
     return os;
 }
 
+std::ostream & operator<<(std::ostream &os, const DmtxDecodeStats & m) {
+    os << "grid/" << m.gridLocations
+       << " seekEdge/" << m.seekEdgeCalls
+       << " failOrientation/" << m.failOrientation
+       << " failTopEdge/" << m.failTopEdge
+       << " failRightEdge/" << m.failRightEdge
+       << " failFindSize/" << m.failFindSize
+       << " failDecode/" << m.failDecode
+       << " regions/" << m.regionsFound
+       << " pixels/" << m.pixelsSampled;
+    return os;
+}
+
 } /* namespace */
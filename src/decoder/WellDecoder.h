@@ -2,6 +2,7 @@
 #define __INC_PALLET_CELL_H
 
 #include "WellRectangle.h"
+#include "utils/DmClock.h"
 
 #include <dmtx.h>
 #include <opencv/cv.h>
@@ -9,37 +10,48 @@
 #include <ostream>
 #include <memory>
 #include <OpenThreads/Mutex>
-#include <OpenThreads/ScopedLock>
-#include <OpenThreads/Thread>
 
 namespace dmscanlib {
 
 class Decoder;
+class DecodeProfile;
 class Image;
 class RgbQuad;
 class PalletGrid;
 
-class WellDecoder: public ::OpenThreads::Thread {
+class WellDecoder {
 public:
+    /*
+     * The well rectangle belongs to the decoder's DecodePlan, the index is the
+     * well's position in the plan.
+     */
     WellDecoder(
             const Decoder & decoder,
-            std::unique_ptr<const WellRectangle> _wellRectangle);
+            const WellRectangle & wellRectangle,
+            unsigned wellIndex);
 
     virtual ~WellDecoder();
 
-    virtual void run();
-
-    bool isFinished();
+    void decode(const DecodeProfile & profile, unsigned tier, bool cancellable = false);
 
     const std::string & getLabel() const {
-        return wellRectangle->getLabel();
+        return wellRectangle.getLabel();
+    }
+
+    unsigned getWellIndex() const {
+        return wellIndex;
     }
 
     const std::string & getMessage() const {
         return message;
     }
 
-    void setMessage(const char * message, int messageLength);
+    bool setDecodeResult(
+            const char * message,
+            int messageLength,
+            const cv::Point2f (&points)[4],
+            unsigned tier,
+            int symbolSize);
 
     const cv::Rect getWellRectangle() const;
 
@@ -47,23 +59,64 @@ public:
         return decodedQuad;
     }
 
-    void setDecodeQuad(const cv::Point2f (&points)[4]);
-
     const bool getDecodeValid() {
         return message.empty();
     }
 
+    /*
+     * Returns the index of the profile, in the decode ladder, that decoded this
+     * well, or -1 if the well was not decoded.
+     */
+    int getDecodeTier() const;
+
+    /*
+     * Returns the DmtxSymbolSize of the decoded symbol, or DmtxUndefined if the well
+     * was not decoded.
+     */
+    int getSymbolSize() const;
+
+    /*
+     * Returns true if an attempt using a different tier has already decoded this well.
+     * Used to cancel attempts that have lost a speculative race.
+     */
+    bool isDecodedByOtherTier(unsigned tier) const;
+
+    /*
+     * Returns the time spent decoding this well, summed over all the attempts.
+     */
+    util::dmUint64 getDecodeNanos() const;
+
+    /*
+     * Adds the libdmtx search effort of one attempt on this well.
+     */
+    void addDecodeStats(const DmtxDecodeStats & stats);
+
+    /*
+     * Returns the libdmtx search effort for this well, summed over all the attempts.
+     */
+    DmtxDecodeStats getDecodeStats() const;
+
 private:
+    const Image & getWellImage();
+
     const Decoder & decoder;
-    std::unique_ptr<const WellRectangle> wellRectangle;
+    const WellRectangle & wellRectangle;
+    const unsigned wellIndex;
     std::unique_ptr<const Image> wellImage;
     cv::Rect rectangle;
     std::vector<cv::Point> decodedQuad;
     std::string message;
+    int decodeTier;
+    int symbolSize;
+    util::dmUint64 decodeNanos;
+    DmtxDecodeStats decodeStats;
+    mutable OpenThreads::Mutex resultMutex;
 
     friend std::ostream & operator<<(std::ostream & os, const WellDecoder & m);
 };
 
+std::ostream & operator<<(std::ostream & os, const DmtxDecodeStats & m);
+
 } /* namespace */
 
 #endif /* __INC_PALLET_CELL_H */
@@ -0,0 +1,174 @@
+/*
+ * WorkerPool.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+namespace dmscanlib {
+
+namespace decoder {
+
+WorkerPool WorkerPool::instance;
+
+class PoolWorker : public OpenThreads::Thread {
+public:
+    PoolWorker(WorkerPool & _workerPool) :
+            workerPool(_workerPool) {
+    }
+
+    virtual ~PoolWorker() {
+    }
+
+    /*
+     * This method runs in its own thread.
+     */
+    virtual void run() {
+        workerPool.runWorker();
+    }
+
+private:
+    WorkerPool & workerPool;
+};
+
+WorkerPool::WorkerPool() :
+        nextJobIndex(0),
+        stopping(false)
+{
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        stopping = true;
+        workAvailable.broadcast();
+    }
+
+    for (unsigned i = 0, n = workers.size(); i < n; ++i) {
+        workers[i]->join();
+    }
+}
+
+void WorkerPool::run(PoolJob & job, unsigned maxWorkers) {
+    if (maxWorkers == 0) {
+        return;
+    }
+
+    JobEntry entry;
+    entry.job = &job;
+    entry.maxWorkers = maxWorkers;
+    entry.running = 0;
+    entry.waiting = false;
+    entry.done = false;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    startThreads(maxWorkers);
+    jobs.push_back(&entry);
+    workAvailable.broadcast();
+
+    while (!entry.done || (entry.running > 0)) {
+        jobFinished.wait(&mutex);
+    }
+
+    jobs.erase(std::find(jobs.begin(), jobs.end(), &entry));
+    VLOG(5) << "run: job finished: jobs/" << jobs.size();
+
+    if (entry.error) {
+        std::rethrow_exception(entry.error);
+    }
+}
+
+unsigned WorkerPool::getThreadCount() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return workers.size();
+}
+
+unsigned WorkerPool::getJobCount() const {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return jobs.size();
+}
+
+/*
+ * Called with the mutex held.
+ */
+void WorkerPool::startThreads(unsigned count) {
+    while (workers.size() < count) {
+        workers.push_back(std::unique_ptr<PoolWorker>(new PoolWorker(*this)));
+        workers.back()->start();
+        VLOG(3) << "startThreads: threads/" << workers.size();
+    }
+}
+
+/*
+ * Called with the mutex held. The jobs are served in turn, starting after the
+ * one that was served last, skipping those that already have all the threads
+ * they asked for and those that are waiting on their running tasks.
+ */
+WorkerPool::JobEntry * WorkerPool::nextJob() {
+    for (unsigned i = 0, n = jobs.size(); i < n; ++i) {
+        const unsigned index = (nextJobIndex + i) % n;
+        JobEntry * entry = jobs[index];
+        if (!entry->done && !entry->waiting && (entry->running < entry->maxWorkers)) {
+            nextJobIndex = index + 1;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void WorkerPool::runWorker() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    while (!stopping) {
+        JobEntry * entry = nextJob();
+        if (entry == NULL) {
+            workAvailable.wait(&mutex);
+            continue;
+        }
+
+        ++entry->running;
+        PoolJob::TaskStatus status = PoolJob::TASK_RAN;
+        mutex.unlock();
+        std::exception_ptr error;
+        try {
+            status = entry->job->runTask();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        mutex.lock();
+        --entry->running;
+
+        if (error) {
+            // no more of the job's tasks are started, run() rethrows the first error
+            if (!entry->error) {
+                entry->error = error;
+            }
+            entry->done = true;
+        } else if (status == PoolJob::TASK_DONE) {
+            entry->done = true;
+        } else if (status == PoolJob::TASK_WAIT) {
+            // served again once one of the job's running tasks finishes, if none is
+            // left running the job is tried again straight away
+            entry->waiting = (entry->running > 0);
+        } else if (entry->waiting) {
+            entry->waiting = false;
+            workAvailable.broadcast();
+        }
+
+        if (entry->done && (entry->running == 0)) {
+            jobFinished.broadcast();
+        }
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
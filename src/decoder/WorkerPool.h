@@ -0,0 +1,111 @@
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+/*
+ * WorkerPool.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include <exception>
+#include <memory>
+#include <vector>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+
+namespace dmscanlib {
+
+namespace decoder {
+
+class PoolWorker;
+
+/*
+ * Work submitted to the WorkerPool, split into small tasks.
+ */
+class PoolJob {
+public:
+    enum TaskStatus {
+        // a task was run, there may be more
+        TASK_RAN,
+        // no task can start until one of the job's running tasks finishes
+        TASK_WAIT,
+        // no tasks are left
+        TASK_DONE
+    };
+
+    virtual ~PoolJob() {
+    }
+
+    /*
+     * Called by the pool threads, by several of them at once.
+     */
+    virtual TaskStatus runTask() = 0;
+};
+
+/**
+ * The process wide threads that decode the wells of every pallet.
+ *
+ * Each decode submits its wells as a job, and a pool thread takes one task at a
+ * time from the jobs in turn, so pallets decoded at the same time, for instance
+ * by the scanners of one station, share the threads fairly instead of each
+ * starting its own. The pool grows to the largest thread count a job asked for
+ * and the threads are kept for the life of the process.
+ */
+class WorkerPool {
+public:
+    static WorkerPool & getInstance() {
+        return instance;
+    }
+
+    /*
+     * Runs the job's tasks on at most maxWorkers pool threads at once. Returns
+     * once the job has no tasks left and none are running.
+     *
+     * If a task throws, no more of the job's tasks are started and the first
+     * exception is rethrown here, on the calling thread, once the running tasks
+     * have finished.
+     */
+    void run(PoolJob & job, unsigned maxWorkers);
+
+    unsigned getThreadCount() const;
+
+    unsigned getJobCount() const;
+
+private:
+    WorkerPool();
+    WorkerPool(const WorkerPool &);
+    WorkerPool & operator=(const WorkerPool &);
+    ~WorkerPool();
+
+    struct JobEntry {
+        PoolJob * job;
+        unsigned maxWorkers;
+        unsigned running;
+        bool waiting;
+        bool done;
+        // the first exception thrown by one of the job's tasks
+        std::exception_ptr error;
+    };
+
+    friend class PoolWorker;
+
+    void runWorker();
+    void startThreads(unsigned count);
+    JobEntry * nextJob();
+
+    static WorkerPool instance;
+
+    mutable OpenThreads::Mutex mutex;
+    OpenThreads::Condition workAvailable;
+    OpenThreads::Condition jobFinished;
+    std::vector<JobEntry *> jobs;
+    unsigned nextJobIndex;
+    std::vector<std::unique_ptr<PoolWorker> > workers;
+    bool stopping;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* WORKERPOOL_H_ */
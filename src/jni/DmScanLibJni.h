@@ -1,44 +1,23 @@
-/* DO NOT EDIT THIS FILE - it is machine generated */
+#ifndef DMSCANLIBJNI_H_
+#define DMSCANLIBJNI_H_
+
+/*
+ * DmScanLibJni.h
+ *
+ *  Created on: 2026-10-18
+ *
+ *  The native methods of edu.ualberta.med.scannerconfig.dmscanlib.ScanLib. The
+ *  names and the Java type signatures must follow the native declarations of
+ *  that class.
+ */
+
 #include <jni.h>
-/* Header for class edu_ualberta_med_scannerconfig_dmscanlib_ScanLib */
 
-#ifndef _Included_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
-#define _Included_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
 #ifdef __cplusplus
 extern "C" {
 #endif
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_MIN_PLATE_NUM
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_MIN_PLATE_NUM 1L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_MAX_PLATE_NUM
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_MAX_PLATE_NUM 5L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_SUCCESS
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_SUCCESS 0L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_FAIL
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_FAIL -1L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_TWAIN_UNAVAIL
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_TWAIN_UNAVAIL -2L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_DPI
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_DPI -3L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_NOTHING_DECODED
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_NOTHING_DECODED -4L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_IMAGE
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_IMAGE -5L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_NOTHING_TO_DECODE
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INVALID_NOTHING_TO_DECODE -6L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INCORRECT_DPI_SCANNED
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_SC_INCORRECT_DPI_SCANNED -7L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_IS_WIA
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_IS_WIA 1L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_300
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_300 2L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_400
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_400 4L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_600
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_DPI_600 8L
-#undef edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_IS_SCANNER
-#define edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_CAP_IS_SCANNER 16L
-/*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+
+/*
  * Method:    selectSourceAsDefault
  * Signature: ()Ledu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult;
  */
@@ -46,7 +25,6 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
   (JNIEnv *, jobject);
 
 /*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    getScannerCapability
  * Signature: ()Ledu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult;
  */
@@ -54,7 +32,6 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
   (JNIEnv *, jobject);
 
 /*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    scanImage
  * Signature: (JJIIDDDDLjava/lang/String;)Ledu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult;
  */
@@ -62,7 +39,6 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
   (JNIEnv *, jobject, jlong, jlong, jint, jint, jdouble, jdouble, jdouble, jdouble, jstring);
 
 /*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    scanFlatbed
  * Signature: (JJIILjava/lang/String;)Ledu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult;
  */
@@ -70,7 +46,6 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
   (JNIEnv *, jobject, jlong, jlong, jint, jint, jstring);
 
 /*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    scanAndDecode
  * Signature: (JJIIDDDDLedu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;[Ledu/ualberta/med/scannerconfig/dmscanlib/CellRectangle;)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
  */
@@ -78,14 +53,126 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
   (JNIEnv *, jobject, jlong, jlong, jint, jint, jdouble, jdouble, jdouble, jdouble, jobject, jobjectArray);
 
 /*
- * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    decodeImage
  * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;[Ledu/ualberta/med/scannerconfig/dmscanlib/CellRectangle;)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
  */
 JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_decodeImage
   (JNIEnv *, jobject, jlong, jstring, jobject, jobjectArray);
 
+/*
+ * Method:    getMetrics
+ * Signature: ()Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_getMetrics
+  (JNIEnv *, jobject);
+
+/*
+ * Method:    setMetricsFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setMetricsFilename
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Method:    setTraceFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setTraceFilename
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Method:    setHeatmapFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setHeatmapFilename
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Method:    setPerfCountersEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setPerfCountersEnabled
+  (JNIEnv *, jobject, jboolean);
+
+/*
+ * Method:    setCapture
+ * Signature: (Ljava/lang/String;IIZ)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setCapture
+  (JNIEnv *, jobject, jstring, jint, jint, jboolean);
+
+/*
+ * Method:    setImageCacheSize
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setImageCacheSize
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Method:    invalidateImageCache
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_invalidateImageCache
+  (JNIEnv *, jobject, jstring);
+
+/*
+ * Method:    createWellLayout
+ * Signature: ([D[Ljava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_createWellLayout
+  (JNIEnv *, jobject, jdoubleArray, jobjectArray);
+
+/*
+ * Method:    releaseWellLayout
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_releaseWellLayout
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Method:    openSession
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_openSession
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Method:    closeSession
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_closeSession
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Method:    sessionDecodeImage
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;J)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
+ */
+JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeImage
+  (JNIEnv *, jobject, jlong, jstring, jobject, jlong);
+
+/*
+ * Method:    sessionDecodeImageToBuffer
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeImageToBuffer
+  (JNIEnv *, jobject, jlong, jstring, jobject, jlong, jobject);
+
+/*
+ * Method:    sessionDecodeEncodedImage
+ * Signature: (JLjava/nio/ByteBuffer;ILedu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeEncodedImage
+  (JNIEnv *, jobject, jlong, jobject, jint, jobject, jlong, jobject);
+
+/*
+ * Method:    sessionDecodePixels
+ * Signature: (JLjava/nio/ByteBuffer;IIIILedu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodePixels
+  (JNIEnv *, jobject, jlong, jobject, jint, jint, jint, jint, jobject, jlong, jobject);
+
 #ifdef __cplusplus
 }
 #endif
-#endif
+
+#endif /* DMSCANLIBJNI_H_ */
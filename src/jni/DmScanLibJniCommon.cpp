@@ -7,26 +7,92 @@
 #include "DmScanLibJni.h"
 #include "DmScanLibJniInternal.h"
 #include "DmScanLib.h"
+#include "DecodeSession.h"
 #include "decoder/DecodeOptions.h"
+#include "decoder/DecodeReport.h"
+#include "decoder/PackedDecodeResult.h"
 #include "decoder/WellDecoder.h"
+#include "utils/MetricsRegistry.h"
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <map>
 #include <memory>
+#include <vector>
 #include <glog/logging.h>
 
 namespace dmscanlib {
 
 namespace jni {
 
-jobject createScanResultObject(JNIEnv * env, int resultCode, int value) {
-    jclass scanLibResultClass = env->FindClass(
-            "edu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult");
+JniCache JniCache::instance;
+
+JniCache::JniCache() :
+        scanLibResultClass(NULL),
+        scanLibResultCons(NULL),
+        decodeResultClass(NULL),
+        decodeResultCons(NULL),
+        decodeResultAddWell(NULL)
+{
+}
+
+namespace {
+
+jclass findGlobalClass(JNIEnv * env, const char * name) {
+    jclass localClass = env->FindClass(name);
+    if (localClass == NULL) {
+        return NULL;
+    }
+    jclass globalClass = static_cast<jclass>(env->NewGlobalRef(localClass));
+    env->DeleteLocalRef(localClass);
+    return globalClass;
+}
 
+} /* namespace */
+
+bool JniCache::load(JNIEnv * env) {
     // run the following command to obtain method signatures from a class.
     // javap -s -p edu.ualberta.med.scannerconfig.dmscanlib.ScanLibResult
-    jmethodID cons = env->GetMethodID(scanLibResultClass, "<init>",
-            "(IILjava/lang/String;)V");
+    instance.scanLibResultClass = findGlobalClass(env,
+            "edu/ualberta/med/scannerconfig/dmscanlib/ScanLibResult");
+    if (instance.scanLibResultClass == NULL) {
+        return false;
+    }
+    instance.scanLibResultCons = env->GetMethodID(instance.scanLibResultClass,
+            "<init>", "(IILjava/lang/String;)V");
+    if (instance.scanLibResultCons == NULL) {
+        return false;
+    }
+
+    // javap -s -p edu.ualberta.med.scannerconfig.dmscanlib.DecodeResult
+    instance.decodeResultClass = findGlobalClass(env,
+            "edu/ualberta/med/scannerconfig/dmscanlib/DecodeResult");
+    if (instance.decodeResultClass == NULL) {
+        return false;
+    }
+    instance.decodeResultCons = env->GetMethodID(instance.decodeResultClass,
+            "<init>", "(IILjava/lang/String;)V");
+    if (instance.decodeResultCons == NULL) {
+        return false;
+    }
+    instance.decodeResultAddWell = env->GetMethodID(instance.decodeResultClass,
+            "addWell", "(Ljava/lang/String;Ljava/lang/String;)V");
+    return instance.decodeResultAddWell != NULL;
+}
+
+void JniCache::unload(JNIEnv * env) {
+    if (instance.scanLibResultClass != NULL) {
+        env->DeleteGlobalRef(instance.scanLibResultClass);
+    }
+    if (instance.decodeResultClass != NULL) {
+        env->DeleteGlobalRef(instance.decodeResultClass);
+    }
+    instance = JniCache();
+}
+
+jobject createScanResultObject(JNIEnv * env, int resultCode, int value) {
+    const JniCache & cache = JniCache::getInstance();
 
     std::string msg;
     getResultCodeMsg(resultCode, msg);
@@ -36,17 +102,11 @@ jobject createScanResultObject(JNIEnv * env, int resultCode, int value) {
     data[1].i = value;
     data[2].l = env->NewStringUTF(msg.c_str());
 
-    return env->NewObjectA(scanLibResultClass, cons, data);
+    return env->NewObjectA(cache.scanLibResultClass, cache.scanLibResultCons, data);
 }
 
 jobject createDecodeResultObject(JNIEnv * env, int resultCode) {
-    jclass resultClass = env->FindClass(
-            "edu/ualberta/med/scannerconfig/dmscanlib/DecodeResult");
-
-    // run the following command to obtain method signatures from a class.
-    // javap -s -p edu.ualberta.med.scannerconfig.dmscanlib.DecodeResult
-    jmethodID cons = env->GetMethodID(resultClass, "<init>",
-            "(IILjava/lang/String;)V");
+    const JniCache & cache = JniCache::getInstance();
 
     std::string msg;
     getResultCodeMsg(resultCode, msg);
@@ -56,32 +116,32 @@ jobject createDecodeResultObject(JNIEnv * env, int resultCode) {
     data[1].i = 0;
     data[2].l = env->NewStringUTF(msg.c_str());
 
-    return env->NewObjectA(resultClass, cons, data);
+    return env->NewObjectA(cache.decodeResultClass, cache.decodeResultCons, data);
 }
 
 jobject createDecodeResultObject(JNIEnv * env, int resultCode,
         const std::map<std::string, const dmscanlib::WellDecoder *> & wellDecoders) {
     jobject resultObj = createDecodeResultObject(env, resultCode);
 
-    jclass resultClass = env->FindClass(
-            "edu/ualberta/med/scannerconfig/dmscanlib/DecodeResult");
-
     if (wellDecoders.size() > 0) {
-        jmethodID setCellMethod = env->GetMethodID(resultClass, "addWell",
-                "(Ljava/lang/String;Ljava/lang/String;)V");
+        const JniCache & cache = JniCache::getInstance();
 
         for (std::map<std::string, const dmscanlib::WellDecoder *>::const_iterator ii =
                 wellDecoders.begin();
                 ii != wellDecoders.end(); ++ii) {
             const dmscanlib::WellDecoder & wellDecoder = *(ii->second);
-            jvalue data[3];
+            jvalue data[2];
 
             VLOG(5) << wellDecoder;
 
             data[0].l = env->NewStringUTF(wellDecoder.getLabel().c_str());
             data[1].l = env->NewStringUTF(wellDecoder.getMessage().c_str());
 
-            env->CallObjectMethodA(resultObj, setCellMethod, data);
+            env->CallVoidMethodA(resultObj, cache.decodeResultAddWell, data);
+
+            // a 96 well rack would otherwise overflow the local reference table
+            env->DeleteLocalRef(data[0].l);
+            env->DeleteLocalRef(data[1].l);
         }
 
         VLOG(1) << "wells decoded: " << wellDecoders.size();
@@ -90,6 +150,32 @@ jobject createDecodeResultObject(JNIEnv * env, int resultCode,
     return resultObj;
 }
 
+/*
+ * The corners are the four (x, y) pairs of the well, the rectangle is their
+ * bounding box.
+ */
+std::unique_ptr<const WellRectangle> createWellRectangle(const char * label,
+        const double * corners) {
+    double xmin = corners[0];
+    double ymin = corners[1];
+    double xmax = corners[0];
+    double ymax = corners[1];
+
+    for (unsigned i = 1; i < 4; ++i) {
+        xmin = std::min(xmin, corners[2 * i]);
+        ymin = std::min(ymin, corners[2 * i + 1]);
+        xmax = std::max(xmax, corners[2 * i]);
+        ymax = std::max(ymax, corners[2 * i + 1]);
+    }
+
+    return std::unique_ptr<const WellRectangle>(
+            new WellRectangle(label,
+            static_cast<unsigned>(xmin),
+            static_cast<unsigned>(ymin),
+            static_cast<unsigned>(xmax - xmin),
+            static_cast<unsigned>(ymax - ymin)));
+}
+
 int getWellRectangles(JNIEnv *env, jsize numWells, jobjectArray _wellRects,
         std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
     jobject wellRectJavaObj;
@@ -134,45 +220,244 @@ int getWellRectangles(JNIEnv *env, jsize numWells, jobjectArray _wellRects,
         jobject labelJobj = env->CallObjectMethod(wellRectJavaObj, wellRectGetLabelMethodID);
         const char * label = env->GetStringUTFChars((jstring) labelJobj, NULL);
 
-        double x1 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerXMethodID, 0);
-        double y1 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerYMethodID, 0);
+        double corners[8];
+        for (int c = 0; c < 4; ++c) {
+            corners[2 * c] = env->CallDoubleMethod(
+                    wellRectJavaObj, wellRectGetCornerXMethodID, c);
+            corners[2 * c + 1] = env->CallDoubleMethod(
+                    wellRectJavaObj, wellRectGetCornerYMethodID, c);
+        }
+
+        std::unique_ptr<const WellRectangle> wellRect = createWellRectangle(label, corners);
+
+        VLOG(5) << *wellRect;
+
+        wellRects.push_back(std::move(wellRect));
+
+        env->ReleaseStringUTFChars((jstring) labelJobj, label);
+        env->DeleteLocalRef(labelJobj);
+        env->DeleteLocalRef(wellRectJavaObj);
+    }
+    return 1;
+}
 
-        double x2 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerXMethodID, 1);
-        double y2 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerYMethodID, 1);
+/*
+ * Bulk variant: _corners holds eight values per well, the (x, y) pairs of its
+ * four corners, and _labels one label per well. The corners are copied with a
+ * single call instead of eight upcalls per well.
+ */
+int getWellRectangles(JNIEnv *env, jdoubleArray _corners, jobjectArray _labels,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    const jsize numWells = env->GetArrayLength(_labels);
 
-        double x3 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerXMethodID, 2);
-        double y3 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerYMethodID, 2);
+    VLOG(5) << "decodeImage: numWells/" << numWells;
 
-        double x4 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerXMethodID, 3);
-        double y4 = env->CallDoubleMethod(wellRectJavaObj, wellRectGetCornerYMethodID, 3);
+    if (env->GetArrayLength(_corners) != 8 * numWells) {
+        return 2;
+    }
 
-        double xmin = std::min(x1, std::min(x2, std::min(x3, x4)));
-        double ymin = std::min(y1, std::min(y2, std::min(y3, y4)));
+    std::vector<double> corners(8 * numWells);
+    if (numWells > 0) {
+        env->GetDoubleArrayRegion(_corners, 0, 8 * numWells, &corners[0]);
+        if (env->ExceptionOccurred()) {
+            return 0;
+        }
+    }
 
-        double xmax = std::max(x1, std::max(x2, std::max(x3, x4)));
-        double ymax = std::max(y1, std::max(y2, std::max(y3, y4)));
+    wellRects.reserve(wellRects.size() + numWells);
+    for (jsize i = 0; i < numWells; ++i) {
+        jstring labelJobj = static_cast<jstring>(env->GetObjectArrayElement(_labels, i));
+        if (labelJobj == NULL) {
+            return 2;
+        }
 
-        std::unique_ptr<const WellRectangle> wellRect(
-                new WellRectangle(label, 
-				static_cast<unsigned>(xmin), 
-				static_cast<unsigned>(ymin), 
-				static_cast<unsigned>(xmax - xmin), 
-				static_cast<unsigned>(ymax - ymin)));
+        const char * label = env->GetStringUTFChars(labelJobj, NULL);
+        std::unique_ptr<const WellRectangle> wellRect =
+                createWellRectangle(label, &corners[8 * i]);
+        env->ReleaseStringUTFChars(labelJobj, label);
+        env->DeleteLocalRef(labelJobj);
 
         VLOG(5) << *wellRect;
 
         wellRects.push_back(std::move(wellRect));
-
-        env->ReleaseStringUTFChars((jstring) labelJobj, label);
-        env->DeleteLocalRef(wellRectJavaObj);
     }
     return 1;
 }
 
+/*
+ * Returns NULL if the buffer is not a direct byte buffer.
+ */
+unsigned char * getDirectBuffer(JNIEnv * env, jobject _buffer, unsigned & capacity) {
+    unsigned char * buffer = static_cast<unsigned char *>(env->GetDirectBufferAddress(_buffer));
+    const jlong bufferCapacity = env->GetDirectBufferCapacity(_buffer);
+    if ((buffer == NULL) || (bufferCapacity < 0)) {
+        return NULL;
+    }
+    capacity = static_cast<unsigned>(std::min<jlong>(bufferCapacity, 0x7fffffff));
+    return buffer;
+}
+
+jint packDecodeResult(JNIEnv * env, const DecodeSession & session, int result,
+        jobject _resultBuffer) {
+    unsigned capacity;
+    unsigned char * buffer = getDirectBuffer(env, _resultBuffer, capacity);
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    return static_cast<jint>(PackedDecodeResult::pack(
+            result,
+            session.getDecodeReport().getTotalNanos(),
+            session.getWellDecoders(),
+            buffer,
+            capacity));
+}
+
+namespace {
+
+jobject decodeImageWells(JNIEnv * env, jlong _verbose, jstring _filename,
+        jobject _decodeOptions,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    dmscanlib::DmScanLib::configLogging(static_cast<unsigned>(_verbose), false);
+    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
+            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
+    if (decodeOptions.get() == NULL) {
+        // got an exception when converting from JNI
+        return NULL;
+    }
+
+    dmscanlib::DmScanLib dmScanLib(1);
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    int result = dmScanLib.decodeImageWells(filename, *decodeOptions, wellRects);
+    env->ReleaseStringUTFChars(_filename, filename);
+
+    if (result == dmscanlib::SC_SUCCESS) {
+        return createDecodeResultObject(env, result, dmScanLib.getDecodedWells());
+    }
+    return createDecodeResultObject(env, result);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    decodeImage
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;[D[Ljava/lang/String;)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
+ *
+ * Registered in JNI_OnLoad, see registerNatives().
+ */
+jobject JNICALL decodeImageCorners(
+        JNIEnv * env, jobject obj, jlong _verbose, jstring _filename,
+        jobject _decodeOptions, jdoubleArray _corners, jobjectArray _labels) {
+
+    if ((_filename == 0) || (_decodeOptions == 0) || (_corners == 0) || (_labels == 0)) {
+        return createDecodeResultObject(env, dmscanlib::SC_FAIL);
+    }
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    int result = getWellRectangles(env, _corners, _labels, wellRects);
+
+    if (result == 0) {
+        // got an exception when converting from JNI
+        return NULL;
+    } else if ((result != 1) || (wellRects.size() == 0)) {
+        // invalid rects or zero rects passed from java
+        return createDecodeResultObject(env, dmscanlib::SC_INVALID_NOTHING_TO_DECODE);
+    }
+
+    return decodeImageWells(env, _verbose, _filename, _decodeOptions, wellRects);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    decodeImage
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;J)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
+ *
+ * Registered in JNI_OnLoad, see registerNatives(). The last argument is a
+ * handle returned by createWellLayout().
+ */
+jobject JNICALL decodeImageLayout(
+        JNIEnv * env, jobject obj, jlong _verbose, jstring _filename,
+        jobject _decodeOptions, jlong _layout) {
+
+    if ((_filename == 0) || (_decodeOptions == 0) || (_layout == 0)) {
+        return createDecodeResultObject(env, dmscanlib::SC_FAIL);
+    }
+
+    WellLayout * layout = reinterpret_cast<WellLayout *>(_layout);
+    if (layout->wellRects.size() == 0) {
+        return createDecodeResultObject(env, dmscanlib::SC_INVALID_NOTHING_TO_DECODE);
+    }
+
+    return decodeImageWells(env, _verbose, _filename, _decodeOptions, layout->wellRects);
+}
+
+/*
+ * The decodeImage() overloads are registered explicitly: with overloaded native
+ * methods the JVM would otherwise bind every overload to the short
+ * Java_..._decodeImage symbol.
+ *
+ * On failure the pending exception is cleared, so that JNI_OnLoad can carry on
+ * with the exported symbols.
+ */
+bool registerNatives(JNIEnv * env) {
+    jclass scanLibClass = env->FindClass("edu/ualberta/med/scannerconfig/dmscanlib/ScanLib");
+    if (scanLibClass == NULL) {
+        env->ExceptionClear();
+        return false;
+    }
+
+    JNINativeMethod methods[2];
+    methods[0].name = const_cast<char *>("decodeImage");
+    methods[0].signature = const_cast<char *>(
+            "(JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;"
+            "[D[Ljava/lang/String;)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;");
+    methods[0].fnPtr = reinterpret_cast<void *>(decodeImageCorners);
+    methods[1].name = const_cast<char *>("decodeImage");
+    methods[1].signature = const_cast<char *>(
+            "(JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;J)"
+            "Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;");
+    methods[1].fnPtr = reinterpret_cast<void *>(decodeImageLayout);
+
+    const jint result = env->RegisterNatives(scanLibClass, methods, 2);
+    if (result != JNI_OK) {
+        env->ExceptionClear();
+    }
+    env->DeleteLocalRef(scanLibClass);
+    return result == JNI_OK;
+}
+
 } /* namespace */
 
 } /* namespace */
 
+} /* namespace */
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM * vm, void * reserved) {
+    JNIEnv * env;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return JNI_ERR;
+    }
+
+    if (!dmscanlib::jni::JniCache::load(env)) {
+        dmscanlib::jni::JniCache::unload(env);
+        return JNI_ERR;
+    }
+
+    // a ScanLib without the overloads still binds to the exported symbols
+    if (!dmscanlib::jni::registerNatives(env)) {
+        LOG(WARNING) << "JNI_OnLoad: decodeImage overloads not registered";
+    }
+    return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM * vm, void * reserved) {
+    JNIEnv * env;
+    if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        return;
+    }
+    dmscanlib::jni::JniCache::unload(env);
+}
+
 /*
  * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
  * Method:    decodeImage
@@ -186,9 +471,6 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
         return dmscanlib::jni::createDecodeResultObject(env, dmscanlib::SC_FAIL);
     }
 
-    dmscanlib::DmScanLib::configLogging(static_cast<unsigned>(_verbose), false);
-    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
-            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
     std::vector<std::unique_ptr<const dmscanlib::WellRectangle> > wellRects;
 
     jsize numWells = env->GetArrayLength(_wellRects);
@@ -203,15 +485,349 @@ JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_
                 dmscanlib::SC_INVALID_NOTHING_TO_DECODE);
     }
 
-    dmscanlib::DmScanLib dmScanLib(1);
+    return dmscanlib::jni::decodeImageWells(env, _verbose, _filename, _decodeOptions, wellRects);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    createWellLayout
+ * Signature: ([D[Ljava/lang/String;)J
+ *
+ * Converts the well corners and labels once, the returned handle can be passed to
+ * decodeImage() for every pallet with the same layout. Returns 0 when the arrays
+ * are invalid.
+ */
+JNIEXPORT jlong JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_createWellLayout(
+        JNIEnv * env, jobject obj, jdoubleArray _corners, jobjectArray _labels) {
+    if ((_corners == 0) || (_labels == 0)) {
+        return 0;
+    }
+
+    std::unique_ptr<dmscanlib::jni::WellLayout> layout(new dmscanlib::jni::WellLayout());
+    if (dmscanlib::jni::getWellRectangles(env, _corners, _labels, layout->wellRects) != 1) {
+        return 0;
+    }
+    return reinterpret_cast<jlong>(layout.release());
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    releaseWellLayout
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_releaseWellLayout(
+        JNIEnv * env, jobject obj, jlong _layout) {
+    delete reinterpret_cast<dmscanlib::jni::WellLayout *>(_layout);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    getMetrics
+ * Signature: ()Ljava/lang/String;
+ *
+ * Returns the process wide decode metrics in the text exposition format.
+ */
+JNIEXPORT jstring JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_getMetrics(
+        JNIEnv * env, jobject obj) {
+    std::ostringstream os;
+    dmscanlib::util::MetricsRegistry::getInstance().snapshot()->writeText(os);
+    return env->NewStringUTF(os.str().c_str());
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setMetricsFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setMetricsFilename(
+        JNIEnv * env, jobject obj, jstring _filename) {
+    if (_filename == 0) {
+        dmscanlib::DmScanLib::setMetricsFilename("");
+        return;
+    }
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    dmscanlib::DmScanLib::setMetricsFilename(filename);
+    env->ReleaseStringUTFChars(_filename, filename);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setTraceFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setTraceFilename(
+        JNIEnv * env, jobject obj, jstring _filename) {
+    if (_filename == 0) {
+        dmscanlib::DmScanLib::setTraceFilename("");
+        return;
+    }
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    dmscanlib::DmScanLib::setTraceFilename(filename);
+    env->ReleaseStringUTFChars(_filename, filename);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setHeatmapFilename
+ * Signature: (Ljava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setHeatmapFilename(
+        JNIEnv * env, jobject obj, jstring _filename) {
+    if (_filename == 0) {
+        dmscanlib::DmScanLib::setHeatmapFilename("");
+        return;
+    }
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    dmscanlib::DmScanLib::setHeatmapFilename(filename);
+    env->ReleaseStringUTFChars(_filename, filename);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setPerfCountersEnabled
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setPerfCountersEnabled(
+        JNIEnv * env, jobject obj, jboolean enable) {
+    dmscanlib::DmScanLib::setPerfCountersEnabled(enable == JNI_TRUE);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setCapture
+ * Signature: (Ljava/lang/String;IIZ)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setCapture(
+        JNIEnv * env, jobject obj, jstring _directory, jint sampleEvery,
+        jint latencyThresholdMillis, jboolean wellsOnly) {
+    if ((_directory == 0) || (sampleEvery < 0) || (latencyThresholdMillis < 0)) {
+        dmscanlib::DmScanLib::setCapture("", 0, 0, false);
+        return;
+    }
+
+    const char *directory = env->GetStringUTFChars(_directory, 0);
+    dmscanlib::DmScanLib::setCapture(
+            directory,
+            static_cast<unsigned>(sampleEvery),
+            static_cast<unsigned>(latencyThresholdMillis),
+            wellsOnly == JNI_TRUE);
+    env->ReleaseStringUTFChars(_directory, directory);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    setImageCacheSize
+ * Signature: (J)V
+ *
+ * The size is in bytes, zero or less turns the cache off.
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_setImageCacheSize(
+        JNIEnv * env, jobject obj, jlong bytes) {
+    dmscanlib::DmScanLib::setImageCacheSize((bytes > 0) ? static_cast<size_t>(bytes) : 0);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    invalidateImageCache
+ * Signature: (Ljava/lang/String;)V
+ *
+ * A null filename drops every cached image.
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_invalidateImageCache(
+        JNIEnv * env, jobject obj, jstring _filename) {
+    if (_filename == 0) {
+        dmscanlib::DmScanLib::invalidateImageCache("");
+        return;
+    }
 
     const char *filename = env->GetStringUTFChars(_filename, 0);
-    result = dmScanLib.decodeImageWells(filename, *decodeOptions, wellRects);
+    dmscanlib::DmScanLib::invalidateImageCache(filename);
+    env->ReleaseStringUTFChars(_filename, filename);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    openSession
+ * Signature: (J)J
+ *
+ * Returns a handle to a decode session, which keeps the scanner and the state
+ * learned from earlier pallets from one sessionDecodeImage() call to the next. It
+ * has to be released with closeSession().
+ */
+JNIEXPORT jlong JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_openSession(
+        JNIEnv * env, jobject obj, jlong _verbose) {
+    return reinterpret_cast<jlong>(
+            new dmscanlib::DecodeSession(static_cast<unsigned>(_verbose)));
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    closeSession
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_closeSession(
+        JNIEnv * env, jobject obj, jlong _session) {
+    delete reinterpret_cast<dmscanlib::DecodeSession *>(_session);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    sessionDecodeImage
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;J)Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeResult;
+ *
+ * The last argument is a handle returned by createWellLayout().
+ */
+JNIEXPORT jobject JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeImage(
+        JNIEnv * env, jobject obj, jlong _session, jstring _filename,
+        jobject _decodeOptions, jlong _layout) {
+
+    if ((_session == 0) || (_filename == 0) || (_decodeOptions == 0) || (_layout == 0)) {
+        return dmscanlib::jni::createDecodeResultObject(env, dmscanlib::SC_FAIL);
+    }
+
+    dmscanlib::DecodeSession * session = reinterpret_cast<dmscanlib::DecodeSession *>(_session);
+    dmscanlib::jni::WellLayout * layout = reinterpret_cast<dmscanlib::jni::WellLayout *>(_layout);
+    if (layout->wellRects.size() == 0) {
+        return dmscanlib::jni::createDecodeResultObject(env,
+                dmscanlib::SC_INVALID_NOTHING_TO_DECODE);
+    }
+
+    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
+            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
+    if (decodeOptions.get() == NULL) {
+        // got an exception when converting from JNI
+        return NULL;
+    }
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    int result = session->decodeImageWells(filename, *decodeOptions, layout->wellRects);
     env->ReleaseStringUTFChars(_filename, filename);
 
     if (result == dmscanlib::SC_SUCCESS) {
-        return dmscanlib::jni::createDecodeResultObject(env, result, dmScanLib.getDecodedWells());
+        return dmscanlib::jni::createDecodeResultObject(env, result, session->getDecodedWells());
     }
     return dmscanlib::jni::createDecodeResultObject(env, result);
 }
 
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    sessionDecodeImageToBuffer
+ * Signature: (JLjava/lang/String;Ledu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ *
+ * Like sessionDecodeImage() but the results are written to the direct byte buffer
+ * in the PackedDecodeResult format. Returns the length of the record, when it is
+ * larger than the buffer only the record header was written. Returns -1 if the
+ * arguments are invalid.
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeImageToBuffer(
+        JNIEnv * env, jobject obj, jlong _session, jstring _filename,
+        jobject _decodeOptions, jlong _layout, jobject _resultBuffer) {
+
+    if ((_session == 0) || (_filename == 0) || (_decodeOptions == 0) || (_layout == 0)
+            || (_resultBuffer == 0)) {
+        return -1;
+    }
+
+    dmscanlib::DecodeSession * session = reinterpret_cast<dmscanlib::DecodeSession *>(_session);
+    dmscanlib::jni::WellLayout * layout = reinterpret_cast<dmscanlib::jni::WellLayout *>(_layout);
+
+    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
+            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
+    if (decodeOptions.get() == NULL) {
+        return -1;
+    }
+
+    const char *filename = env->GetStringUTFChars(_filename, 0);
+    int result = session->decodeImageWells(filename, *decodeOptions, layout->wellRects);
+    env->ReleaseStringUTFChars(_filename, filename);
+
+    return dmscanlib::jni::packDecodeResult(env, *session, result, _resultBuffer);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    sessionDecodeEncodedImage
+ * Signature: (JLjava/nio/ByteBuffer;ILedu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ *
+ * Decodes an image file (BMP, PNG, JPEG, ...) held in the first length bytes of a
+ * direct byte buffer, the results are written to the second one as for
+ * sessionDecodeImageToBuffer().
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodeEncodedImage(
+        JNIEnv * env, jobject obj, jlong _session, jobject _imageBuffer, jint length,
+        jobject _decodeOptions, jlong _layout, jobject _resultBuffer) {
+
+    if ((_session == 0) || (_imageBuffer == 0) || (length <= 0) || (_decodeOptions == 0)
+            || (_layout == 0) || (_resultBuffer == 0)) {
+        return -1;
+    }
+
+    unsigned capacity;
+    const unsigned char * image = dmscanlib::jni::getDirectBuffer(env, _imageBuffer, capacity);
+    if ((image == NULL) || (static_cast<unsigned>(length) > capacity)) {
+        return -1;
+    }
+
+    dmscanlib::DecodeSession * session = reinterpret_cast<dmscanlib::DecodeSession *>(_session);
+    dmscanlib::jni::WellLayout * layout = reinterpret_cast<dmscanlib::jni::WellLayout *>(_layout);
+
+    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
+            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
+    if (decodeOptions.get() == NULL) {
+        return -1;
+    }
+
+    int result = session->decodeImageWells(image, static_cast<unsigned>(length),
+            *decodeOptions, layout->wellRects);
+    return dmscanlib::jni::packDecodeResult(env, *session, result, _resultBuffer);
+}
+
+/*
+ * Class:     edu_ualberta_med_scannerconfig_dmscanlib_ScanLib
+ * Method:    sessionDecodePixels
+ * Signature: (JLjava/nio/ByteBuffer;IIIILedu/ualberta/med/scannerconfig/dmscanlib/DecodeOptions;JLjava/nio/ByteBuffer;)I
+ *
+ * Decodes the raw pixels held in a direct byte buffer, in place. The format is one
+ * of the dmscanlib::PixelFormat values. The results are written to the second
+ * buffer as for sessionDecodeImageToBuffer().
+ */
+JNIEXPORT jint JNICALL Java_edu_ualberta_med_scannerconfig_dmscanlib_ScanLib_sessionDecodePixels(
+        JNIEnv * env, jobject obj, jlong _session, jobject _imageBuffer, jint width,
+        jint height, jint stride, jint format, jobject _decodeOptions, jlong _layout,
+        jobject _resultBuffer) {
+
+    if ((_session == 0) || (_imageBuffer == 0) || (width <= 0) || (height <= 0)
+            || (stride <= 0) || (format < 0) || (format >= dmscanlib::PIXEL_FORMAT_MAX)
+            || (_decodeOptions == 0) || (_layout == 0) || (_resultBuffer == 0)) {
+        return -1;
+    }
+
+    unsigned capacity;
+    const unsigned char * pixels = dmscanlib::jni::getDirectBuffer(env, _imageBuffer, capacity);
+    if ((pixels == NULL)
+            || (static_cast<double>(stride) * height > static_cast<double>(capacity))) {
+        return -1;
+    }
+
+    dmscanlib::DecodeSession * session = reinterpret_cast<dmscanlib::DecodeSession *>(_session);
+    dmscanlib::jni::WellLayout * layout = reinterpret_cast<dmscanlib::jni::WellLayout *>(_layout);
+
+    std::unique_ptr<dmscanlib::DecodeOptions> decodeOptions =
+            dmscanlib::DecodeOptions::getDecodeOptionsViaJni(env, _decodeOptions);
+    if (decodeOptions.get() == NULL) {
+        return -1;
+    }
+
+    int result = session->decodeImageWells(
+            pixels,
+            static_cast<unsigned>(width),
+            static_cast<unsigned>(height),
+            static_cast<unsigned>(stride),
+            static_cast<dmscanlib::PixelFormat>(format),
+            *decodeOptions,
+            layout->wellRects);
+    return dmscanlib::jni::packDecodeResult(env, *session, result, _resultBuffer);
+}
@@ -21,9 +21,47 @@
 namespace dmscanlib {
 
 class WellDecoder;
+class DecodeSession;
 
 namespace jni {
 
+/*
+ * Global class references and method IDs used to build the result objects
+ * returned to Java. They are resolved once, in JNI_OnLoad, instead of on every
+ * call.
+ */
+class JniCache {
+public:
+    static bool load(JNIEnv * env);
+
+    static void unload(JNIEnv * env);
+
+    static const JniCache & getInstance() {
+        return instance;
+    }
+
+    jclass scanLibResultClass;
+    jmethodID scanLibResultCons;
+
+    jclass decodeResultClass;
+    jmethodID decodeResultCons;
+    jmethodID decodeResultAddWell;
+
+private:
+    JniCache();
+
+    static JniCache instance;
+};
+
+/*
+ * Well rectangles converted once from Java and reused by every decode that is
+ * given the layout's handle.
+ */
+class WellLayout {
+public:
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+};
+
 void getResultCodeMsg(int resultCode, std::string & message);
 
 jobject createScanResultObject(JNIEnv * env, int resultCode, int value);
@@ -35,9 +73,25 @@ jobject createDecodeResultObject(JNIEnv * env, int resultCode,
 
 std::unique_ptr<const cv::Rect> getBoundingBox(JNIEnv *env, jobject bboxJavaObj);
 
+std::unique_ptr<const WellRectangle> createWellRectangle(const char * label,
+        const double * corners);
+
 int getWellRectangles(JNIEnv *env, jsize numWells, jobjectArray _wellRects,
         std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
 
+int getWellRectangles(JNIEnv *env, jdoubleArray _corners, jobjectArray _labels,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+unsigned char * getDirectBuffer(JNIEnv * env, jobject _buffer, unsigned & capacity);
+
+/*
+ * Writes the results of the session's last decode to a direct byte buffer, see
+ * PackedDecodeResult. Returns the length of the record, or -1 if the buffer is
+ * not a direct one.
+ */
+jint packDecodeResult(JNIEnv * env, const DecodeSession & session, int result,
+        jobject _resultBuffer);
+
 } /* namespace */
 
 } /* namespace */
@@ -112,6 +112,9 @@ ImageInfo::ImageInfo(const std::string & fname) :
             if (root.lookupValue(label, decodedMessage)) {
                 barcodePosition = DmScanLib::getBarcodePositionFromString(barcodePositionStr);
                 wells.insert(std::make_pair(label, decodedMessage));
+                if (!decodedMessage.empty()) {
+                    ++decodedWellCount;
+                }
             } else {
                 std::cerr << "setting not found in configuration file: " << label << std::endl;
                 fileValid = false;
@@ -154,6 +157,37 @@ const std::string * ImageInfo::getBarcodeMsg(const std::string & label) {
     return &wells[label];
 }
 
+ImageInfoWriter::ImageInfoWriter(
+        const std::string & _imageFilename,
+        const cv::Rect & _boundingBox,
+        Orientation _orientation,
+        BarcodePosition _barcodePosition,
+        unsigned _palletRows,
+        unsigned _palletCols) :
+        ImageInfo()
+{
+    filename.assign("");
+    imageFilename.assign(_imageFilename);
+    fileValid = true;
+    imageFileValid = true;
+    boundingBox = std::unique_ptr<const cv::Rect>(new cv::Rect(_boundingBox));
+    orientation = _orientation;
+    barcodePosition = _barcodePosition;
+    palletSize = PSIZE_MAX;
+    palletRows = _palletRows;
+    palletCols = _palletCols;
+    decodedWellCount = 0;
+}
+
+void ImageInfoWriter::setBarcodeMsg(
+        const std::string & label,
+        const std::string & decodedMessage) {
+    wells.insert(std::make_pair(label, decodedMessage));
+    if (!decodedMessage.empty()) {
+        ++decodedWellCount;
+    }
+}
+
 std::ostream & operator<<(std::ostream &os, const ImageInfo & m) {
     os << "imageFilename=\"" << m.imageFilename << "\"" << std::endl;
 
@@ -83,6 +83,23 @@ protected:
     friend std::ostream & operator<<(std::ostream & os, const ImageInfo & m);
 };
 
+/*
+ * Builds the information for an image in memory, one well at a time, so that it
+ * can be written out in the format read by ImageInfo.
+ */
+class ImageInfoWriter : public ImageInfo {
+public:
+    ImageInfoWriter(
+            const std::string & imageFilename,
+            const cv::Rect & boundingBox,
+            Orientation orientation,
+            BarcodePosition barcodePosition,
+            unsigned palletRows,
+            unsigned palletCols);
+
+    void setBarcodeMsg(const std::string & label, const std::string & decodedMessage);
+};
+
 } /* namespace test */
 } /* namespace dmscanlib */
 
@@ -12,6 +12,7 @@
 #include "Image.h"
 #include "decoder/WellRectangle.h"
 #include "decoder/DecodeOptions.h"
+#include "decoder/DecodePlan.h"
 
 #include <sstream>
 
@@ -118,48 +119,7 @@ void getWellRectsForBoundingBox(
         Orientation orientation,
         BarcodePosition position,
         std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
-
-    float wellWidth = bbox.width / static_cast<float>(cols);
-    float wellHeight = bbox.height / static_cast<float>(rows);
-
-    cv::Point2f horTranslation(static_cast<float>(wellWidth), 0);
-    cv::Point2f verTranslation(0, static_cast<float>(wellHeight));
-
-    // round off the cell size so image dimensions are not exceeded
-    cv::Size cellSize(
-		static_cast<unsigned>(0.999f * wellWidth), 
-		static_cast<unsigned>(0.999f * wellHeight));
-
-    float horOffset;
-    float verOffset = static_cast<float>(bbox.y);
-
-    for (unsigned row = 0; row < rows; ++row) {
-        horOffset = static_cast<float>(bbox.x);
-
-        for (unsigned col = 0; col < cols; ++col) {
-            std::string label;
-            DmScanLib::getLabelForPosition(row, col, rows, cols, orientation, position, label);
-
-            std::unique_ptr<WellRectangle> wellRect(
-                    new WellRectangle(
-                            label.c_str(),
-                            static_cast<unsigned>(horOffset),
-                            static_cast<unsigned>(verOffset),
-                            cellSize.width,
-                            cellSize.height));
-            const cv::Rect & wRect = wellRect->getRectangle();
-            if (!bbox.contains(wRect.tl()) || !bbox.contains(wRect.br())) {
-                throw std::logic_error("well rectangle outside image: " + label);
-            }
-
-            VLOG(5) << "getWellRectsForBoundingBox: " << *wellRect;
-            wellRects.push_back(std::move(wellRect));
-
-
-            horOffset += wellWidth;
-        }
-        verOffset += wellHeight;
-    }
+    DecodePlan::getWellRectsForBoundingBox(bbox, rows, cols, orientation, position, wellRects);
 }
 
 std::unique_ptr<DecodeOptions> getDefaultDecodeOptions() {
@@ -0,0 +1,276 @@
+/*
+ * TestDaemonProtocol.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "tools/DaemonProtocol.h"
+
+#include <dmtx.h>
+
+#include <stdexcept>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib;
+using namespace dmscanlib::dmscand;
+
+DecodeRequest createRequest(uint32_t type) {
+    DecodeRequest request;
+    request.type = type;
+    request.requestId = 42;
+    request.imagePath = "/tmp/pallet.png";
+    request.imageBytes.assign(300, 0x7f);
+    request.slotHandle.slot = 3;
+    request.slotHandle.generation = 17;
+    request.minEdgeFactor = 0.15;
+    request.maxEdgeFactor = 0.3;
+    request.speculativeDecode = 1;
+
+    ProfileSettings profile;
+    profile.scale = 2;
+    profile.scanGapFactor = 0.1;
+    profile.squareDev = 15;
+    profile.edgeThresh = 5;
+    profile.corrections = 10;
+    profile.subPixel = 1;
+    profile.symbolSize = DmtxSymbol12x12;
+    request.profiles.push_back(profile);
+    profile.scale = 1;
+    profile.subPixel = 0;
+    request.profiles.push_back(profile);
+
+    const char * labels[] = { "A1", "A2" };
+    for (unsigned i = 0; i < 2; ++i) {
+        request.labels.push_back(labels[i]);
+        for (unsigned c = 0; c < 8; ++c) {
+            request.corners.push_back(10.5f * i + c);
+        }
+    }
+    return request;
+}
+
+void expectSameRequest(const DecodeRequest & expected, const DecodeRequest & actual) {
+    EXPECT_EQ(expected.type, actual.type);
+    EXPECT_EQ(expected.requestId, actual.requestId);
+    EXPECT_EQ(expected.minEdgeFactor, actual.minEdgeFactor);
+    EXPECT_EQ(expected.maxEdgeFactor, actual.maxEdgeFactor);
+    EXPECT_EQ(expected.speculativeDecode, actual.speculativeDecode);
+    ASSERT_EQ(expected.profiles.size(), actual.profiles.size());
+    for (unsigned i = 0, n = expected.profiles.size(); i < n; ++i) {
+        const ProfileSettings & profile = actual.profiles[i];
+        EXPECT_EQ(expected.profiles[i].scale, profile.scale);
+        EXPECT_EQ(expected.profiles[i].scanGapFactor, profile.scanGapFactor);
+        EXPECT_EQ(expected.profiles[i].squareDev, profile.squareDev);
+        EXPECT_EQ(expected.profiles[i].edgeThresh, profile.edgeThresh);
+        EXPECT_EQ(expected.profiles[i].corrections, profile.corrections);
+        EXPECT_EQ(expected.profiles[i].subPixel, profile.subPixel);
+        EXPECT_EQ(expected.profiles[i].symbolSize, profile.symbolSize);
+    }
+    EXPECT_TRUE(expected.labels == actual.labels);
+    EXPECT_TRUE(expected.corners == actual.corners);
+}
+
+TEST(TestDaemonProtocol, requestRoundTrip) {
+    const uint32_t types[] = { MSG_DECODE_FILE, MSG_DECODE_BYTES, MSG_DECODE_SLOT };
+    for (unsigned t = 0; t < 3; ++t) {
+        const DecodeRequest request = createRequest(types[t]);
+        MessageWriter writer;
+        writeRequest(request, writer);
+
+        DecodeRequest read;
+        MessageReader reader(writer.getPayload());
+        readRequest(types[t], reader, read);
+
+        expectSameRequest(request, read);
+        if (types[t] == MSG_DECODE_FILE) {
+            EXPECT_EQ(request.imagePath, read.imagePath);
+            EXPECT_TRUE(read.imageBytes.empty());
+        } else if (types[t] == MSG_DECODE_SLOT) {
+            EXPECT_EQ(request.slotHandle.slot, read.slotHandle.slot);
+            EXPECT_EQ(request.slotHandle.generation, read.slotHandle.generation);
+        } else {
+            EXPECT_TRUE(request.imageBytes == read.imageBytes);
+            EXPECT_TRUE(read.imagePath.empty());
+        }
+    }
+}
+
+TEST(TestDaemonProtocol, responseRoundTrip) {
+    WellResponse well;
+    well.requestId = 7;
+    well.wellIndex = 95;
+    well.decoded = 1;
+    well.tier = 2;
+    well.symbolSize = DmtxSymbol14x14;
+    well.decodeNanos = 123456789012LL;
+    for (unsigned c = 0; c < 8; ++c) {
+        well.quad[c] = -4 + static_cast<int32_t>(c);
+    }
+    well.label = "H12";
+    well.message = "0123456789";
+
+    MessageWriter wellWriter;
+    writeWellResponse(well, wellWriter);
+    MessageReader wellReader(wellWriter.getPayload());
+    WellResponse readWell;
+    readWellResponse(wellReader, readWell);
+    EXPECT_EQ(well.requestId, readWell.requestId);
+    EXPECT_EQ(well.wellIndex, readWell.wellIndex);
+    EXPECT_EQ(well.decoded, readWell.decoded);
+    EXPECT_EQ(well.tier, readWell.tier);
+    EXPECT_EQ(well.symbolSize, readWell.symbolSize);
+    EXPECT_EQ(well.decodeNanos, readWell.decodeNanos);
+    EXPECT_EQ(0, memcmp(well.quad, readWell.quad, sizeof(well.quad)));
+    EXPECT_EQ(well.label, readWell.label);
+    EXPECT_EQ(well.message, readWell.message);
+
+    DoneResponse done;
+    done.requestId = 7;
+    done.result = -1;
+    done.decodedWells = 94;
+    done.totalNanos = 987654321LL;
+
+    MessageWriter doneWriter;
+    writeDoneResponse(done, doneWriter);
+    MessageReader doneReader(doneWriter.getPayload());
+    DoneResponse readDone;
+    readDoneResponse(doneReader, readDone);
+    EXPECT_EQ(done.requestId, readDone.requestId);
+    EXPECT_EQ(done.result, readDone.result);
+    EXPECT_EQ(done.decodedWells, readDone.decodedWells);
+    EXPECT_EQ(done.totalNanos, readDone.totalNanos);
+
+    ErrorResponse error;
+    error.requestId = 8;
+    error.message = "image slot is not published";
+
+    MessageWriter errorWriter;
+    writeErrorResponse(error, errorWriter);
+    MessageReader errorReader(errorWriter.getPayload());
+    ErrorResponse readError;
+    readErrorResponse(errorReader, readError);
+    EXPECT_EQ(error.requestId, readError.requestId);
+    EXPECT_EQ(error.message, readError.message);
+}
+
+/*
+ * Every prefix of a request is rejected rather than read past its end.
+ */
+TEST(TestDaemonProtocol, truncatedRequest) {
+    const uint32_t types[] = { MSG_DECODE_FILE, MSG_DECODE_BYTES, MSG_DECODE_SLOT };
+    for (unsigned t = 0; t < 3; ++t) {
+        MessageWriter writer;
+        writeRequest(createRequest(types[t]), writer);
+        const std::vector<unsigned char> & payload = writer.getPayload();
+
+        for (unsigned length = 0; length < payload.size(); ++length) {
+            const std::vector<unsigned char> truncated(payload.begin(), payload.begin() + length);
+            MessageReader reader(truncated);
+            DecodeRequest request;
+            EXPECT_THROW(readRequest(types[t], reader, request), std::runtime_error);
+        }
+    }
+}
+
+/*
+ * A string or byte array longer than what is left of the payload.
+ */
+TEST(TestDaemonProtocol, oversizedLength) {
+    MessageWriter writer;
+    writer.putUint(1);
+    writer.putUint(0xffffffff);
+    writer.putUint(0);
+
+    DecodeRequest request;
+    MessageReader fileReader(writer.getPayload());
+    EXPECT_THROW(readRequest(MSG_DECODE_FILE, fileReader, request), std::runtime_error);
+    MessageReader bytesReader(writer.getPayload());
+    EXPECT_THROW(readRequest(MSG_DECODE_BYTES, bytesReader, request), std::runtime_error);
+}
+
+class SocketPair {
+public:
+    SocketPair() {
+        fds[0] = fds[1] = -1;
+        EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    }
+
+    ~SocketPair() {
+        closeWriter();
+        close(fds[0]);
+    }
+
+    void closeWriter() {
+        if (fds[1] >= 0) {
+            close(fds[1]);
+            fds[1] = -1;
+        }
+    }
+
+    bool writeRaw(const void * bytes, size_t length) {
+        return send(fds[1], bytes, length, 0) == static_cast<ssize_t>(length);
+    }
+
+    int fds[2];
+};
+
+TEST(TestDaemonProtocol, frameRoundTrip) {
+    SocketPair sockets;
+
+    MessageWriter writer;
+    writeRequest(createRequest(MSG_DECODE_BYTES), writer);
+    ASSERT_TRUE(writeFrame(sockets.fds[1], MSG_DECODE_BYTES, writer.getPayload()));
+    ASSERT_TRUE(writeFrame(sockets.fds[1], MSG_DECODE_DONE, std::vector<unsigned char>()));
+
+    uint32_t type = 0;
+    std::vector<unsigned char> payload;
+    ASSERT_TRUE(readFrame(sockets.fds[0], type, payload));
+    EXPECT_EQ(static_cast<uint32_t>(MSG_DECODE_BYTES), type);
+    EXPECT_TRUE(writer.getPayload() == payload);
+
+    ASSERT_TRUE(readFrame(sockets.fds[0], type, payload));
+    EXPECT_EQ(static_cast<uint32_t>(MSG_DECODE_DONE), type);
+    EXPECT_TRUE(payload.empty());
+
+    sockets.closeWriter();
+    EXPECT_FALSE(readFrame(sockets.fds[0], type, payload));
+}
+
+TEST(TestDaemonProtocol, truncatedFrame) {
+    uint32_t type;
+    std::vector<unsigned char> payload;
+
+    // the peer goes in the middle of the header
+    SocketPair header;
+    const uint32_t length = 100;
+    ASSERT_TRUE(header.writeRaw(&length, sizeof(length)));
+    header.closeWriter();
+    EXPECT_FALSE(readFrame(header.fds[0], type, payload));
+
+    // the peer goes in the middle of the payload
+    SocketPair body;
+    const uint32_t frame[] = { length, MSG_DECODE_FILE, 0, 0 };
+    ASSERT_TRUE(body.writeRaw(frame, sizeof(frame)));
+    body.closeWriter();
+    EXPECT_FALSE(readFrame(body.fds[0], type, payload));
+}
+
+TEST(TestDaemonProtocol, oversizedFrame) {
+    SocketPair sockets;
+    const uint32_t frame[] = { MAX_FRAME_LENGTH + 1, MSG_DECODE_BYTES };
+    ASSERT_TRUE(sockets.writeRaw(frame, sizeof(frame)));
+
+    uint32_t type;
+    std::vector<unsigned char> payload;
+    EXPECT_FALSE(readFrame(sockets.fds[0], type, payload));
+    EXPECT_TRUE(payload.empty());
+}
+
+} /* namespace */
@@ -0,0 +1,76 @@
+/*
+ * TestDecodeOptions.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+
+#include <stdexcept>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib;
+
+TEST(TestDecodeOptions, defaultLadder) {
+    DecodeOptions decodeOptions(0.2, 0.3, 0.1, 15, 5, 10, 1);
+
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    ASSERT_EQ(2, profiles.size());
+    EXPECT_EQ(1, profiles[0]->scale);
+    EXPECT_EQ(2, profiles[1]->scale);
+
+    for (unsigned i = 0; i < profiles.size(); ++i) {
+        EXPECT_EQ(0.1, profiles[i]->scanGapFactor);
+        EXPECT_EQ(15, profiles[i]->squareDev);
+        EXPECT_EQ(5, profiles[i]->edgeThresh);
+        EXPECT_EQ(10, profiles[i]->corrections);
+    }
+}
+
+TEST(TestDecodeOptions, customLadder) {
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(2, 0.1, 15, 10, 10)));
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(1, 0.1, 15, 5, 10)));
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(1, 0.05, 30, 3, 20)));
+
+    DecodeOptions decodeOptions(0.2, 0.3, profiles);
+
+    EXPECT_TRUE(profiles.empty());
+    ASSERT_EQ(3, decodeOptions.getProfiles().size());
+    EXPECT_EQ(2, decodeOptions.shrink);
+    EXPECT_EQ(10, decodeOptions.edgeThresh);
+    EXPECT_EQ(3, decodeOptions.getProfiles()[2]->edgeThresh);
+}
+
+TEST(TestDecodeOptions, speculativeDecode) {
+    DecodeOptions decodeOptions(0.2, 0.3, 0.1, 15, 5, 10, 1);
+    EXPECT_FALSE(decodeOptions.getSpeculativeDecode());
+
+    decodeOptions.setSpeculativeDecode(true);
+    EXPECT_TRUE(decodeOptions.getSpeculativeDecode());
+}
+
+TEST(TestDecodeOptions, emptyLadder) {
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    ASSERT_THROW(DecodeOptions(0.2, 0.3, profiles), std::invalid_argument);
+}
+
+TEST(TestDecodeOptions, subPixelProfile) {
+    DecodeProfile defaultProfile(1, 0.1, 15, 5, 10);
+    EXPECT_FALSE(defaultProfile.subPixel);
+
+    DecodeProfile lowDpiProfile(1, 0.1, 15, 5, 10, true);
+    EXPECT_TRUE(lowDpiProfile.subPixel);
+}
+
+TEST(TestDecodeOptions, invalidScale) {
+    ASSERT_THROW(DecodeProfile(0, 0.1, 15, 5, 10), std::invalid_argument);
+}
+
+} /* namespace */
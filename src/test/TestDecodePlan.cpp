@@ -0,0 +1,134 @@
+/*
+ * TestDecodePlan.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "decoder/DecodePlan.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "test/TestCommon.h"
+
+#include <dmtx.h>
+#include <string.h>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib;
+
+TEST(TestDecodePlan, palletWells) {
+    std::unique_ptr<DecodeOptions> options = test::getDefaultDecodeOptions();
+    DecodePlan plan(*options, cv::Rect(0, 0, 1200, 800), 8, 12, LANDSCAPE, TUBE_BOTTOMS);
+
+    const std::vector<std::unique_ptr<const WellRectangle> > & wellRects = plan.getWellRects();
+    ASSERT_EQ(96u, wellRects.size());
+    EXPECT_EQ(1u, plan.getWellSizeCount());
+
+    std::string label;
+    DmScanLib::getLabelForPosition(0, 0, 8, 12, LANDSCAPE, TUBE_BOTTOMS, label);
+    EXPECT_EQ(label, wellRects[0]->getLabel());
+    DmScanLib::getLabelForPosition(7, 11, 8, 12, LANDSCAPE, TUBE_BOTTOMS, label);
+    EXPECT_EQ(label, wellRects[95]->getLabel());
+
+    // the plan has its own copy of the options
+    EXPECT_TRUE(&plan.getDecodeOptions() != options.get());
+    EXPECT_EQ(options->getProfiles().size(), plan.getDecodeOptions().getProfiles().size());
+}
+
+TEST(TestDecodePlan, wellSizes) {
+    std::unique_ptr<DecodeOptions> options = test::getDefaultDecodeOptions();
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    wellRects.push_back(std::unique_ptr<const WellRectangle>(
+            new WellRectangle("A1", 0, 0, 100, 100)));
+    wellRects.push_back(std::unique_ptr<const WellRectangle>(
+            new WellRectangle("A2", 100, 0, 100, 100)));
+    wellRects.push_back(std::unique_ptr<const WellRectangle>(
+            new WellRectangle("A3", 200, 0, 80, 120)));
+
+    DecodePlan plan(*options, wellRects);
+    wellRects.clear();
+
+    ASSERT_EQ(3u, plan.getWellRects().size());
+    EXPECT_EQ("A3", plan.getWellRects()[2]->getLabel());
+    EXPECT_EQ(2u, plan.getWellSizeCount());
+
+    // wells of the same size share their settings
+    EXPECT_TRUE(&plan.getSettings(0, 0) == &plan.getSettings(1, 0));
+    EXPECT_TRUE(&plan.getSettings(0, 0) != &plan.getSettings(2, 0));
+
+    const DmtxDecodeSettings & settings = plan.getSettings(2, 0);
+    EXPECT_EQ(static_cast<int>(options->minEdgeFactor * 80), settings.edgeMin);
+    EXPECT_EQ(static_cast<int>(options->maxEdgeFactor * 80), settings.edgeMax);
+    EXPECT_EQ(static_cast<int>(options->getProfiles()[0]->scanGapFactor * 80),
+            settings.scanGap);
+    EXPECT_EQ(options->getProfiles()[0]->edgeThresh, settings.edgeThresh);
+}
+
+/*
+ * Values libdmtx refuses keep its defaults, as when they were set as properties.
+ */
+TEST(TestDecodePlan, invalidSettingsKeepDefaults) {
+    DecodeOptions options(0.2, 0.3, 0.0, 0, 0, 10, 1);
+    DecodePlan plan(options, cv::Rect(0, 0, 1000, 660), 8, 12, LANDSCAPE, TUBE_TOPS);
+
+    const cv::Rect & rect = plan.getWellRects()[0]->getRectangle();
+    std::vector<unsigned char> pixels(rect.width * rect.height, 255);
+    DmtxImage * dmtxImage = dmtxImageCreate(
+            &pixels[0], rect.width, rect.height, DmtxPack8bppK);
+    ASSERT_TRUE(dmtxImage != NULL);
+    DmtxDecode * dec = dmtxDecodeCreate(dmtxImage, 1);
+
+    const DmtxDecodeSettings & settings = plan.getSettings(0, 0);
+    EXPECT_EQ(dec->scanGap, settings.scanGap);
+    EXPECT_EQ(dec->squareDevn, settings.squareDevn);
+    EXPECT_EQ(dec->edgeThresh, settings.edgeThresh);
+    EXPECT_EQ(0, memcmp(&dec->grid, &plan.getScanGrid(0, 0), sizeof(dec->grid)));
+
+    dmtxDecodeDestroy(&dec);
+    dmtxImageDestroy(&dmtxImage);
+}
+
+/*
+ * The precomputed scan grid must be the one libdmtx builds when the properties
+ * are set one at a time.
+ */
+TEST(TestDecodePlan, scanGridMatchesLibdmtx) {
+    std::unique_ptr<DecodeOptions> options = test::getDefaultDecodeOptions();
+    DecodePlan plan(*options, cv::Rect(0, 0, 1000, 660), 8, 12, LANDSCAPE, TUBE_TOPS);
+
+    const cv::Rect & rect = plan.getWellRects()[0]->getRectangle();
+    std::vector<unsigned char> pixels(rect.width * rect.height, 255);
+    DmtxImage * dmtxImage = dmtxImageCreate(
+            &pixels[0], rect.width, rect.height, DmtxPack8bppK);
+    ASSERT_TRUE(dmtxImage != NULL);
+
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            plan.getDecodeOptions().getProfiles();
+    for (unsigned tier = 0, n = profiles.size(); tier < n; ++tier) {
+        const DmtxDecodeSettings & settings = plan.getSettings(0, tier);
+
+        DmtxDecode * dec = dmtxDecodeCreate(dmtxImage, profiles[tier]->scale);
+        dmtxDecodeSetProp(dec, DmtxPropEdgeMin, settings.edgeMin);
+        dmtxDecodeSetProp(dec, DmtxPropEdgeMax, settings.edgeMax);
+        dmtxDecodeSetProp(dec, DmtxPropScanGap, settings.scanGap);
+
+        const DmtxScanGrid & grid = plan.getScanGrid(0, tier);
+        EXPECT_EQ(0, memcmp(&dec->grid, &grid, sizeof(grid)));
+
+        DmtxDecode * planDec = dmtxDecodeCreateWithSettings(
+                dmtxImage, profiles[tier]->scale, &settings, &grid);
+        EXPECT_EQ(0, memcmp(&dec->grid, &planDec->grid, sizeof(grid)));
+        EXPECT_EQ(settings.scanGap, dmtxDecodeGetProp(planDec, DmtxPropScanGap));
+
+        dmtxDecodeDestroy(&planDec);
+        dmtxDecodeDestroy(&dec);
+    }
+    dmtxImageDestroy(&dmtxImage);
+}
+
+} /* namespace */
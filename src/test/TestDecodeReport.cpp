@@ -0,0 +1,122 @@
+/*
+ * TestDecodeReport.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "decoder/DecodeReport.h"
+#include "utils/DmClock.h"
+#include "utils/DmTime.h"
+#include "utils/PerfCounters.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib;
+
+TEST(TestDecodeReport, clockIsMonotonic) {
+    util::dmUint64 prev = util::DmClock::nowNanos();
+    for (unsigned i = 0; i < 1000; ++i) {
+        util::dmUint64 now = util::DmClock::nowNanos();
+        EXPECT_LE(prev, now);
+        prev = now;
+    }
+}
+
+TEST(TestDecodeReport, difftimeIsNeverNegative) {
+    util::DmTime start;
+    util::DmTime end;
+    EXPECT_GE(end.difftime(start)->getTime(), 0.0);
+}
+
+TEST(TestDecodeReport, stagesAccumulate) {
+    DecodeReport report;
+    report.addStageTime(STAGE_REGION_SEARCH, 1500000);
+    report.addStageTime(STAGE_REGION_SEARCH, 500000);
+
+    EXPECT_EQ(2000000u, report.getStageNanos(STAGE_REGION_SEARCH));
+    EXPECT_EQ(2u, report.getStageCount(STAGE_REGION_SEARCH));
+    EXPECT_DOUBLE_EQ(2.0, report.getStageMillis(STAGE_REGION_SEARCH));
+    EXPECT_EQ(0u, report.getStageCount(STAGE_FILTER));
+}
+
+TEST(TestDecodeReport, scopedTimer) {
+    DecodeReport report;
+    {
+        StageTimer timer(report, STAGE_IMAGE_WRITE);
+    }
+    EXPECT_EQ(1u, report.getStageCount(STAGE_IMAGE_WRITE));
+}
+
+TEST(TestDecodeReport, printsEveryStage) {
+    DecodeReport report;
+    std::ostringstream os;
+    os << report;
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        const char * name = DecodeReport::getStageName(static_cast<DecodeStage>(i));
+        EXPECT_NE(std::string::npos, os.str().find(name));
+    }
+}
+
+TEST(TestDecodeReport, countersAccumulate) {
+    DecodeReport report;
+    EXPECT_FALSE(report.hasCounters());
+
+    util::PerfCounterValues counters;
+    counters.cycles = 1000;
+    counters.instructions = 2000;
+    counters.cacheMisses = 10;
+    counters.branchMisses = 5;
+    report.addStageCounters(STAGE_REGION_SEARCH, counters);
+    report.addStageCounters(STAGE_REGION_SEARCH, counters);
+    report.addWellCounters("A1", counters);
+
+    EXPECT_TRUE(report.hasCounters());
+    EXPECT_EQ(2000u, report.getStageCounters(STAGE_REGION_SEARCH).cycles);
+    EXPECT_EQ(20u, report.getStageCounters(STAGE_REGION_SEARCH).cacheMisses);
+    EXPECT_EQ(0u, report.getStageCounters(STAGE_FILTER).cycles);
+
+    util::PerfCounterValues wellCounters;
+    EXPECT_TRUE(report.getWellCounters("A1", wellCounters));
+    EXPECT_EQ(2000u, wellCounters.instructions);
+    EXPECT_FALSE(report.getWellCounters("B1", wellCounters));
+
+    std::ostringstream os;
+    os << report;
+    EXPECT_NE(std::string::npos, os.str().find("ipc/2.00"));
+}
+
+/*
+ * The counters may not be available where the tests run, in which case only the
+ * timings are reported.
+ */
+TEST(TestDecodeReport, scopedTimerCounters) {
+    util::PerfCounters::setEnabled(true);
+    DecodeReport report;
+    {
+        StageTimer timer(report, STAGE_FILTER);
+    }
+    util::PerfCounters::setEnabled(false);
+
+    EXPECT_EQ(1u, report.getStageCount(STAGE_FILTER));
+
+    util::PerfCounterValues counters;
+    if (util::PerfCounters::read(counters)) {
+        FAIL() << "counters read while turned off";
+    }
+    if (report.hasCounters()) {
+        EXPECT_GT(report.getStageCounters(STAGE_FILTER).cycles, 0u);
+    }
+}
+
+TEST(TestDecodeReport, invalidStage) {
+    DecodeReport report;
+    ASSERT_THROW(report.addStageTime(STAGE_MAX, 1), std::invalid_argument);
+}
+
+} /* namespace */
@@ -0,0 +1,172 @@
+/*
+ * TestDecodeSession.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DecodeSession.h"
+#include "Image.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeResult.h"
+#include "decoder/WellDecoder.h"
+#include "test/TestCommon.h"
+
+#include <dmtx.h>
+#include <OpenThreads/Thread>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+using namespace dmscanlib;
+
+namespace {
+
+class SessionDecodeThread : public OpenThreads::Thread {
+public:
+    SessionDecodeThread(
+            DecodeSession & _session,
+            const std::string & _filename,
+            const DecodeOptions & _decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & _wellRects) :
+            session(_session),
+            filename(_filename),
+            decodeOptions(_decodeOptions),
+            wellRects(_wellRects) {
+    }
+
+    void run() {
+        for (unsigned i = 0; i < 3; ++i) {
+            results.push_back(session.decode(filename.c_str(), decodeOptions, wellRects));
+        }
+    }
+
+    std::vector<std::unique_ptr<const DecodeResult> > results;
+
+private:
+    DecodeSession & session;
+    const std::string filename;
+    const DecodeOptions & decodeOptions;
+    std::vector<std::unique_ptr<const WellRectangle> > & wellRects;
+};
+
+TEST(TestDecodeSession, symbolSizePrior) {
+    DecodeSession session(0);
+    EXPECT_EQ(DmtxSymbolSquareAuto, session.getSymbolSizePrior());
+
+    for (unsigned i = 1; i < DecodeSession::PRIOR_MIN_WELLS; ++i) {
+        session.addSymbolSize(DmtxSymbol12x12);
+    }
+    EXPECT_EQ(DmtxSymbolSquareAuto, session.getSymbolSizePrior());
+
+    session.addSymbolSize(DmtxSymbol12x12);
+    EXPECT_EQ(DmtxSymbol12x12, session.getSymbolSizePrior());
+
+    // undecoded wells do not count
+    session.addSymbolSize(DmtxUndefined);
+    EXPECT_EQ(DmtxSymbol12x12, session.getSymbolSizePrior());
+
+    // a mix of sizes has no prior
+    for (unsigned i = 0; i < DecodeSession::PRIOR_MIN_WELLS; ++i) {
+        session.addSymbolSize(DmtxSymbol14x14);
+    }
+    EXPECT_EQ(DmtxSymbolSquareAuto, session.getSymbolSizePrior());
+
+    // the older counts are halved, so the prior follows a change of tubes
+    for (unsigned i = 0; i < 2 * DecodeSession::PRIOR_WINDOW; ++i) {
+        session.addSymbolSize(DmtxSymbol14x14);
+    }
+    EXPECT_EQ(DmtxSymbol14x14, session.getSymbolSizePrior());
+}
+
+TEST(TestDecodeSession, decodeWithPrior) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+    Image image(fname);
+    ASSERT_TRUE(image.isValid());
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    cv::Rect bbox(0, 0, image.size().width, image.size().height);
+    test::getWellRectsForBoundingBox(bbox, 8, 12, LANDSCAPE, TUBE_BOTTOMS, wellRects);
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+
+    DecodeSession session(0);
+    ASSERT_EQ(SC_SUCCESS, session.decodeImageWells(fname.c_str(), *decodeOptions, wellRects));
+
+    std::map<std::string, std::string> firstMessages;
+    const std::map<std::string, const WellDecoder *> & firstWells = session.getDecodedWells();
+    for (std::map<std::string, const WellDecoder *>::const_iterator ii = firstWells.begin();
+            ii != firstWells.end(); ++ii) {
+        EXPECT_GE(ii->second->getSymbolSize(), 0);
+        firstMessages[ii->second->getLabel()] = ii->first;
+    }
+
+    // the test image has a single tube type
+    EXPECT_NE(DmtxSymbolSquareAuto, session.getSymbolSizePrior());
+
+    ASSERT_EQ(SC_SUCCESS, session.decodeImageWells(fname.c_str(), *decodeOptions, wellRects));
+    EXPECT_EQ(2u, session.getPalletCount());
+
+    const std::map<std::string, const WellDecoder *> & secondWells = session.getDecodedWells();
+    EXPECT_EQ(firstMessages.size(), secondWells.size());
+    for (std::map<std::string, const WellDecoder *>::const_iterator ii = secondWells.begin();
+            ii != secondWells.end(); ++ii) {
+        EXPECT_EQ(firstMessages[ii->second->getLabel()], ii->first);
+    }
+}
+
+TEST(TestDecodeSession, concurrentDecodes) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+    Image image(fname);
+    ASSERT_TRUE(image.isValid());
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    cv::Rect bbox(0, 0, image.size().width, image.size().height);
+    test::getWellRectsForBoundingBox(bbox, 8, 12, LANDSCAPE, TUBE_BOTTOMS, wellRects);
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+
+    DecodeSession session(0);
+    std::unique_ptr<const DecodeResult> expected =
+            session.decode(fname.c_str(), *decodeOptions, wellRects);
+    ASSERT_EQ(SC_SUCCESS, expected->getResult());
+    EXPECT_EQ(wellRects.size(), expected->getWells().size());
+
+    SessionDecodeThread first(session, fname, *decodeOptions, wellRects);
+    SessionDecodeThread second(session, fname, *decodeOptions, wellRects);
+    first.start();
+    second.start();
+    first.join();
+    second.join();
+
+    EXPECT_EQ(7u, session.getPalletCount());
+
+    std::vector<const DecodeResult *> results;
+    for (unsigned i = 0; i < first.results.size(); ++i) {
+        results.push_back(first.results[i].get());
+        results.push_back(second.results[i].get());
+    }
+    ASSERT_EQ(6u, results.size());
+
+    // each result is its own, and they all agree
+    for (unsigned i = 0; i < results.size(); ++i) {
+        const DecodeResult & result = *results[i];
+        EXPECT_EQ(SC_SUCCESS, result.getResult());
+        EXPECT_GT(result.getTotalNanos(), 0u);
+        ASSERT_EQ(expected->getDecodedWellCount(), result.getDecodedWellCount());
+
+        const std::map<std::string, const WellResult *> & decodedWells =
+                result.getDecodedWells();
+        for (std::map<std::string, const WellResult *>::const_iterator ii =
+                decodedWells.begin(); ii != decodedWells.end(); ++ii) {
+            std::map<std::string, const WellResult *>::const_iterator jj =
+                    expected->getDecodedWells().find(ii->first);
+            ASSERT_TRUE(jj != expected->getDecodedWells().end());
+            EXPECT_EQ(jj->second->label, ii->second->label);
+        }
+    }
+}
+
+} /* namespace */
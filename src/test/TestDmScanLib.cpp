@@ -10,16 +10,23 @@
 #include "DmScanLib.h"
 #include "Image.h"
 #include "decoder/Decoder.h"
+#include "decoder/DecodeCapture.h"
 #include "decoder/DecodeOptions.h"
+#include "decoder/DecodePlan.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/DecodeReport.h"
 #include "decoder/WellDecoder.h"
 #include "test/TestCommon.h"
 #include "test/ImageInfo.h"
+#include "tools/CaptureReplay.h"
 #include "decoder/DmtxDecodeHelper.h"
+#include "decoder/ThreadMgr.h"
 
 #include <dmtx.h>
 
 #include <algorithm>
 #include <opencv/cv.h>
+#include <opencv/highgui.h>
 
 #include <stdexcept>
 #include <stddef.h>
@@ -27,6 +34,7 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <iterator>
 
 #define GLOG_NO_ABBREVIATED_SEVERITIES
 #include <glog/logging.h>
@@ -78,6 +86,299 @@ TEST(TestDmScanLib, decodeImage) {
 	}
 }
 
+TEST(TestDmScanLib, decodeThreadCount) {
+    FLAGS_v = 0;
+
+    EXPECT_THROW(DmScanLib::setDecodeThreadCount(0), std::invalid_argument);
+
+    DmScanLib::setDecodeThreadCount(1);
+    DmScanLib dmScanLib(1);
+    int result = test::decodeImage("testImages/8x12/96tubes.bmp", dmScanLib, 8, 12);
+    DmScanLib::setDecodeThreadCount(decoder::ThreadMgr::DEFAULT_THREAD_NUM);
+
+    EXPECT_EQ(SC_SUCCESS, result);
+    EXPECT_TRUE(dmScanLib.getDecodedWellCount() > 0);
+}
+
+TEST(TestDmScanLib, decodeImageSearchEffort) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+    std::string heatmapFname("heatmap.png");
+    remove(heatmapFname.c_str());
+
+    DmScanLib::setHeatmapFilename(heatmapFname);
+    DmScanLib dmScanLib(1);
+    int result = test::decodeImage(fname, dmScanLib, 8, 12);
+    DmScanLib::setHeatmapFilename("");
+
+    EXPECT_EQ(SC_SUCCESS, result);
+
+    const std::map<std::string, const WellDecoder *> & decodedWells = dmScanLib.getDecodedWells();
+    for (std::map<std::string, const WellDecoder *>::const_iterator ii = decodedWells.begin();
+            ii != decodedWells.end(); ++ii) {
+        const DmtxDecodeStats stats = ii->second->getDecodeStats();
+        EXPECT_GT(stats.gridLocations, 0) << "label: " << ii->first;
+        EXPECT_GE(stats.gridLocations, stats.seekEdgeCalls) << "label: " << ii->first;
+        EXPECT_GT(stats.pixelsSampled, 0) << "label: " << ii->first;
+    }
+
+    std::ifstream heatmapFile(heatmapFname.c_str());
+    EXPECT_TRUE(heatmapFile.good());
+}
+
+TEST(TestDmScanLib, decodeInMemoryImages) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+
+    DmScanLib fileDmScanLib(1);
+    ASSERT_EQ(SC_SUCCESS, test::decodeImage(fname, fileDmScanLib, 8, 12));
+    const unsigned decodedWellCount = fileDmScanLib.getDecodedWellCount();
+
+    std::ifstream file(fname.c_str(), std::ios::binary);
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    ASSERT_FALSE(encoded.empty());
+
+    cv::Mat bgr = cv::imread(fname);
+    ASSERT_TRUE(bgr.data != NULL);
+    cv::Mat rgba;
+    cv::cvtColor(bgr, rgba, CV_BGR2RGBA);
+    const cv::Mat rgbaOriginal = rgba.clone();
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    test::getWellRectsForBoundingBox(cv::Rect(0, 0, bgr.cols, bgr.rows), 8, 12,
+            LANDSCAPE, TUBE_BOTTOMS, wellRects);
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+
+    DmScanLib encodedDmScanLib(1);
+    EXPECT_EQ(SC_SUCCESS, encodedDmScanLib.decodeImageWells(
+            &encoded[0], encoded.size(), *decodeOptions, wellRects));
+    EXPECT_EQ(decodedWellCount, encodedDmScanLib.getDecodedWellCount());
+
+    DmScanLib pixelsDmScanLib(1);
+    EXPECT_EQ(SC_SUCCESS, pixelsDmScanLib.decodeImageWells(
+            rgba.data, rgba.cols, rgba.rows, rgba.step, PIXEL_RGBA32, *decodeOptions,
+            wellRects));
+    EXPECT_EQ(decodedWellCount, pixelsDmScanLib.getDecodedWellCount());
+
+    // the decoded image is drawn on a copy, not on the caller's pixels
+    cv::Mat difference;
+    cv::absdiff(rgba, rgbaOriginal, difference);
+    EXPECT_EQ(0, cv::countNonZero(difference.reshape(1)));
+
+    DmScanLib invalidDmScanLib(1);
+    EXPECT_EQ(SC_INVALID_IMAGE, invalidDmScanLib.decodeImageWells(
+            rgba.data, rgba.cols, rgba.rows, 3 * rgba.cols, PIXEL_RGBA32, *decodeOptions,
+            wellRects));
+    EXPECT_EQ(SC_INVALID_IMAGE, invalidDmScanLib.decodeImageWells(
+            &encoded[0], 16, *decodeOptions, wellRects));
+}
+
+TEST(TestDmScanLib, captureSampling) {
+    DecodeCapture::configure("", 1, 1, false);
+    EXPECT_FALSE(DecodeCapture::shouldCapture(5000000000ULL));
+
+    DecodeCapture::configure(".", 3, 0, false);
+    EXPECT_FALSE(DecodeCapture::shouldCapture(0));
+    EXPECT_FALSE(DecodeCapture::shouldCapture(0));
+    EXPECT_TRUE(DecodeCapture::shouldCapture(0));
+
+    DecodeCapture::configure(".", 0, 500, false);
+    EXPECT_FALSE(DecodeCapture::shouldCapture(499999999ULL));
+    EXPECT_TRUE(DecodeCapture::shouldCapture(500000000ULL));
+
+    DecodeCapture::configure("", 0, 0, false);
+}
+
+TEST(TestDmScanLib, decodeCapture) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+
+    DmScanLib::setCapture(".", 1, 0, true);
+    DmScanLib dmScanLib(1);
+    int result = test::decodeImage(fname, dmScanLib, 8, 12);
+    DmScanLib::setCapture("", 0, 0, false);
+
+    EXPECT_EQ(SC_SUCCESS, result);
+}
+
+/*
+ * The captured messages are those of the decode, and a replay of the capture
+ * reports a message that differs from it.
+ */
+TEST(TestDmScanLib, captureReplay) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+    Image image(fname);
+    ASSERT_TRUE(image.isValid());
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    cv::Rect bbox(0, 0, image.size().width, image.size().height);
+    test::getWellRectsForBoundingBox(bbox, 8, 12, LANDSCAPE, TUBE_BOTTOMS, wellRects);
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+
+    DmScanLib dmScanLib(1);
+    ASSERT_EQ(SC_SUCCESS, dmScanLib.decodeImageWells(fname.c_str(), *decodeOptions, wellRects));
+    const std::map<std::string, const WellDecoder *> & decodedWells = dmScanLib.getDecodedWells();
+    ASSERT_GT(decodedWells.size(), 0u);
+
+    DecodeCapture::configure(".", 0, 0, false);
+    const std::string captureFname = DecodeCapture::write(image, *decodeOptions, wellRects,
+            &decodedWells, SC_SUCCESS, dmScanLib.getDecodeReport());
+    DecodeCapture::configure("", 0, 0, false);
+    ASSERT_FALSE(captureFname.empty());
+
+    test::Capture capture(captureFname);
+    EXPECT_EQ(decodedWells.size(), capture.messages.size());
+    for (std::map<std::string, const WellDecoder *>::const_iterator ii = decodedWells.begin();
+            ii != decodedWells.end(); ++ii) {
+        EXPECT_EQ(ii->first, capture.messages[ii->second->getLabel()]);
+    }
+
+    test::ReplayResult replayResult;
+    test::replay(capture, 1, 0, replayResult);
+    EXPECT_EQ(SC_SUCCESS, replayResult.result);
+    EXPECT_EQ(decodedWells.size(), replayResult.same);
+    EXPECT_TRUE(replayResult.resultsMatch());
+
+    capture.messages.begin()->second.append("0");
+    test::ReplayResult changedResult;
+    test::replay(capture, 1, 0, changedResult);
+    EXPECT_EQ(1u, changedResult.changed);
+    EXPECT_FALSE(changedResult.resultsMatch());
+
+    DmScanLib::setDecodeThreadCount(decoder::ThreadMgr::DEFAULT_THREAD_NUM);
+    remove(capture.imageFilename.c_str());
+    remove(captureFname.c_str());
+}
+
+/*
+ * A decode that throws still finishes its trace, so the next pallet is traced.
+ */
+TEST(TestDmScanLib, traceAfterFailedDecode) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+    std::string traceFname("testDmScanLib.json");
+    remove(traceFname.c_str());
+
+    std::vector<std::unique_ptr<const WellRectangle> > outsideRects;
+    outsideRects.push_back(std::unique_ptr<const WellRectangle>(
+            new WellRectangle("A1", 100000, 100000, 10, 10)));
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+
+    DmScanLib::setTraceFilename(traceFname);
+    DmScanLib dmScanLib(1);
+    EXPECT_THROW(dmScanLib.decodeImageWells(fname.c_str(), *decodeOptions, outsideRects),
+            std::invalid_argument);
+    remove(traceFname.c_str());
+
+    int result = test::decodeImage(fname, dmScanLib, 8, 12);
+    DmScanLib::setTraceFilename("");
+    EXPECT_EQ(SC_SUCCESS, result);
+
+    std::ifstream traceFile(traceFname.c_str());
+    std::stringstream trace;
+    trace << traceFile.rdbuf();
+    EXPECT_NE(std::string::npos, trace.str().find("\"decodeWell\""));
+    traceFile.close();
+    remove(traceFname.c_str());
+}
+
+TEST(TestDmScanLib, imageFilesOff) {
+    FLAGS_v = 0;
+
+    std::string decodedFname("testDmScanLibDecoded.png");
+    remove(decodedFname.c_str());
+
+    DmScanLib dmScanLib(1);
+    dmScanLib.setImageFilenames("", "");
+    EXPECT_EQ(SC_SUCCESS, test::decodeImage("testImages/8x12/96tubes.bmp", dmScanLib, 8, 12));
+    EXPECT_FALSE(std::ifstream(decodedFname.c_str()).good());
+
+    dmScanLib.setImageFilenames("", decodedFname);
+    EXPECT_EQ(SC_SUCCESS, test::decodeImage("testImages/8x12/96tubes.bmp", dmScanLib, 8, 12));
+    EXPECT_TRUE(std::ifstream(decodedFname.c_str()).good());
+    remove(decodedFname.c_str());
+}
+
+/*
+ * With speculative decoding a later tier decodes the wells the first tier cannot,
+ * and an attempt that has lost the race stops before searching the well.
+ */
+TEST(TestDmScanLib, speculativeLaterTierWins) {
+    FLAGS_v = 0;
+
+    Image image("testImages/8x12/96tubes.bmp");
+    ASSERT_TRUE(image.isValid());
+
+    // the first tier only looks for a symbol size the tubes do not have
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(
+            new DecodeProfile(1, 0.1, 15, 5, 10, false, DmtxSymbol144x144)));
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(
+            new DecodeProfile(1, 0.1, 15, 5, 10)));
+    DecodeOptions decodeOptions(0.2, 0.3, profiles);
+    decodeOptions.setSpeculativeDecode(true);
+
+    cv::Rect bbox(0, 0, image.size().width, image.size().height);
+    std::shared_ptr<const DecodePlan> plan(
+            new DecodePlan(decodeOptions, bbox, 8, 12, LANDSCAPE, TUBE_BOTTOMS));
+    DecodeReport decodeReport;
+    Decoder decoder(image, plan, decodeReport);
+    EXPECT_EQ(SC_SUCCESS, decoder.decodeWellRects());
+
+    const std::vector<unsigned> & tierDecodeCounts = decoder.getTierDecodeCounts();
+    ASSERT_EQ(2u, tierDecodeCounts.size());
+    EXPECT_EQ(0u, tierDecodeCounts[0]);
+    EXPECT_GT(tierDecodeCounts[1], 0u);
+
+    WellDecoder * wellDecoder = NULL;
+    std::vector<std::unique_ptr<WellDecoder> > & wellDecoders = decoder.getWellDecoders();
+    for (unsigned i = 0, n = wellDecoders.size(); (i < n) && (wellDecoder == NULL); ++i) {
+        if (wellDecoders[i]->getDecodeTier() == 1) {
+            wellDecoder = wellDecoders[i].get();
+        }
+    }
+    ASSERT_TRUE(wellDecoder != NULL);
+    EXPECT_TRUE(wellDecoder->isDecodedByOtherTier(0));
+    EXPECT_FALSE(wellDecoder->isDecodedByOtherTier(1));
+
+    const std::string message = wellDecoder->getMessage();
+    const DmtxDecodeStats before = wellDecoder->getDecodeStats();
+    const DecodeProfile & firstProfile = *plan->getDecodeOptions().getProfiles()[0];
+
+    // a cancellable first tier attempt gives up before its first grid location
+    wellDecoder->decode(firstProfile, 0, true);
+    EXPECT_EQ(before.gridLocations, wellDecoder->getDecodeStats().gridLocations);
+
+    // the same attempt run to the end searches the well, and changes nothing
+    wellDecoder->decode(firstProfile, 0, false);
+    EXPECT_GT(wellDecoder->getDecodeStats().gridLocations, before.gridLocations);
+    EXPECT_EQ(1, wellDecoder->getDecodeTier());
+    EXPECT_EQ(message, wellDecoder->getMessage());
+}
+
+TEST(TestDmScanLib, sbsLabeling) {
+    std::string label;
+
+    DmScanLib::sbsLabelingFromRowCol(0, 0, label);
+    EXPECT_EQ("A1", label);
+
+    DmScanLib::sbsLabelingFromRowCol(15, 23, label);
+    EXPECT_EQ("P24", label);
+
+    DmScanLib::sbsLabelingFromRowCol(26, 0, label);
+    EXPECT_EQ("AA1", label);
+
+    DmScanLib::sbsLabelingFromRowCol(31, 47, label);
+    EXPECT_EQ("AF48", label);
+}
+
 void writeAllDecodeResults(std::vector<std::string> & testResults, bool append = false) {
     std::ofstream ofile;
     if (append) {
@@ -0,0 +1,172 @@
+/*
+ * TestDmScanLibC.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "capi/DmScanLibC.h"
+#include "DmScanLib.h"
+#include "test/TestCommon.h"
+
+#include <fstream>
+#include <iterator>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <opencv/highgui.h>
+
+using namespace dmscanlib;
+
+namespace {
+
+DmScanOptions getDefaultOptions() {
+    DmScanOptions options;
+    options.minEdgeFactor = 0.2;
+    options.maxEdgeFactor = 0.3;
+    options.scanGapFactor = 0.1;
+    options.squareDev = 15;
+    options.edgeThresh = 5;
+    options.corrections = 10;
+    options.shrink = 1;
+    options.speculativeDecode = 0;
+    return options;
+}
+
+DmScanLayout * createLayout(const cv::Mat & image) {
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    test::getWellRectsForBoundingBox(cv::Rect(0, 0, image.cols, image.rows), 8, 12,
+            LANDSCAPE, TUBE_BOTTOMS, wellRects);
+
+    std::vector<float> corners;
+    std::vector<const char *> labels;
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        const cv::Rect & rect = wellRects[i]->getRectangle();
+        const float x[] = {
+                static_cast<float>(rect.x),
+                static_cast<float>(rect.x + rect.width),
+                static_cast<float>(rect.x + rect.width),
+                static_cast<float>(rect.x) };
+        const float y[] = {
+                static_cast<float>(rect.y),
+                static_cast<float>(rect.y),
+                static_cast<float>(rect.y + rect.height),
+                static_cast<float>(rect.y + rect.height) };
+        for (unsigned c = 0; c < 4; ++c) {
+            corners.push_back(x[c]);
+            corners.push_back(y[c]);
+        }
+        labels.push_back(wellRects[i]->getLabel().c_str());
+    }
+    return dmscan_layout_create(&corners[0], &labels[0], wellRects.size());
+}
+
+TEST(TestDmScanLibC, invalidArguments) {
+    const float corners[] = { 10, 10, 10, 10, 10, 10, 10, 10 };
+    EXPECT_TRUE(dmscan_layout_create(corners, NULL, 1) == NULL);
+    EXPECT_TRUE(dmscan_layout_create(NULL, NULL, 1) == NULL);
+    EXPECT_EQ(0u, dmscan_layout_well_count(NULL));
+
+    const float wellCorners[] = { 10, 10, 50, 10, 50, 50, 10, 50 };
+    DmScanLayout * layout = dmscan_layout_create(wellCorners, NULL, 1);
+    ASSERT_TRUE(layout != NULL);
+    EXPECT_EQ(1u, dmscan_layout_well_count(layout));
+
+    DmScanSession * session = dmscan_session_open(0);
+    ASSERT_TRUE(session != NULL);
+
+    const DmScanOptions options = getDefaultOptions();
+    const unsigned char pixels[] = { 0 };
+    DmScanImage image = { pixels, 1, 0, 0, 0, DMSCAN_PIXEL_GRAY8 };
+    DmScanWellResult well;
+    DmScanImageResult result;
+
+    EXPECT_EQ(DMSCAN_INVALID_ARGUMENT,
+            dmscan_decode(session, NULL, &options, &image, &well, 1, &result));
+    EXPECT_EQ(DMSCAN_BUFFER_TOO_SMALL,
+            dmscan_decode(session, layout, &options, &image, &well, 0, &result));
+
+    image.data = NULL;
+    EXPECT_EQ(DMSCAN_INVALID_IMAGE,
+            dmscan_decode(session, layout, &options, &image, &well, 1, &result));
+    EXPECT_EQ(DMSCAN_INVALID_IMAGE, result.result);
+    EXPECT_EQ(DMSCAN_WELL_NOT_DECODED, well.status);
+
+    dmscan_session_close(session);
+    dmscan_layout_release(layout);
+}
+
+TEST(TestDmScanLibC, decodeBatch) {
+    FLAGS_v = 0;
+
+    std::string fname("testImages/8x12/96tubes.bmp");
+
+    DmScanLib dmScanLib(0);
+    ASSERT_EQ(SC_SUCCESS, test::decodeImage(fname, dmScanLib, 8, 12));
+    const unsigned decodedWellCount = dmScanLib.getDecodedWellCount();
+
+    std::ifstream file(fname.c_str(), std::ios::binary);
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    ASSERT_FALSE(encoded.empty());
+
+    cv::Mat bgr = cv::imread(fname);
+    ASSERT_TRUE(bgr.data != NULL);
+
+    DmScanLayout * layout = createLayout(bgr);
+    ASSERT_TRUE(layout != NULL);
+    const unsigned wellCount = dmscan_layout_well_count(layout);
+    EXPECT_EQ(96u, wellCount);
+
+    DmScanSession * session = dmscan_session_open(0);
+    ASSERT_TRUE(session != NULL);
+
+    const DmScanOptions options = getDefaultOptions();
+    const DmScanImage images[] = {
+            { &encoded[0], static_cast<uint32_t>(encoded.size()), 0, 0, 0, 0 },
+            { bgr.data, 0, static_cast<uint32_t>(bgr.cols), static_cast<uint32_t>(bgr.rows),
+                    static_cast<uint32_t>(bgr.step), DMSCAN_PIXEL_BGR24 },
+            { &encoded[0], 16, 0, 0, 0, 0 }
+    };
+    const unsigned imageCount = sizeof(images) / sizeof(images[0]);
+
+    std::vector<DmScanWellResult> wells(imageCount * wellCount);
+    std::vector<DmScanImageResult> results(imageCount);
+
+    ASSERT_EQ(DMSCAN_SUCCESS, dmscan_decode_batch(session, layout, &options, images,
+            imageCount, &wells[0], &results[0]));
+
+    for (unsigned i = 0; i < 2; ++i) {
+        EXPECT_EQ(DMSCAN_SUCCESS, results[i].result);
+        EXPECT_EQ(decodedWellCount, results[i].decodedWells);
+        EXPECT_GT(results[i].totalNanos, 0);
+
+        unsigned decoded = 0;
+        for (unsigned w = 0; w < wellCount; ++w) {
+            const DmScanWellResult & well = wells[i * wellCount + w];
+            if (well.status == DMSCAN_WELL_NOT_DECODED) {
+                EXPECT_EQ(0, well.messageLength);
+                continue;
+            }
+            ++decoded;
+            EXPECT_EQ(DMSCAN_WELL_DECODED, well.status);
+            EXPECT_GE(well.tier, 0);
+            EXPECT_EQ(static_cast<size_t>(well.messageLength), strlen(well.message));
+
+            // both images are the same, so are the messages
+            EXPECT_STREQ(wells[w].message, well.message);
+        }
+        EXPECT_EQ(decodedWellCount, decoded);
+    }
+
+    EXPECT_EQ(DMSCAN_INVALID_IMAGE, results[2].result);
+    EXPECT_EQ(0u, results[2].decodedWells);
+
+    dmscan_session_close(session);
+    dmscan_layout_release(layout);
+}
+
+} /* namespace */
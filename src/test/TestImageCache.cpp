@@ -0,0 +1,138 @@
+/*
+ * TestImageCache.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "decoder/ImageCache.h"
+#include "Image.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib;
+using namespace dmscanlib::decoder;
+
+const unsigned IMAGE_BYTES = 100 * 100;
+
+/*
+ * The cache is process wide, every test starts with it empty and leaves it off.
+ */
+class CacheReset {
+public:
+    CacheReset(size_t maxBytes) {
+        ImageCache::getInstance().clear();
+        ImageCache::getInstance().setMaxBytes(maxBytes);
+    }
+
+    ~CacheReset() {
+        ImageCache::getInstance().setMaxBytes(0);
+    }
+};
+
+std::shared_ptr<const CachedImage> createCachedImage(const std::vector<unsigned char> & pixels) {
+    std::shared_ptr<const Image> image(new Image(&pixels[0], 100, 100, 100, PIXEL_GRAY8));
+    return std::shared_ptr<const CachedImage>(
+            new CachedImage(image, std::shared_ptr<const Image>()));
+}
+
+ImageCache::Key createKey(const std::string & filename, long long modifiedTime) {
+    ImageCache::Key key;
+    key.filename = filename;
+    key.modifiedTime = modifiedTime;
+    key.fileSize = IMAGE_BYTES;
+    return key;
+}
+
+TEST(TestImageCache, leastRecentlyUsedDropped) {
+    CacheReset reset(2 * IMAGE_BYTES);
+    ImageCache & cache = ImageCache::getInstance();
+    const std::vector<unsigned char> pixels(IMAGE_BYTES);
+
+    std::shared_ptr<const CachedImage> first = createCachedImage(pixels);
+    EXPECT_EQ(IMAGE_BYTES, first->bytes);
+
+    cache.insert(createKey("a.png", 1), first);
+    cache.insert(createKey("b.png", 1), createCachedImage(pixels));
+    EXPECT_EQ(2u, cache.getImageCount());
+    EXPECT_EQ(2 * IMAGE_BYTES, cache.getBytes());
+
+    // a.png becomes the most recently used, b.png is dropped
+    EXPECT_TRUE(cache.find(createKey("a.png", 1)) == first);
+    cache.insert(createKey("c.png", 1), createCachedImage(pixels));
+    EXPECT_EQ(2u, cache.getImageCount());
+    EXPECT_TRUE(cache.find(createKey("b.png", 1)).get() == NULL);
+    EXPECT_TRUE(cache.find(createKey("a.png", 1)).get() != NULL);
+
+    cache.setMaxBytes(IMAGE_BYTES);
+    EXPECT_EQ(1u, cache.getImageCount());
+    EXPECT_TRUE(cache.find(createKey("c.png", 1)).get() == NULL);
+
+    // too large to keep at all
+    cache.setMaxBytes(IMAGE_BYTES - 1);
+    cache.insert(createKey("d.png", 1), createCachedImage(pixels));
+    EXPECT_EQ(0u, cache.getImageCount());
+    EXPECT_EQ(0u, cache.getBytes());
+}
+
+TEST(TestImageCache, changedFileMisses) {
+    CacheReset reset(10 * IMAGE_BYTES);
+    ImageCache & cache = ImageCache::getInstance();
+    const std::vector<unsigned char> pixels(IMAGE_BYTES);
+
+    cache.insert(createKey("a.png", 1), createCachedImage(pixels));
+    EXPECT_TRUE(cache.find(createKey("a.png", 2)).get() == NULL);
+
+    // the new version of the file replaces the old one
+    cache.insert(createKey("a.png", 2), createCachedImage(pixels));
+    EXPECT_EQ(1u, cache.getImageCount());
+    EXPECT_TRUE(cache.find(createKey("a.png", 1)).get() == NULL);
+    EXPECT_TRUE(cache.find(createKey("a.png", 2)).get() != NULL);
+}
+
+TEST(TestImageCache, invalidate) {
+    CacheReset reset(10 * IMAGE_BYTES);
+    ImageCache & cache = ImageCache::getInstance();
+    const std::vector<unsigned char> pixels(IMAGE_BYTES);
+
+    cache.insert(createKey("a.png", 1), createCachedImage(pixels));
+    cache.insert(createKey("b.png", 1), createCachedImage(pixels));
+
+    cache.invalidate("a.png");
+    EXPECT_EQ(1u, cache.getImageCount());
+    EXPECT_EQ(IMAGE_BYTES, cache.getBytes());
+    EXPECT_TRUE(cache.find(createKey("a.png", 1)).get() == NULL);
+
+    cache.clear();
+    EXPECT_EQ(0u, cache.getImageCount());
+    EXPECT_EQ(0u, cache.getBytes());
+}
+
+TEST(TestImageCache, getKey) {
+    const std::string filename("testImageCache.tmp");
+    FILE * fp = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(fp != NULL);
+    fputs("0123456789", fp);
+    fclose(fp);
+
+    ImageCache::Key key;
+    ASSERT_TRUE(ImageCache::getKey(filename, key));
+    EXPECT_EQ(filename, key.filename);
+    EXPECT_EQ(10, key.fileSize);
+
+    struct stat status;
+    ASSERT_EQ(0, stat(filename.c_str(), &status));
+    EXPECT_EQ(static_cast<long long>(status.st_mtime), key.modifiedTime / 1000000000LL);
+
+    remove(filename.c_str());
+    EXPECT_FALSE(ImageCache::getKey(filename, key));
+}
+
+} /* namespace */
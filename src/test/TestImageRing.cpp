@@ -0,0 +1,109 @@
+/*
+ * TestImageRing.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "utils/ImageRing.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <gtest/gtest.h>
+
+#ifdef WIN32
+#   include <process.h>
+#   define getpid _getpid
+#else
+#   include <unistd.h>
+#endif
+
+namespace {
+
+using namespace dmscanlib;
+using namespace dmscanlib::util;
+
+/*
+ * Tests running at the same time must not share a ring.
+ */
+std::string getRingName() {
+    std::ostringstream name;
+    name << "/dmscanlib-test-" << getpid();
+    return name.str();
+}
+
+TEST(TestImageRing, handOff) {
+    std::unique_ptr<ImageRing> decoderRing = ImageRing::create(getRingName(), 2, 1000);
+    std::unique_ptr<ImageRing> producerRing = ImageRing::open(getRingName());
+    EXPECT_EQ(2u, producerRing->getSlotCount());
+    EXPECT_EQ(1000u, producerRing->getSlotSize());
+
+    ImageSlotHandle handle;
+    ASSERT_TRUE(producerRing->acquire(handle));
+    memset(producerRing->getSlotPixels(handle), 7, 300);
+    producerRing->publish(handle, 10, 10, 30, PIXEL_BGR24);
+
+    std::unique_ptr<ImageSlot> slot = decoderRing->take(handle);
+    ASSERT_TRUE(slot.get() != NULL);
+    EXPECT_EQ(10u, slot->width);
+    EXPECT_EQ(10u, slot->height);
+    EXPECT_EQ(30u, slot->stride);
+    EXPECT_EQ(PIXEL_BGR24, slot->format);
+    EXPECT_EQ(7, slot->getPixels()[0]);
+    EXPECT_EQ(7, slot->getPixels()[299]);
+
+    // taken only once
+    EXPECT_TRUE(decoderRing->take(handle).get() == NULL);
+    EXPECT_FALSE(producerRing->discard(handle));
+}
+
+TEST(TestImageRing, slotsAreReused) {
+    std::unique_ptr<ImageRing> ring = ImageRing::create(getRingName(), 2, 100);
+
+    ImageSlotHandle first;
+    ImageSlotHandle second;
+    ImageSlotHandle third;
+    ASSERT_TRUE(ring->acquire(first));
+    ASSERT_TRUE(ring->acquire(second));
+    EXPECT_NE(first.slot, second.slot);
+    EXPECT_FALSE(ring->acquire(third));
+
+    ring->publish(first, 10, 10, 10, PIXEL_GRAY8);
+    ring->take(first).reset();
+
+    // released when the decoder is done with it, under a new generation
+    ASSERT_TRUE(ring->acquire(third));
+    EXPECT_EQ(first.slot, third.slot);
+    EXPECT_NE(first.generation, third.generation);
+
+    // a stale handle is refused
+    ring->publish(third, 10, 10, 10, PIXEL_GRAY8);
+    EXPECT_TRUE(ring->take(first).get() == NULL);
+
+    EXPECT_TRUE(ring->discard(third));
+    EXPECT_TRUE(ring->discard(second));
+    EXPECT_TRUE(ring->take(third).get() == NULL);
+}
+
+TEST(TestImageRing, invalidImages) {
+    std::unique_ptr<ImageRing> ring = ImageRing::create(getRingName(), 1, 100);
+
+    ImageSlotHandle handle;
+    ASSERT_TRUE(ring->acquire(handle));
+    EXPECT_THROW(ring->publish(handle, 10, 11, 10, PIXEL_GRAY8), std::invalid_argument);
+    EXPECT_THROW(ring->publish(handle, 0, 10, 10, PIXEL_GRAY8), std::invalid_argument);
+
+    // not published yet
+    EXPECT_TRUE(ring->take(handle).get() == NULL);
+
+    ring->publish(handle, 10, 10, 10, PIXEL_GRAY8);
+    EXPECT_THROW(ring->getSlotPixels(handle), std::invalid_argument);
+    EXPECT_THROW(ring->publish(handle, 10, 10, 10, PIXEL_GRAY8), std::invalid_argument);
+
+    EXPECT_THROW(ImageRing::create(getRingName(), 0, 100), std::invalid_argument);
+    EXPECT_THROW(ImageRing::open("/dmscanlib-test-no-such-ring"), std::runtime_error);
+}
+
+} /* namespace */
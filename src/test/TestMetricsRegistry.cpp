@@ -0,0 +1,73 @@
+/*
+ * TestMetricsRegistry.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "utils/MetricsRegistry.h"
+
+#include <sstream>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib::util;
+
+TEST(TestMetricsRegistry, bucketsCoverEveryValue) {
+    unsigned prevIndex = 0;
+    for (dmUint64 value = 0; value < 100000; ++value) {
+        unsigned index = LatencyHistogram::getBucketIndex(value);
+        ASSERT_TRUE((index == prevIndex) || (index == prevIndex + 1));
+        ASSERT_GE(LatencyHistogram::getBucketUpperBound(index), value);
+        prevIndex = index;
+    }
+    EXPECT_GT(LatencyHistogram::BUCKET_COUNT, LatencyHistogram::getBucketIndex(~0ULL));
+}
+
+TEST(TestMetricsRegistry, percentiles) {
+    LatencyHistogram histogram;
+    for (dmUint64 i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000000);
+    }
+
+    std::unique_ptr<HistogramSnapshot> snapshot = histogram.snapshot();
+    EXPECT_EQ(1000u, snapshot->count);
+    EXPECT_EQ(1000000000u, snapshot->maxNanos);
+
+    // within the 1/16 bucket resolution
+    EXPECT_NEAR(500e6, static_cast<double>(snapshot->getPercentileNanos(0.5)), 500e6 / 16);
+    EXPECT_NEAR(990e6, static_cast<double>(snapshot->getPercentileNanos(0.99)), 990e6 / 16);
+    EXPECT_EQ(snapshot->maxNanos, snapshot->getPercentileNanos(1.0));
+    EXPECT_DOUBLE_EQ(500.5e6, snapshot->getMeanNanos());
+}
+
+TEST(TestMetricsRegistry, emptyHistogram) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(0u, histogram.snapshot()->getPercentileNanos(0.99));
+}
+
+TEST(TestMetricsRegistry, countersAreCumulative) {
+    MetricsRegistry & metrics = MetricsRegistry::getInstance();
+    std::unique_ptr<MetricsSnapshot> before = metrics.snapshot();
+
+    metrics.addWell(true, true, 1000);
+    metrics.addWell(false, false, 2000);
+    // a region was found but did not decode, the well is not empty
+    metrics.addWell(false, true, 3000);
+    metrics.addRetry();
+
+    std::unique_ptr<MetricsSnapshot> after = metrics.snapshot();
+    EXPECT_EQ(before->wellsAttempted + 3, after->wellsAttempted);
+    EXPECT_EQ(before->wellsDecoded + 1, after->wellsDecoded);
+    EXPECT_EQ(before->emptyWells + 1, after->emptyWells);
+    EXPECT_EQ(before->retries + 1, after->retries);
+
+    std::ostringstream os;
+    after->writeText(os);
+    EXPECT_NE(std::string::npos, os.str().find("dmscanlib_wells_decoded_total"));
+    EXPECT_NE(std::string::npos, os.str().find("dmscanlib_well_latency_seconds{quantile=\"0.99\"}"));
+}
+
+} /* namespace */
@@ -0,0 +1,87 @@
+/*
+ * TestPackedDecodeResult.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+#include "decoder/DecodeReport.h"
+#include "decoder/PackedDecodeResult.h"
+#include "decoder/WellDecoder.h"
+#include "test/TestCommon.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+using namespace dmscanlib;
+
+namespace {
+
+int32_t getInt(const std::vector<unsigned char> & buffer, unsigned offset) {
+    int32_t value;
+    memcpy(&value, &buffer[offset], sizeof(value));
+    return value;
+}
+
+int64_t getLong(const std::vector<unsigned char> & buffer, unsigned offset) {
+    int64_t value;
+    memcpy(&value, &buffer[offset], sizeof(value));
+    return value;
+}
+
+TEST(TestPackedDecodeResult, pack) {
+    FLAGS_v = 0;
+
+    DmScanLib dmScanLib(1);
+    int result = test::decodeImage("testImages/8x12/96tubes.bmp", dmScanLib, 8, 12);
+    ASSERT_EQ(SC_SUCCESS, result);
+
+    const std::vector<std::unique_ptr<WellDecoder> > & wellDecoders =
+            dmScanLib.getWellDecoders();
+    ASSERT_EQ(96u, wellDecoders.size());
+
+    const unsigned length = PackedDecodeResult::getPackedLength(wellDecoders);
+    std::vector<unsigned char> buffer(length);
+
+    // too small: only the header, which has the length needed
+    EXPECT_EQ(length, PackedDecodeResult::pack(result, 0, wellDecoders, &buffer[0],
+            PackedDecodeResult::HEADER_LENGTH));
+    EXPECT_EQ(static_cast<int32_t>(length), getInt(buffer, 12));
+
+    const util::dmUint64 totalNanos = dmScanLib.getDecodeReport().getTotalNanos();
+    ASSERT_EQ(length, PackedDecodeResult::pack(result, totalNanos, wellDecoders, &buffer[0],
+            length));
+
+    EXPECT_EQ(PackedDecodeResult::FORMAT_VERSION, getInt(buffer, 0));
+    EXPECT_EQ(result, getInt(buffer, 4));
+    EXPECT_EQ(96, getInt(buffer, 8));
+    EXPECT_EQ(static_cast<int64_t>(totalNanos), getLong(buffer, 16));
+
+    unsigned offset = PackedDecodeResult::HEADER_LENGTH;
+    for (unsigned i = 0; i < wellDecoders.size(); ++i) {
+        const WellDecoder & wellDecoder = *wellDecoders[i];
+        const std::string & message = wellDecoder.getMessage();
+
+        EXPECT_EQ(static_cast<int32_t>(i), getInt(buffer, offset));
+        EXPECT_EQ(message.empty() ? PackedDecodeResult::WELL_NOT_DECODED
+                : PackedDecodeResult::WELL_DECODED, getInt(buffer, offset + 4));
+        EXPECT_EQ(wellDecoder.getDecodeTier(), getInt(buffer, offset + 8));
+
+        const unsigned messageOffset = offset + PackedDecodeResult::WELL_LENGTH;
+        const int32_t messageLength = getInt(buffer, messageOffset - 4);
+        ASSERT_EQ(static_cast<int32_t>(message.size()), messageLength);
+        EXPECT_EQ(message, std::string(
+                reinterpret_cast<const char *>(&buffer[messageOffset]), messageLength));
+
+        offset = messageOffset + ((messageLength + 3) & ~3);
+    }
+    EXPECT_EQ(length, offset);
+}
+
+} /* namespace */
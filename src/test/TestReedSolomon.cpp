@@ -0,0 +1,201 @@
+/*
+ * TestReedSolomon.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "tools/DmtxKernels.h"
+
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+/*
+ * The codewords of a symbol with its data codewords filled in and its error
+ * codewords computed by libdmtx.
+ */
+std::vector<unsigned char> encode(int sizeIdx) {
+    DmtxMessage * msg = dmtxMessageCreate(sizeIdx, DmtxFormatMatrix);
+    const int dataWords = dmtxGetSymbolAttribute(DmtxSymAttribSymbolDataWords, sizeIdx);
+    for (int i = 0; i < dataWords; ++i) {
+        msg->code[i] = static_cast<unsigned char>(i * 37 + 11);
+    }
+    EXPECT_EQ(DmtxPass, dmtxKernelRsEncode(msg, sizeIdx));
+
+    std::vector<unsigned char> code(msg->code, msg->code + msg->codeSize);
+    dmtxMessageDestroy(&msg);
+    return code;
+}
+
+/*
+ * Index of the interleaved block the codeword belongs to.
+ */
+int getBlock(int sizeIdx, int word) {
+    const int dataWords = dmtxGetSymbolAttribute(DmtxSymAttribSymbolDataWords, sizeIdx);
+    const int blocks = dmtxGetSymbolAttribute(DmtxSymAttribInterleavedBlocks, sizeIdx);
+    return ((word < dataWords) ? word : word - dataWords) % blocks;
+}
+
+class Damage {
+public:
+    Damage(const std::vector<unsigned char> & original) :
+            code(original), unsure(original.size(), 0) {
+    }
+
+    void erase(int word, unsigned char error = 0x5a) {
+        code[word] ^= error;
+        unsure[word] = 1;
+    }
+
+    void corrupt(int word, unsigned char error = 0xa5) {
+        code[word] ^= error;
+    }
+
+    DmtxPassFail decode(int sizeIdx, int fix, int * corrected = NULL) {
+        return dmtxKernelRsDecodeCodewords(&code[0], &unsure[0], sizeIdx, fix, corrected);
+    }
+
+    std::vector<unsigned char> code;
+    std::vector<unsigned char> unsure;
+};
+
+/*
+ * A 24x24 symbol has a single block of 36 data and 24 error codewords, errors
+ * only decoding repairs at most 12 of them.
+ */
+TEST(TestReedSolomon, erasuresCorrectable) {
+    const std::vector<unsigned char> original = encode(DmtxSymbol24x24);
+    ASSERT_EQ(60u, original.size());
+
+    Damage damage(original);
+    for (int i = 0; i < 14; ++i) {
+        damage.erase(i * 4);
+    }
+
+    std::vector<unsigned char> errorsOnly(damage.code);
+    EXPECT_EQ(DmtxFail, dmtxKernelRsDecodeCodewords(
+            &errorsOnly[0], NULL, DmtxSymbol24x24, DmtxUndefined, NULL));
+
+    int corrected = 0;
+    EXPECT_EQ(DmtxPass, damage.decode(DmtxSymbol24x24, DmtxUndefined, &corrected));
+    EXPECT_EQ(14, corrected);
+    EXPECT_TRUE(damage.code == original);
+}
+
+TEST(TestReedSolomon, erasuresAndErrorsCorrectable) {
+    const std::vector<unsigned char> original = encode(DmtxSymbol24x24);
+
+    // 2 * 3 + 16 leaves the two reserved check words
+    Damage damage(original);
+    for (int i = 0; i < 16; ++i) {
+        damage.erase(i * 3);
+    }
+    damage.corrupt(49);
+    damage.corrupt(53);
+    damage.corrupt(58);
+
+    EXPECT_EQ(DmtxPass, damage.decode(DmtxSymbol24x24, DmtxUndefined));
+    EXPECT_TRUE(damage.code == original);
+}
+
+TEST(TestReedSolomon, erasuresUncorrectable) {
+    const std::vector<unsigned char> original = encode(DmtxSymbol24x24);
+
+    // 2 * 2 + 19 would spend one of the reserved check words
+    Damage reserved(original);
+    for (int i = 0; i < 19; ++i) {
+        reserved.erase(i * 3);
+    }
+    reserved.corrupt(58);
+    reserved.corrupt(59);
+    EXPECT_EQ(DmtxFail, reserved.decode(DmtxSymbol24x24, DmtxUndefined));
+
+    // every codeword unsure, more than can be erased
+    Damage unsure(original);
+    for (int i = 0; i < 30; ++i) {
+        unsure.erase(i * 2);
+    }
+    EXPECT_EQ(DmtxFail, unsure.decode(DmtxSymbol24x24, DmtxUndefined));
+
+    // correctable, but changes more codewords than allowed
+    Damage limited(original);
+    for (int i = 0; i < 14; ++i) {
+        limited.erase(i * 4);
+    }
+    EXPECT_EQ(DmtxFail, limited.decode(DmtxSymbol24x24, 10));
+}
+
+/*
+ * Random damage: a block within the reserve must be repaired, a block beyond
+ * what the code can repair must fail rather than come back with other data.
+ */
+TEST(TestReedSolomon, randomDamage) {
+    const int sizes[] = { DmtxSymbol24x24, DmtxSymbol52x52 };
+    std::mt19937 random(20261018);
+
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        const int sizeIdx = sizes[s];
+        const std::vector<unsigned char> original = encode(sizeIdx);
+        const int words = static_cast<int>(original.size());
+        const int blocks = dmtxGetSymbolAttribute(DmtxSymAttribInterleavedBlocks, sizeIdx);
+        const int blockErrorWords =
+                dmtxGetSymbolAttribute(DmtxSymAttribBlockErrorWords, sizeIdx);
+        std::uniform_int_distribution<int> damagedWords(1, 2 * blocks * blockErrorWords);
+        std::uniform_int_distribution<int> anyWord(0, words - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> error(1, 255);
+
+        unsigned correctable = 0, uncorrectable = 0;
+        for (int trial = 0; trial < 2000; ++trial) {
+            Damage damage(original);
+            std::vector<int> erasures(blocks, 0), errors(blocks, 0), marked(blocks, 0);
+
+            for (int i = damagedWords(random); i > 0; --i) {
+                const int word = anyWord(random);
+                if ((damage.code[word] != original[word]) || damage.unsure[word]) {
+                    continue;
+                }
+                const int block = getBlock(sizeIdx, word);
+                const int kind = percent(random);
+                if (kind < 80) {
+                    damage.erase(word, static_cast<unsigned char>(error(random)));
+                    ++erasures[block];
+                    ++marked[block];
+                } else if (kind < 90) {
+                    damage.corrupt(word, static_cast<unsigned char>(error(random)));
+                    ++errors[block];
+                } else {
+                    // unsure, but read correctly
+                    damage.unsure[word] = 1;
+                    ++marked[block];
+                }
+            }
+
+            bool withinReserve = true, beyondCode = false;
+            for (int b = 0; b < blocks; ++b) {
+                withinReserve = withinReserve
+                        && (2 * errors[b] + marked[b] <= blockErrorWords - 2);
+                beyondCode = beyondCode || (2 * errors[b] + erasures[b] > blockErrorWords);
+            }
+
+            const DmtxPassFail result = damage.decode(sizeIdx, DmtxUndefined);
+            if (withinReserve) {
+                ++correctable;
+                EXPECT_EQ(DmtxPass, result) << "trial " << trial;
+                EXPECT_TRUE(damage.code == original) << "trial " << trial;
+            } else if (beyondCode) {
+                ++uncorrectable;
+                EXPECT_TRUE((result == DmtxFail) || (damage.code == original))
+                        << "wrong data, trial " << trial;
+            }
+        }
+        EXPECT_GT(correctable, 100u);
+        EXPECT_GT(uncorrectable, 100u);
+    }
+}
+
+} /* namespace */
@@ -0,0 +1,144 @@
+/*
+ * TestTraceRecorder.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "utils/TraceRecorder.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <OpenThreads/Thread>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib::util;
+
+const char * TRACE_FILENAME = "testTraceRecorder.json";
+
+std::string readTraceFile() {
+    std::ifstream file(TRACE_FILENAME);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+
+unsigned countOccurrences(const std::string & str, const std::string & pattern) {
+    unsigned count = 0;
+    for (size_t pos = str.find(pattern); pos != std::string::npos;
+            pos = str.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+/*
+ * Works for the decode with the trace id, zero for none.
+ */
+class TraceThread : public OpenThreads::Thread {
+public:
+    TraceThread(unsigned _traceId, const char * _name = "worker") :
+            traceId(_traceId), name(_name) {
+    }
+
+    void run() {
+        TraceContext context(traceId);
+        for (unsigned i = 0; i < 10; ++i) {
+            TraceScope trace(name, "well");
+        }
+    }
+
+private:
+    const unsigned traceId;
+    const char * name;
+};
+
+TEST(TestTraceRecorder, disabledRecordsNothing) {
+    TraceRecorder::start();
+    TraceRecorder::stop();
+    {
+        TraceScope trace("ignored");
+    }
+    ASSERT_TRUE(TraceRecorder::writeJson(TRACE_FILENAME));
+    EXPECT_EQ(std::string::npos, readTraceFile().find("ignored"));
+    remove(TRACE_FILENAME);
+}
+
+TEST(TestTraceRecorder, beginAndEndPerThread) {
+    const unsigned traceId = TraceRecorder::start();
+    EXPECT_NE(0u, traceId);
+    {
+        TraceContext context(traceId);
+        TraceScope trace("main", "A1 \"quoted\"");
+        TraceThread thread1(traceId);
+        TraceThread thread2(traceId);
+        thread1.start();
+        thread2.start();
+        thread1.join();
+        thread2.join();
+    }
+    TraceRecorder::stop();
+    ASSERT_TRUE(TraceRecorder::writeJson(TRACE_FILENAME));
+
+    const std::string json = readTraceFile();
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+    EXPECT_EQ(21u, countOccurrences(json, "\"ph\":\"B\""));
+    EXPECT_EQ(21u, countOccurrences(json, "\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, json.find("A1 \\\"quoted\\\""));
+    EXPECT_NE(std::string::npos, json.find("\"tid\":3"));
+    remove(TRACE_FILENAME);
+}
+
+TEST(TestTraceRecorder, otherDecodesNotRecorded) {
+    const unsigned traceId = TraceRecorder::start();
+    {
+        TraceContext context(traceId);
+        TraceScope trace("traced");
+        TraceThread other(traceId + 1, "other");
+        TraceThread none(0, "none");
+        other.start();
+        none.start();
+        other.join();
+        none.join();
+    }
+    {
+        TraceScope trace("outside");
+    }
+    TraceRecorder::stop();
+    EXPECT_EQ(0u, TraceRecorder::getContext());
+    ASSERT_TRUE(TraceRecorder::writeJson(TRACE_FILENAME));
+
+    const std::string json = readTraceFile();
+    EXPECT_NE(std::string::npos, json.find("\"traced\""));
+    EXPECT_EQ(std::string::npos, json.find("\"other\""));
+    EXPECT_EQ(std::string::npos, json.find("\"none\""));
+    EXPECT_EQ(std::string::npos, json.find("\"outside\""));
+    remove(TRACE_FILENAME);
+}
+
+TEST(TestTraceRecorder, startDiscardsEvents) {
+    const unsigned firstId = TraceRecorder::start();
+    {
+        TraceContext context(firstId);
+        TraceScope trace("first");
+    }
+    const unsigned secondId = TraceRecorder::start();
+    EXPECT_NE(firstId, secondId);
+    {
+        TraceContext context(secondId);
+        TraceScope trace("second");
+    }
+    TraceRecorder::stop();
+    ASSERT_TRUE(TraceRecorder::writeJson(TRACE_FILENAME));
+
+    const std::string json = readTraceFile();
+    EXPECT_EQ(std::string::npos, json.find("\"first\""));
+    EXPECT_NE(std::string::npos, json.find("\"second\""));
+    remove(TRACE_FILENAME);
+}
+
+} /* namespace */
@@ -0,0 +1,162 @@
+/*
+ * TestWorkerPool.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "decoder/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <OpenThreads/Thread>
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace dmscanlib::decoder;
+
+/*
+ * Counts its tasks, and the most of them that ran at the same time.
+ */
+class CountingJob : public PoolJob {
+public:
+    CountingJob(unsigned _taskCount) :
+            taskCount(_taskCount),
+            started(0),
+            finished(0),
+            running(0),
+            maxRunning(0)
+    {
+    }
+
+    TaskStatus runTask() {
+        if (started.fetch_add(1) >= taskCount) {
+            return TASK_DONE;
+        }
+
+        const unsigned nowRunning = running.fetch_add(1) + 1;
+        unsigned previous = maxRunning.load();
+        while ((nowRunning > previous) && !maxRunning.compare_exchange_weak(previous, nowRunning)) {
+        }
+        OpenThreads::Thread::microSleep(100);
+        running.fetch_sub(1);
+        finished.fetch_add(1);
+        return TASK_RAN;
+    }
+
+    const unsigned taskCount;
+    std::atomic<unsigned> started;
+    std::atomic<unsigned> finished;
+    std::atomic<unsigned> running;
+    std::atomic<unsigned> maxRunning;
+};
+
+/*
+ * Its failTask'th task throws, as a std::exception or as an int.
+ */
+class FailingJob : public CountingJob {
+public:
+    FailingJob(unsigned _taskCount, unsigned _failTask, bool _stdException) :
+            CountingJob(_taskCount),
+            failTask(_failTask),
+            stdException(_stdException),
+            failed(0)
+    {
+    }
+
+    TaskStatus runTask() {
+        if ((started.load() >= failTask) && (failed.fetch_add(1) == 0)) {
+            if (stdException) {
+                throw std::runtime_error("task failed");
+            }
+            throw 42;
+        }
+        return CountingJob::runTask();
+    }
+
+    const unsigned failTask;
+    const bool stdException;
+    std::atomic<unsigned> failed;
+};
+
+class JobThread : public OpenThreads::Thread {
+public:
+    JobThread(PoolJob & _job, unsigned _maxWorkers) :
+            job(_job),
+            maxWorkers(_maxWorkers) {
+    }
+
+    void run() {
+        WorkerPool::getInstance().run(job, maxWorkers);
+    }
+
+private:
+    PoolJob & job;
+    const unsigned maxWorkers;
+};
+
+TEST(TestWorkerPool, runsEveryTask) {
+    CountingJob job(50);
+    WorkerPool::getInstance().run(job, 4);
+
+    EXPECT_EQ(50u, job.finished.load());
+    EXPECT_EQ(0u, job.running.load());
+    EXPECT_LE(job.maxRunning.load(), 4u);
+    EXPECT_GE(WorkerPool::getInstance().getThreadCount(), 4u);
+    EXPECT_EQ(0u, WorkerPool::getInstance().getJobCount());
+}
+
+TEST(TestWorkerPool, emptyJob) {
+    CountingJob job(0);
+    WorkerPool::getInstance().run(job, 4);
+    EXPECT_EQ(0u, job.finished.load());
+
+    // no threads, nothing runs
+    WorkerPool::getInstance().run(job, 0);
+    EXPECT_EQ(0u, job.finished.load());
+}
+
+TEST(TestWorkerPool, concurrentJobsShareThreads) {
+    const unsigned threadsBefore = WorkerPool::getInstance().getThreadCount();
+
+    CountingJob first(200);
+    CountingJob second(200);
+    JobThread firstThread(first, 4);
+    JobThread secondThread(second, 4);
+
+    firstThread.start();
+    secondThread.start();
+    firstThread.join();
+    secondThread.join();
+
+    EXPECT_EQ(200u, first.finished.load());
+    EXPECT_EQ(200u, second.finished.load());
+    EXPECT_LE(first.maxRunning.load(), 4u);
+    EXPECT_LE(second.maxRunning.load(), 4u);
+
+    // the jobs took turns on the same threads instead of starting their own
+    EXPECT_LE(WorkerPool::getInstance().getThreadCount(), std::max(threadsBefore, 4u));
+}
+
+/*
+ * The exception thrown by a task reaches the caller of run() whatever its type,
+ * and the pool keeps serving the jobs that come after.
+ */
+TEST(TestWorkerPool, taskException) {
+    FailingJob stdJob(50, 10, true);
+    EXPECT_THROW(WorkerPool::getInstance().run(stdJob, 4), std::runtime_error);
+    EXPECT_EQ(0u, stdJob.running.load());
+    EXPECT_LT(stdJob.finished.load(), 50u);
+
+    FailingJob intJob(50, 10, false);
+    EXPECT_THROW(WorkerPool::getInstance().run(intJob, 4), int);
+    EXPECT_EQ(0u, intJob.running.load());
+    EXPECT_EQ(0u, WorkerPool::getInstance().getJobCount());
+
+    CountingJob job(50);
+    WorkerPool::getInstance().run(job, 4);
+    EXPECT_EQ(50u, job.finished.load());
+}
+
+} /* namespace */
@@ -0,0 +1,203 @@
+/*
+ * CaptureReplay.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "CaptureReplay.h"
+#include "DmScanLib.h"
+#include "decoder/DecodeCapture.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/WellRectangle.h"
+#include "decoder/WellDecoder.h"
+
+#include <libconfig.h++>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace dmscanlib {
+
+namespace test {
+
+Capture::Capture(const std::string & filename) :
+        decodeThreads(0),
+        result(SC_FAIL),
+        totalNanos(0)
+{
+    libconfig::Config cfg;
+    try {
+        cfg.readFile(filename.c_str());
+    } catch (const libconfig::FileIOException & fioex) {
+        throw std::runtime_error("could not read capture file: " + filename);
+    } catch (const libconfig::ParseException & pex) {
+        std::ostringstream msg;
+        msg << "parse error at " << pex.getFile() << ":" << pex.getLine() << " - "
+            << pex.getError();
+        throw std::runtime_error(msg.str());
+    }
+
+    try {
+        const libconfig::Setting & root = cfg.getRoot();
+
+        int version = root["version"];
+        if (version != DecodeCapture::FORMAT_VERSION) {
+            throw std::runtime_error("unsupported capture version: " + filename);
+        }
+
+        // the image is next to the capture file
+        std::string imageName = root["imageFilename"];
+        const std::string::size_type slash = filename.find_last_of("/\\");
+        imageFilename = (slash == std::string::npos)
+                ? imageName : filename.substr(0, slash + 1) + imageName;
+
+        decodeThreads = static_cast<unsigned>(static_cast<int>(root["decodeThreads"]));
+
+        const libconfig::Setting & options = root["decodeOptions"];
+        std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+        const libconfig::Setting & profileSettings = options["profiles"];
+        for (int i = 0, n = profileSettings.getLength(); i < n; ++i) {
+            const libconfig::Setting & profile = profileSettings[i];
+
+            // not in the captures written before symbol size priors
+            int symbolSize = DmtxSymbolSquareAuto;
+            profile.lookupValue("symbolSize", symbolSize);
+
+            profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+                    static_cast<int>(profile["scale"]),
+                    static_cast<double>(profile["scanGapFactor"]),
+                    static_cast<int>(profile["squareDev"]),
+                    static_cast<int>(profile["edgeThresh"]),
+                    static_cast<int>(profile["corrections"]),
+                    static_cast<bool>(profile["subPixel"]),
+                    symbolSize)));
+        }
+        decodeOptions = std::unique_ptr<DecodeOptions>(new DecodeOptions(
+                static_cast<double>(options["minEdgeFactor"]),
+                static_cast<double>(options["maxEdgeFactor"]),
+                profiles));
+        decodeOptions->setSpeculativeDecode(static_cast<bool>(options["speculativeDecode"]));
+
+        const libconfig::Setting & wells = root["wells"];
+        for (int i = 0, n = wells.getLength(); i < n; ++i) {
+            const libconfig::Setting & well = wells[i];
+            std::string label = well["label"];
+            std::string message = well["message"];
+            wellRects.push_back(std::unique_ptr<const WellRectangle>(new WellRectangle(
+                    label.c_str(),
+                    static_cast<int>(well["x"]),
+                    static_cast<int>(well["y"]),
+                    static_cast<int>(well["width"]),
+                    static_cast<int>(well["height"]))));
+            if (!message.empty()) {
+                messages[label] = message;
+            }
+        }
+
+        result = root["result"];
+        totalNanos = static_cast<long long>(root["totalNanos"]);
+
+        const libconfig::Setting & stages = root["stageNanos"];
+        for (unsigned i = 0; i < STAGE_MAX; ++i) {
+            long long nanos = 0;
+            stages.lookupValue(DecodeReport::getStageName(static_cast<DecodeStage>(i)), nanos);
+            stageNanos[i] = nanos;
+        }
+    } catch (const libconfig::SettingException & ex) {
+        throw std::runtime_error(std::string("invalid setting in capture file: ")
+                + ex.getPath());
+    }
+}
+
+ReplayResult::ReplayResult() :
+        result(SC_FAIL),
+        totalNanos(0),
+        same(0),
+        changed(0),
+        gained(0),
+        lost(0)
+{
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        stageNanos[i] = 0;
+    }
+}
+
+void replay(
+        Capture & capture,
+        unsigned repetitions,
+        unsigned threadCount,
+        ReplayResult & replayResult) {
+    DmScanLib::setDecodeThreadCount(
+            (threadCount > 0) ? threadCount : std::max(1u, capture.decodeThreads));
+
+    std::vector<std::pair<util::dmUint64, std::vector<util::dmUint64> > > runs;
+    std::map<std::string, std::string> decodedMessages;
+
+    for (unsigned i = 0; i < repetitions; ++i) {
+        DmScanLib dmScanLib(0);
+        replayResult.result = dmScanLib.decodeImageWells(
+                capture.imageFilename.c_str(),
+                *capture.decodeOptions,
+                capture.wellRects);
+
+        const DecodeReport & report = dmScanLib.getDecodeReport();
+        std::vector<util::dmUint64> stages;
+        for (unsigned s = 0; s < STAGE_MAX; ++s) {
+            stages.push_back(report.getStageNanos(static_cast<DecodeStage>(s)));
+        }
+        runs.push_back(std::make_pair(report.getTotalNanos(), stages));
+
+        // the decoded wells are keyed by message
+        decodedMessages.clear();
+        if (replayResult.result == SC_SUCCESS) {
+            const std::map<std::string, const WellDecoder *> & decodedWells =
+                    dmScanLib.getDecodedWells();
+            for (std::map<std::string, const WellDecoder *>::const_iterator ii =
+                    decodedWells.begin(); ii != decodedWells.end(); ++ii) {
+                decodedMessages[ii->second->getLabel()] = ii->first;
+            }
+        }
+    }
+
+    std::sort(runs.begin(), runs.end());
+    const std::pair<util::dmUint64, std::vector<util::dmUint64> > & median =
+            runs[runs.size() / 2];
+    replayResult.totalNanos = median.first;
+    for (unsigned s = 0; s < STAGE_MAX; ++s) {
+        replayResult.stageNanos[s] = median.second[s];
+    }
+
+    compareMessages(capture, decodedMessages, replayResult);
+}
+
+void compareMessages(
+        const Capture & capture,
+        const std::map<std::string, std::string> & decodedMessages,
+        ReplayResult & replayResult) {
+    for (unsigned i = 0, n = capture.wellRects.size(); i < n; ++i) {
+        const std::string & label = capture.wellRects[i]->getLabel();
+        std::map<std::string, std::string>::const_iterator captured = capture.messages.find(label);
+        std::map<std::string, std::string>::const_iterator decoded = decodedMessages.find(label);
+
+        if (captured == capture.messages.end()) {
+            if (decoded != decodedMessages.end()) {
+                ++replayResult.gained;
+            }
+        } else if (decoded == decodedMessages.end()) {
+            ++replayResult.lost;
+            std::cout << "  " << label << ": lost " << captured->second << std::endl;
+        } else if (decoded->second != captured->second) {
+            ++replayResult.changed;
+            std::cout << "  " << label << ": " << captured->second << " -> "
+                      << decoded->second << std::endl;
+        } else {
+            ++replayResult.same;
+        }
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
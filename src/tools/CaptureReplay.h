@@ -0,0 +1,84 @@
+#ifndef CAPTUREREPLAY_H_
+#define CAPTUREREPLAY_H_
+
+/*
+ * CaptureReplay.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "decoder/DecodeReport.h"
+#include "utils/DmClock.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dmscanlib {
+
+class DecodeOptions;
+class WellRectangle;
+
+namespace test {
+
+/*
+ * A capture file written by DecodeCapture. messages holds the decoded message of
+ * each well, by label. Throws std::runtime_error if the file cannot be read.
+ */
+class Capture {
+public:
+    Capture(const std::string & filename);
+
+    std::string imageFilename;
+    unsigned decodeThreads;
+    std::unique_ptr<DecodeOptions> decodeOptions;
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    std::map<std::string, std::string> messages;
+    int result;
+    util::dmUint64 totalNanos;
+    util::dmUint64 stageNanos[STAGE_MAX];
+};
+
+class ReplayResult {
+public:
+    ReplayResult();
+
+    bool resultsMatch() const {
+        return (changed == 0) && (gained == 0) && (lost == 0);
+    }
+
+    int result;
+    util::dmUint64 totalNanos;
+    util::dmUint64 stageNanos[STAGE_MAX];
+    unsigned same;
+    unsigned changed;
+    unsigned gained;
+    unsigned lost;
+};
+
+/*
+ * Decodes the captured image again, repetitions times, with threadCount decode
+ * threads or the captured count when zero. The timings are those of the run with
+ * the median total time, the messages are compared after the last run.
+ */
+void replay(
+        Capture & capture,
+        unsigned repetitions,
+        unsigned threadCount,
+        ReplayResult & replayResult);
+
+/*
+ * Counts the wells whose message, by label, is the same, changed, gained or lost
+ * against the capture, and prints the differences.
+ */
+void compareMessages(
+        const Capture & capture,
+        const std::map<std::string, std::string> & decodedMessages,
+        ReplayResult & replayResult);
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* CAPTUREREPLAY_H_ */
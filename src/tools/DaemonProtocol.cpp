@@ -0,0 +1,427 @@
+/*
+ * DaemonProtocol.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DaemonProtocol.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+namespace dmscanlib {
+
+namespace dmscand {
+
+namespace {
+
+const uint32_t FRAME_HEADER_LENGTH = 2 * sizeof(uint32_t);
+
+bool readFully(int fd, void * buffer, size_t length) {
+    unsigned char * bytes = static_cast<unsigned char *>(buffer);
+    while (length > 0) {
+        const ssize_t count = recv(fd, bytes, length, 0);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (count == 0) {
+            return false;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void * buffer, size_t length) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(buffer);
+    while (length > 0) {
+        // a client that has gone must not kill the daemon with SIGPIPE
+        const ssize_t count = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += count;
+        length -= count;
+    }
+    return true;
+}
+
+} /* namespace */
+
+DecodeRequest::DecodeRequest() :
+        type(MSG_DECODE_FILE),
+        requestId(0),
+        minEdgeFactor(0),
+        maxEdgeFactor(0),
+        speculativeDecode(0)
+{
+}
+
+void MessageWriter::put(const void * value, unsigned length) {
+    const unsigned char * bytes = static_cast<const unsigned char *>(value);
+    payload.insert(payload.end(), bytes, bytes + length);
+}
+
+void MessageWriter::putUint(uint32_t value) {
+    put(&value, sizeof(value));
+}
+
+void MessageWriter::putInt(int32_t value) {
+    put(&value, sizeof(value));
+}
+
+void MessageWriter::putLong(int64_t value) {
+    put(&value, sizeof(value));
+}
+
+void MessageWriter::putFloat(float value) {
+    put(&value, sizeof(value));
+}
+
+void MessageWriter::putDouble(double value) {
+    put(&value, sizeof(value));
+}
+
+void MessageWriter::putString(const std::string & value) {
+    putUint(static_cast<uint32_t>(value.size()));
+    put(value.data(), value.size());
+}
+
+void MessageWriter::putBytes(const std::vector<unsigned char> & value) {
+    putUint(static_cast<uint32_t>(value.size()));
+    if (!value.empty()) {
+        put(&value[0], value.size());
+    }
+}
+
+MessageReader::MessageReader(const std::vector<unsigned char> & _payload) :
+        payload(_payload),
+        offset(0)
+{
+}
+
+void MessageReader::get(void * value, unsigned length) {
+    if (payload.size() - offset < length) {
+        throw std::runtime_error("message is truncated");
+    }
+    memcpy(value, &payload[0] + offset, length);
+    offset += length;
+}
+
+uint32_t MessageReader::getUint() {
+    uint32_t value;
+    get(&value, sizeof(value));
+    return value;
+}
+
+int32_t MessageReader::getInt() {
+    int32_t value;
+    get(&value, sizeof(value));
+    return value;
+}
+
+int64_t MessageReader::getLong() {
+    int64_t value;
+    get(&value, sizeof(value));
+    return value;
+}
+
+float MessageReader::getFloat() {
+    float value;
+    get(&value, sizeof(value));
+    return value;
+}
+
+double MessageReader::getDouble() {
+    double value;
+    get(&value, sizeof(value));
+    return value;
+}
+
+std::string MessageReader::getString() {
+    const uint32_t length = getUint();
+    if (payload.size() - offset < length) {
+        throw std::runtime_error("message is truncated");
+    }
+    std::string value(reinterpret_cast<const char *>(&payload[0]) + offset, length);
+    offset += length;
+    return value;
+}
+
+void MessageReader::getBytes(std::vector<unsigned char> & value) {
+    const uint32_t length = getUint();
+    if (payload.size() - offset < length) {
+        throw std::runtime_error("message is truncated");
+    }
+    value.assign(payload.begin() + offset, payload.begin() + offset + length);
+    offset += length;
+}
+
+bool readFrame(int fd, uint32_t & type, std::vector<unsigned char> & payload) {
+    uint32_t header[2];
+    if (!readFully(fd, header, FRAME_HEADER_LENGTH)) {
+        return false;
+    }
+    if (header[0] > MAX_FRAME_LENGTH) {
+        return false;
+    }
+    type = header[1];
+    payload.resize(header[0]);
+    return payload.empty() || readFully(fd, &payload[0], payload.size());
+}
+
+bool writeFrame(int fd, uint32_t type, const std::vector<unsigned char> & payload) {
+    uint32_t header[2];
+    header[0] = static_cast<uint32_t>(payload.size());
+    header[1] = type;
+    return writeFully(fd, header, FRAME_HEADER_LENGTH)
+            && (payload.empty() || writeFully(fd, &payload[0], payload.size()));
+}
+
+void writeRequest(const DecodeRequest & request, MessageWriter & writer) {
+    writer.putUint(request.requestId);
+    if (request.type == MSG_DECODE_FILE) {
+        writer.putString(request.imagePath);
+    } else if (request.type == MSG_DECODE_SLOT) {
+        writer.putUint(request.slotHandle.slot);
+        writer.putUint(request.slotHandle.generation);
+    } else {
+        writer.putBytes(request.imageBytes);
+    }
+
+    writer.putDouble(request.minEdgeFactor);
+    writer.putDouble(request.maxEdgeFactor);
+    writer.putInt(request.speculativeDecode);
+    writer.putUint(static_cast<uint32_t>(request.profiles.size()));
+    for (unsigned i = 0, n = request.profiles.size(); i < n; ++i) {
+        const ProfileSettings & profile = request.profiles[i];
+        writer.putInt(profile.scale);
+        writer.putDouble(profile.scanGapFactor);
+        writer.putInt(profile.squareDev);
+        writer.putInt(profile.edgeThresh);
+        writer.putInt(profile.corrections);
+        writer.putInt(profile.subPixel);
+        writer.putInt(profile.symbolSize);
+    }
+
+    writer.putUint(static_cast<uint32_t>(request.labels.size()));
+    for (unsigned i = 0, n = request.labels.size(); i < n; ++i) {
+        writer.putString(request.labels[i]);
+        for (unsigned c = 0; c < 8; ++c) {
+            writer.putFloat(request.corners[8 * i + c]);
+        }
+    }
+}
+
+void readRequest(uint32_t type, MessageReader & reader, DecodeRequest & request) {
+    request.type = type;
+    request.requestId = reader.getUint();
+    if (type == MSG_DECODE_FILE) {
+        request.imagePath = reader.getString();
+    } else if (type == MSG_DECODE_SLOT) {
+        request.slotHandle.slot = reader.getUint();
+        request.slotHandle.generation = reader.getUint();
+    } else {
+        reader.getBytes(request.imageBytes);
+    }
+
+    request.minEdgeFactor = reader.getDouble();
+    request.maxEdgeFactor = reader.getDouble();
+    request.speculativeDecode = reader.getInt();
+    const uint32_t profileCount = reader.getUint();
+    request.profiles.clear();
+    for (uint32_t i = 0; i < profileCount; ++i) {
+        ProfileSettings profile;
+        profile.scale = reader.getInt();
+        profile.scanGapFactor = reader.getDouble();
+        profile.squareDev = reader.getInt();
+        profile.edgeThresh = reader.getInt();
+        profile.corrections = reader.getInt();
+        profile.subPixel = reader.getInt();
+        profile.symbolSize = reader.getInt();
+        request.profiles.push_back(profile);
+    }
+
+    const uint32_t wellCount = reader.getUint();
+    request.labels.clear();
+    request.corners.clear();
+    for (uint32_t i = 0; i < wellCount; ++i) {
+        request.labels.push_back(reader.getString());
+        for (unsigned c = 0; c < 8; ++c) {
+            request.corners.push_back(reader.getFloat());
+        }
+    }
+}
+
+void writeWellResponse(const WellResponse & response, MessageWriter & writer) {
+    writer.putUint(response.requestId);
+    writer.putUint(response.wellIndex);
+    writer.putInt(response.decoded);
+    writer.putInt(response.tier);
+    writer.putInt(response.symbolSize);
+    writer.putLong(response.decodeNanos);
+    for (unsigned c = 0; c < 8; ++c) {
+        writer.putInt(response.quad[c]);
+    }
+    writer.putString(response.label);
+    writer.putString(response.message);
+}
+
+void readWellResponse(MessageReader & reader, WellResponse & response) {
+    response.requestId = reader.getUint();
+    response.wellIndex = reader.getUint();
+    response.decoded = reader.getInt();
+    response.tier = reader.getInt();
+    response.symbolSize = reader.getInt();
+    response.decodeNanos = reader.getLong();
+    for (unsigned c = 0; c < 8; ++c) {
+        response.quad[c] = reader.getInt();
+    }
+    response.label = reader.getString();
+    response.message = reader.getString();
+}
+
+void writeDoneResponse(const DoneResponse & response, MessageWriter & writer) {
+    writer.putUint(response.requestId);
+    writer.putInt(response.result);
+    writer.putUint(response.decodedWells);
+    writer.putLong(response.totalNanos);
+}
+
+void readDoneResponse(MessageReader & reader, DoneResponse & response) {
+    response.requestId = reader.getUint();
+    response.result = reader.getInt();
+    response.decodedWells = reader.getUint();
+    response.totalNanos = reader.getLong();
+}
+
+void writeErrorResponse(const ErrorResponse & response, MessageWriter & writer) {
+    writer.putUint(response.requestId);
+    writer.putString(response.message);
+}
+
+void readErrorResponse(MessageReader & reader, ErrorResponse & response) {
+    response.requestId = reader.getUint();
+    response.message = reader.getString();
+}
+
+void setRequestOptions(const DecodeOptions & decodeOptions, DecodeRequest & request) {
+    request.minEdgeFactor = decodeOptions.minEdgeFactor;
+    request.maxEdgeFactor = decodeOptions.maxEdgeFactor;
+    request.speculativeDecode = decodeOptions.getSpeculativeDecode() ? 1 : 0;
+
+    const std::vector<std::unique_ptr<const DecodeProfile> > & profiles =
+            decodeOptions.getProfiles();
+    request.profiles.clear();
+    for (unsigned i = 0, n = profiles.size(); i < n; ++i) {
+        ProfileSettings settings;
+        settings.scale = profiles[i]->scale;
+        settings.scanGapFactor = profiles[i]->scanGapFactor;
+        settings.squareDev = profiles[i]->squareDev;
+        settings.edgeThresh = profiles[i]->edgeThresh;
+        settings.corrections = profiles[i]->corrections;
+        settings.subPixel = profiles[i]->subPixel ? 1 : 0;
+        settings.symbolSize = profiles[i]->symbolSize;
+        request.profiles.push_back(settings);
+    }
+}
+
+void setRequestLayout(
+        const std::vector<std::unique_ptr<const WellRectangle> > & wellRects,
+        DecodeRequest & request) {
+    request.labels.clear();
+    request.corners.clear();
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        const cv::Rect & rect = wellRects[i]->getRectangle();
+        const float x[] = {
+                static_cast<float>(rect.x), static_cast<float>(rect.x + rect.width),
+                static_cast<float>(rect.x + rect.width), static_cast<float>(rect.x) };
+        const float y[] = {
+                static_cast<float>(rect.y), static_cast<float>(rect.y),
+                static_cast<float>(rect.y + rect.height), static_cast<float>(rect.y + rect.height) };
+
+        request.labels.push_back(wellRects[i]->getLabel());
+        for (unsigned c = 0; c < 4; ++c) {
+            request.corners.push_back(x[c]);
+            request.corners.push_back(y[c]);
+        }
+    }
+}
+
+std::unique_ptr<DecodeOptions> createDecodeOptions(const DecodeRequest & request) {
+    if (request.profiles.empty()) {
+        throw std::invalid_argument("decode request has no profiles");
+    }
+
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    for (unsigned i = 0, n = request.profiles.size(); i < n; ++i) {
+        const ProfileSettings & settings = request.profiles[i];
+        profiles.push_back(std::unique_ptr<const DecodeProfile>(new DecodeProfile(
+                settings.scale,
+                settings.scanGapFactor,
+                settings.squareDev,
+                settings.edgeThresh,
+                settings.corrections,
+                settings.subPixel != 0,
+                settings.symbolSize)));
+    }
+
+    std::unique_ptr<DecodeOptions> decodeOptions(new DecodeOptions(
+            request.minEdgeFactor, request.maxEdgeFactor, profiles));
+    decodeOptions->setSpeculativeDecode(request.speculativeDecode != 0);
+    return decodeOptions;
+}
+
+/*
+ * Each well is the bounding box of its four corners.
+ */
+void createWellRects(
+        const DecodeRequest & request,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+    if (request.labels.empty() || (request.corners.size() != 8 * request.labels.size())) {
+        throw std::invalid_argument("decode request has an invalid layout");
+    }
+
+    for (unsigned i = 0, n = request.labels.size(); i < n; ++i) {
+        const float * corners = &request.corners[8 * i];
+        float xmin = corners[0];
+        float ymin = corners[1];
+        float xmax = corners[0];
+        float ymax = corners[1];
+
+        for (unsigned c = 1; c < 4; ++c) {
+            xmin = std::min(xmin, corners[2 * c]);
+            ymin = std::min(ymin, corners[2 * c + 1]);
+            xmax = std::max(xmax, corners[2 * c]);
+            ymax = std::max(ymax, corners[2 * c + 1]);
+        }
+
+        if ((xmin < 0) || (ymin < 0) || (xmax - xmin < 1) || (ymax - ymin < 1)) {
+            throw std::invalid_argument("invalid corners for well: " + request.labels[i]);
+        }
+
+        wellRects.push_back(std::unique_ptr<const WellRectangle>(new WellRectangle(
+                request.labels[i].c_str(),
+                static_cast<unsigned>(xmin),
+                static_cast<unsigned>(ymin),
+                static_cast<unsigned>(xmax - xmin),
+                static_cast<unsigned>(ymax - ymin))));
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
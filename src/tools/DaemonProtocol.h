@@ -0,0 +1,209 @@
+#ifndef DAEMONPROTOCOL_H_
+#define DAEMONPROTOCOL_H_
+
+/*
+ * DaemonProtocol.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "decoder/WellRectangle.h"
+#include "utils/ImageRing.h"
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dmscanlib {
+
+class DecodeOptions;
+
+namespace dmscand {
+
+/**
+ * The messages exchanged by dmscand and its clients over a Unix domain socket.
+ *
+ * Every message is a frame: uint32 payload length, uint32 message type, then the
+ * payload. Values are in the native byte order, both ends are on the same host.
+ * Strings and byte arrays are a uint32 length followed by the bytes.
+ *
+ * A client sends decode requests, as many as it likes without waiting, each with
+ * an id of its choosing. For each request the daemon sends one MSG_WELL_RESULT
+ * per well, in the order of the layout, then MSG_DECODE_DONE, or MSG_ERROR
+ * alone if the request could not be decoded at all. The responses to different
+ * requests may come back in any order, but those of one request are not
+ * interleaved with others.
+ *
+ * MSG_DECODE_SLOT names an image the client has published in the daemon's
+ * util::ImageRing. The daemon frees the slot once the image is decoded. If the
+ * request fails with MSG_ERROR the slot may still be published, and the client
+ * discards it.
+ */
+enum MessageType {
+    MSG_DECODE_FILE = 1,
+    MSG_DECODE_BYTES = 2,
+    MSG_WELL_RESULT = 3,
+    MSG_DECODE_DONE = 4,
+    MSG_ERROR = 5,
+    MSG_DECODE_SLOT = 6
+};
+
+// larger frames are rejected and the connection closed
+const uint32_t MAX_FRAME_LENGTH = 256 * 1024 * 1024;
+
+/*
+ * The decode options and the profiles of their ladder, as sent on the wire.
+ */
+class ProfileSettings {
+public:
+    int32_t scale;
+    double scanGapFactor;
+    int32_t squareDev;
+    int32_t edgeThresh;
+    int32_t corrections;
+    int32_t subPixel;
+    int32_t symbolSize;
+};
+
+/*
+ * MSG_DECODE_FILE holds the path of an image file the daemon can read,
+ * MSG_DECODE_BYTES the contents of an encoded image file and MSG_DECODE_SLOT the
+ * handle of an image in shared memory. corners holds eight values per well, the
+ * (x, y) pairs of its four corners.
+ */
+class DecodeRequest {
+public:
+    DecodeRequest();
+
+    uint32_t type;
+    uint32_t requestId;
+    std::string imagePath;
+    std::vector<unsigned char> imageBytes;
+    util::ImageSlotHandle slotHandle;
+    double minEdgeFactor;
+    double maxEdgeFactor;
+    int32_t speculativeDecode;
+    std::vector<ProfileSettings> profiles;
+    std::vector<std::string> labels;
+    std::vector<float> corners;
+};
+
+class WellResponse {
+public:
+    uint32_t requestId;
+    uint32_t wellIndex;
+    int32_t decoded;
+    int32_t tier;
+    int32_t symbolSize;
+    int64_t decodeNanos;
+    int32_t quad[8];
+    std::string label;
+    std::string message;
+};
+
+class DoneResponse {
+public:
+    uint32_t requestId;
+    int32_t result;
+    uint32_t decodedWells;
+    int64_t totalNanos;
+};
+
+class ErrorResponse {
+public:
+    uint32_t requestId;
+    std::string message;
+};
+
+/*
+ * Appends values to a payload.
+ */
+class MessageWriter {
+public:
+    void putUint(uint32_t value);
+    void putInt(int32_t value);
+    void putLong(int64_t value);
+    void putFloat(float value);
+    void putDouble(double value);
+    void putString(const std::string & value);
+    void putBytes(const std::vector<unsigned char> & value);
+
+    const std::vector<unsigned char> & getPayload() const {
+        return payload;
+    }
+
+private:
+    void put(const void * value, unsigned length);
+
+    std::vector<unsigned char> payload;
+};
+
+/*
+ * Reads values from a payload. Throws std::runtime_error when the payload is
+ * shorter than the values read from it.
+ */
+class MessageReader {
+public:
+    MessageReader(const std::vector<unsigned char> & payload);
+
+    uint32_t getUint();
+    int32_t getInt();
+    int64_t getLong();
+    float getFloat();
+    double getDouble();
+    std::string getString();
+    void getBytes(std::vector<unsigned char> & value);
+
+private:
+    void get(void * value, unsigned length);
+
+    const std::vector<unsigned char> & payload;
+    unsigned offset;
+};
+
+/*
+ * Blocking frame I/O on a socket, retried on partial transfers and interrupts.
+ * Return false when the peer has gone or the frame is invalid.
+ */
+bool readFrame(int fd, uint32_t & type, std::vector<unsigned char> & payload);
+
+bool writeFrame(int fd, uint32_t type, const std::vector<unsigned char> & payload);
+
+void writeRequest(const DecodeRequest & request, MessageWriter & writer);
+
+void readRequest(uint32_t type, MessageReader & reader, DecodeRequest & request);
+
+void writeWellResponse(const WellResponse & response, MessageWriter & writer);
+
+void readWellResponse(MessageReader & reader, WellResponse & response);
+
+void writeDoneResponse(const DoneResponse & response, MessageWriter & writer);
+
+void readDoneResponse(MessageReader & reader, DoneResponse & response);
+
+void writeErrorResponse(const ErrorResponse & response, MessageWriter & writer);
+
+void readErrorResponse(MessageReader & reader, ErrorResponse & response);
+
+/*
+ * Conversions between the wire format and the library's types. Throw
+ * std::invalid_argument if the request is inconsistent.
+ */
+void setRequestOptions(const DecodeOptions & decodeOptions, DecodeRequest & request);
+
+void setRequestLayout(
+        const std::vector<std::unique_ptr<const WellRectangle> > & wellRects,
+        DecodeRequest & request);
+
+std::unique_ptr<DecodeOptions> createDecodeOptions(const DecodeRequest & request);
+
+void createWellRects(
+        const DecodeRequest & request,
+        std::vector<std::unique_ptr<const WellRectangle> > & wellRects);
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* DAEMONPROTOCOL_H_ */
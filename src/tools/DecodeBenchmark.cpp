@@ -0,0 +1,435 @@
+/*
+ * DecodeBenchmark.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/WellRectangle.h"
+#include "decoder/WellDecoder.h"
+#include "test/TestCommon.h"
+#include "test/ImageInfo.h"
+#include "utils/DmClock.h"
+
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+namespace dmscanlib {
+
+namespace test {
+
+std::string usage(
+        "Decodes the images described by the image information files in a "
+        "directory, for each thread count, and writes throughput, latency, decode "
+        "rate and peak memory as JSON. When a baseline file written by a previous "
+        "run is given, each metric is compared against it.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_string(infoDir, "testImageInfo", "directory holding the image information files.");
+DEFINE_string(threads, "1,2,4,8", "comma-separated list of decode thread counts.");
+DEFINE_int32(warmup, 1, "passes over the corpus, per thread count, that are not measured.");
+DEFINE_int32(repetitions, 3, "measured passes over the corpus, per thread count.");
+DEFINE_string(output, "benchmark.json", "file the results are written to.");
+DEFINE_string(baseline, "", "results of a previous run to compare against.");
+DEFINE_double(tolerance, 0.05, "relative change, against the baseline, reported as a regression.");
+
+class CorpusImage {
+public:
+    CorpusImage(const std::string & infoFilename) :
+            info(infoFilename)
+    {
+        if (info.isValid()) {
+            getWellRectsForBoundingBox(
+                    info.getBoundingBox(),
+                    info.getPalletRows(),
+                    info.getPalletCols(),
+                    info.getOrientation(),
+                    info.getBarcodePosition(),
+                    wellRects);
+        }
+    }
+
+    ImageInfo info;
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+};
+
+class ThreadCountResult {
+public:
+    ThreadCountResult(unsigned _threads) :
+            threads(_threads),
+            pallets(0),
+            wells(0),
+            expected(0),
+            correct(0),
+            wrong(0),
+            nanos(0)
+    {
+    }
+
+    double getPercentileMillis(double fraction) const;
+
+    const unsigned threads;
+    unsigned pallets;
+    unsigned wells;
+    unsigned expected;
+    unsigned correct;
+    unsigned wrong;
+    util::dmUint64 nanos;
+    std::vector<util::dmUint64> latencies;
+};
+
+/*
+ * Nearest rank percentile of the pallet latencies.
+ */
+double ThreadCountResult::getPercentileMillis(double fraction) const {
+    if (latencies.empty()) {
+        return 0;
+    }
+    std::vector<util::dmUint64> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+
+    unsigned rank = static_cast<unsigned>(fraction * sorted.size() + 0.999999);
+    rank = std::max(1u, std::min(rank, static_cast<unsigned>(sorted.size())));
+    return sorted[rank - 1] / 1e6;
+}
+
+class DecodeBenchmark {
+public:
+    DecodeBenchmark(const std::string & infoDir);
+
+    bool isValid() const {
+        return !images.empty();
+    }
+
+    void run(unsigned threads, unsigned warmup, unsigned repetitions);
+
+    void getMetrics(std::map<std::string, double> & metrics) const;
+
+    void writeJson(std::ostream & os) const;
+
+    static bool readBaseline(const std::string & filename, std::map<std::string, double> & metrics);
+
+    static bool isHigherBetter(const std::string & metric);
+
+private:
+    void decodeCorpus(ThreadCountResult * result);
+
+    void checkDecodedWells(DmScanLib & dmScanLib, CorpusImage & image, ThreadCountResult & result);
+
+    static long getPeakRssKb();
+
+    const std::string infoDir;
+    std::unique_ptr<DecodeOptions> decodeOptions;
+    std::vector<std::unique_ptr<CorpusImage> > images;
+    std::vector<std::unique_ptr<ThreadCountResult> > results;
+    unsigned warmup;
+    unsigned repetitions;
+};
+
+DecodeBenchmark::DecodeBenchmark(const std::string & _infoDir) :
+        infoDir(_infoDir),
+        warmup(0),
+        repetitions(0)
+{
+    // same decode options as TestDmScanLib.decodeAllImages
+    std::unique_ptr<DecodeOptions> defaultDecodeOptions = getDefaultDecodeOptions();
+    decodeOptions = std::unique_ptr<DecodeOptions>(new DecodeOptions(
+            0.2,
+            0.4,
+            0.15,
+            defaultDecodeOptions->squareDev,
+            defaultDecodeOptions->edgeThresh,
+            defaultDecodeOptions->corrections,
+            defaultDecodeOptions->shrink));
+
+    std::vector<std::string> filenames;
+    if (!getTestImageInfoFilenames(infoDir, filenames)) {
+        return;
+    }
+    std::sort(filenames.begin(), filenames.end());
+
+    for (unsigned i = 0, n = filenames.size(); i < n; ++i) {
+        std::unique_ptr<CorpusImage> image(new CorpusImage(filenames[i]));
+        if (!image->info.isValid()) {
+            std::cerr << "skipping invalid image information file: " << filenames[i] << std::endl;
+            continue;
+        }
+        images.push_back(std::move(image));
+    }
+}
+
+void DecodeBenchmark::run(unsigned threads, unsigned _warmup, unsigned _repetitions) {
+    warmup = _warmup;
+    repetitions = _repetitions;
+
+    DmScanLib::setDecodeThreadCount(threads);
+
+    for (unsigned i = 0; i < warmup; ++i) {
+        decodeCorpus(NULL);
+    }
+
+    std::unique_ptr<ThreadCountResult> result(new ThreadCountResult(threads));
+    for (unsigned i = 0; i < repetitions; ++i) {
+        decodeCorpus(result.get());
+    }
+
+    std::cerr << "threads " << threads << ": pallets/" << result->pallets
+              << " seconds/" << result->nanos / 1e9 << std::endl;
+    results.push_back(std::move(result));
+}
+
+/*
+ * Decodes every image once. The pallet latency includes loading the image, as it
+ * does for decodeImageWells() callers. Nothing is recorded when result is NULL.
+ */
+void DecodeBenchmark::decodeCorpus(ThreadCountResult * result) {
+    for (unsigned i = 0, n = images.size(); i < n; ++i) {
+        CorpusImage & image = *images[i];
+        DmScanLib dmScanLib(0);
+
+        const util::dmUint64 start = util::DmClock::nowNanos();
+        int decodeResult = dmScanLib.decodeImageWells(
+                image.info.getImageFilename().c_str(),
+                *decodeOptions,
+                image.wellRects);
+        const util::dmUint64 elapsed = util::DmClock::nowNanos() - start;
+
+        if (result == NULL) {
+            continue;
+        }
+
+        ++result->pallets;
+        result->wells += image.wellRects.size();
+        result->expected += image.info.getDecodedWellCount();
+        result->nanos += elapsed;
+        result->latencies.push_back(elapsed);
+
+        if (decodeResult == SC_SUCCESS) {
+            checkDecodedWells(dmScanLib, image, *result);
+        }
+    }
+}
+
+void DecodeBenchmark::checkDecodedWells(
+        DmScanLib & dmScanLib,
+        CorpusImage & image,
+        ThreadCountResult & result) {
+    const std::map<std::string, const WellDecoder *> & decodedWells = dmScanLib.getDecodedWells();
+    for (std::map<std::string, const WellDecoder *>::const_iterator ii = decodedWells.begin();
+            ii != decodedWells.end(); ++ii) {
+        const WellDecoder & decodedWell = *(ii->second);
+        const std::string * nfoDecodedMsg = image.info.getBarcodeMsg(decodedWell.getLabel());
+
+        if ((nfoDecodedMsg == NULL) || nfoDecodedMsg->empty()) {
+            continue;
+        }
+        if (*nfoDecodedMsg == decodedWell.getMessage()) {
+            ++result.correct;
+        } else {
+            ++result.wrong;
+        }
+    }
+}
+
+long DecodeBenchmark::getPeakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+/*
+ * The metric names are flat so that the results of two runs can be diffed, and
+ * read back by readBaseline(), line by line.
+ */
+void DecodeBenchmark::getMetrics(std::map<std::string, double> & metrics) const {
+    for (unsigned i = 0, n = results.size(); i < n; ++i) {
+        const ThreadCountResult & result = *results[i];
+        const double seconds = result.nanos / 1e9;
+
+        std::ostringstream prefix;
+        prefix << "threads_" << result.threads << ".";
+
+        metrics[prefix.str() + "pallets_per_sec"] = (seconds > 0) ? result.pallets / seconds : 0;
+        metrics[prefix.str() + "wells_per_sec"] = (seconds > 0) ? result.wells / seconds : 0;
+        metrics[prefix.str() + "latency_p50_ms"] = result.getPercentileMillis(0.50);
+        metrics[prefix.str() + "latency_p95_ms"] = result.getPercentileMillis(0.95);
+        metrics[prefix.str() + "latency_p99_ms"] = result.getPercentileMillis(0.99);
+        metrics[prefix.str() + "decode_rate"] =
+                (result.expected > 0) ? static_cast<double>(result.correct) / result.expected : 0;
+        metrics[prefix.str() + "wrong_decodes"] = result.wrong;
+    }
+    metrics["peak_rss_kb"] = static_cast<double>(getPeakRssKb());
+}
+
+void DecodeBenchmark::writeJson(std::ostream & os) const {
+    std::map<std::string, double> metrics;
+    getMetrics(metrics);
+
+    os << "{\n"
+       << "  \"corpus\": \"" << infoDir << "\",\n"
+       << "  \"images\": " << images.size() << ",\n"
+       << "  \"warmup\": " << warmup << ",\n"
+       << "  \"repetitions\": " << repetitions << ",\n"
+       << "  \"metrics\": {\n";
+
+    for (std::map<std::string, double>::const_iterator ii = metrics.begin();
+            ii != metrics.end(); ++ii) {
+        os << "    \"" << ii->first << "\": " << std::setprecision(6) << ii->second
+           << ((std::next(ii) == metrics.end()) ? "\n" : ",\n");
+    }
+    os << "  }\n}\n";
+}
+
+/*
+ * Only reads the "metrics" object, in the layout written by writeJson().
+ */
+bool DecodeBenchmark::readBaseline(
+        const std::string & filename,
+        std::map<std::string, double> & metrics) {
+    std::ifstream file(filename.c_str());
+    if (!file.is_open()) {
+        return false;
+    }
+
+    bool inMetrics = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find("\"metrics\"") != std::string::npos) {
+            inMetrics = true;
+            continue;
+        }
+        if (!inMetrics) {
+            continue;
+        }
+        if (line.find('}') != std::string::npos) {
+            break;
+        }
+
+        size_t nameStart = line.find('"');
+        size_t nameEnd = line.find('"', nameStart + 1);
+        size_t colon = line.find(':', nameEnd);
+        if ((nameStart == std::string::npos) || (nameEnd == std::string::npos)
+                || (colon == std::string::npos)) {
+            continue;
+        }
+        metrics[line.substr(nameStart + 1, nameEnd - nameStart - 1)] =
+                strtod(line.c_str() + colon + 1, NULL);
+    }
+    return true;
+}
+
+bool DecodeBenchmark::isHigherBetter(const std::string & metric) {
+    return (metric.find("_per_sec") != std::string::npos)
+            || (metric.find("decode_rate") != std::string::npos);
+}
+
+std::vector<unsigned> parseThreadCounts(const std::string & str) {
+    std::vector<unsigned> counts;
+    std::istringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int count = atoi(item.c_str());
+        if (count > 0) {
+            counts.push_back(static_cast<unsigned>(count));
+        }
+    }
+    return counts;
+}
+
+/*
+ * Returns the number of metrics that are worse than the baseline by more than the
+ * tolerance.
+ */
+unsigned compareWithBaseline(
+        const std::map<std::string, double> & metrics,
+        const std::map<std::string, double> & baseline,
+        double tolerance) {
+    unsigned regressions = 0;
+
+    for (std::map<std::string, double>::const_iterator ii = metrics.begin();
+            ii != metrics.end(); ++ii) {
+        std::map<std::string, double>::const_iterator jj = baseline.find(ii->first);
+        if ((jj == baseline.end()) || (jj->second == 0)) {
+            continue;
+        }
+
+        const double change = (ii->second - jj->second) / jj->second;
+        const bool worse = DecodeBenchmark::isHigherBetter(ii->first) ? (change < -tolerance)
+                : (change > tolerance);
+        if (worse) {
+            ++regressions;
+        }
+
+        std::cout << std::left << std::setw(36) << ii->first << std::right
+                  << std::setw(12) << jj->second << " -> " << std::setw(12) << ii->second
+                  << std::showpos << std::setw(9) << std::setprecision(3) << change * 100
+                  << std::noshowpos << std::setprecision(6) << "%"
+                  << (worse ? "  REGRESSION" : "") << std::endl;
+    }
+    return regressions;
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace test;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" [--threads=1,2,4,8] [--baseline=<FILE>]");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    std::vector<unsigned> threadCounts = parseThreadCounts(FLAGS_threads);
+    if (threadCounts.empty() || (FLAGS_warmup < 0) || (FLAGS_repetitions < 1)) {
+        std::cerr << "invalid thread counts, warmup or repetitions." << std::endl;
+        return 1;
+    }
+
+    DecodeBenchmark benchmark(FLAGS_infoDir);
+    if (!benchmark.isValid()) {
+        std::cerr << "no image information files found in: " << FLAGS_infoDir << std::endl;
+        return 1;
+    }
+
+    for (unsigned i = 0, n = threadCounts.size(); i < n; ++i) {
+        benchmark.run(threadCounts[i], FLAGS_warmup, FLAGS_repetitions);
+    }
+
+    std::ofstream output(FLAGS_output.c_str());
+    benchmark.writeJson(output);
+    if (!output.good()) {
+        std::cerr << "could not write results to: " << FLAGS_output << std::endl;
+        return 1;
+    }
+
+    if (FLAGS_baseline.empty()) {
+        return 0;
+    }
+
+    std::map<std::string, double> metrics;
+    std::map<std::string, double> baseline;
+    benchmark.getMetrics(metrics);
+    if (!DecodeBenchmark::readBaseline(FLAGS_baseline, baseline)) {
+        std::cerr << "could not read baseline: " << FLAGS_baseline << std::endl;
+        return 1;
+    }
+    return (compareWithBaseline(metrics, baseline, FLAGS_tolerance) > 0) ? 2 : 0;
+}
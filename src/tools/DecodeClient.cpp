@@ -0,0 +1,296 @@
+/*
+ * DecodeClient.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DaemonProtocol.h"
+#include "DmScanLib.h"
+#include "decoder/DecodeOptions.h"
+#include "test/TestCommon.h"
+#include "utils/ImageRing.h"
+
+#include <gflags/gflags.h>
+#include <opencv/cv.h>
+#include <opencv/highgui.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dmscanlib {
+
+namespace dmscand {
+
+std::string usage(
+        "Sends pallet images to dmscand and prints the decoded wells. All the "
+        "images are sent before the first response is read, so the daemon can "
+        "decode them side by side. The wells are laid out over the whole image, "
+        "with the default decode options of the tests. With --ring the pixels are "
+        "written to the daemon's shared memory image ring instead. Exits with 1 "
+        "when an image could not be decoded.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_string(socket, "/tmp/dmscand.sock", "path of the daemon's Unix domain socket.");
+DEFINE_int32(rows, 8, "number of tube rows in the images.");
+DEFINE_int32(cols, 12, "number of tube columns in the images.");
+DEFINE_bool(bytes, false, "send the contents of the image files instead of their paths.");
+DEFINE_string(ring, "", "shared memory image ring of the daemon, to pass the pixels through.");
+DEFINE_bool(wells, true, "print every decoded well.");
+
+int connectSocket(const std::string & path) {
+    sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("socket path is too long: " + path);
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("could not create socket: ") + strerror(errno));
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        const std::string error(strerror(errno));
+        close(fd);
+        throw std::runtime_error("could not connect to " + path + ": " + error);
+    }
+    return fd;
+}
+
+/*
+ * Keeps track of the requests sent and prints their responses.
+ */
+class Responses {
+public:
+    Responses() :
+            failed(false)
+    {
+    }
+
+    /*
+     * Reads and prints one response. Returns false if the daemon has gone.
+     */
+    bool read(int fd, util::ImageRing * ring);
+
+    std::map<uint32_t, std::string> imageNames;
+    std::map<uint32_t, util::ImageSlotHandle> slotHandles;
+    bool failed;
+
+private:
+    std::string getImageName(uint32_t requestId) const;
+
+    void finish(uint32_t requestId, util::ImageRing * ring);
+};
+
+bool Responses::read(int fd, util::ImageRing * ring) {
+    uint32_t type;
+    std::vector<unsigned char> payload;
+    if (!readFrame(fd, type, payload)) {
+        return false;
+    }
+
+    MessageReader reader(payload);
+    if (type == MSG_WELL_RESULT) {
+        WellResponse response;
+        readWellResponse(reader, response);
+        if (FLAGS_wells && response.decoded) {
+            std::cout << getImageName(response.requestId) << " "
+                      << response.label << ": " << response.message << std::endl;
+        }
+    } else if (type == MSG_DECODE_DONE) {
+        DoneResponse response;
+        readDoneResponse(reader, response);
+        std::cout << getImageName(response.requestId) << ": result "
+                  << response.result << ", " << response.decodedWells << " wells decoded in "
+                  << static_cast<double>(response.totalNanos) / 1e6 << " ms" << std::endl;
+        if (response.result != SC_SUCCESS) {
+            failed = true;
+        }
+        finish(response.requestId, ring);
+    } else if (type == MSG_ERROR) {
+        ErrorResponse response;
+        readErrorResponse(reader, response);
+        std::cerr << getImageName(response.requestId) << ": "
+                  << response.message << std::endl;
+        failed = true;
+        finish(response.requestId, ring);
+    }
+    return true;
+}
+
+std::string Responses::getImageName(uint32_t requestId) const {
+    std::map<uint32_t, std::string>::const_iterator it = imageNames.find(requestId);
+    return (it == imageNames.end()) ? "dmscand" : it->second;
+}
+
+/*
+ * A slot the daemon did not take, because the request failed, is discarded.
+ */
+void Responses::finish(uint32_t requestId, util::ImageRing * ring) {
+    std::map<uint32_t, util::ImageSlotHandle>::iterator it = slotHandles.find(requestId);
+    if (it != slotHandles.end()) {
+        ring->discard(it->second);
+        slotHandles.erase(it);
+    }
+    imageNames.erase(requestId);
+}
+
+/*
+ * Copies the pixels into a free slot of the ring, waiting for the responses
+ * to earlier images while every slot is in use.
+ */
+void publishImage(
+        const cv::Mat & image,
+        int fd,
+        util::ImageRing & ring,
+        Responses & responses,
+        util::ImageSlotHandle & handle) {
+    const unsigned stride = image.cols * image.elemSize();
+    if (static_cast<unsigned long long>(stride) * image.rows > ring.getSlotSize()) {
+        throw std::invalid_argument("image is larger than a ring slot");
+    }
+
+    while (!ring.acquire(handle)) {
+        if (responses.imageNames.empty() || !responses.read(fd, &ring)) {
+            throw std::runtime_error("no free image slot");
+        }
+    }
+
+    unsigned char * pixels = ring.getSlotPixels(handle);
+    for (int row = 0; row < image.rows; ++row) {
+        memcpy(pixels + row * stride, image.ptr(row), stride);
+    }
+    ring.publish(handle, image.cols, image.rows, stride, PIXEL_BGR24);
+}
+
+/*
+ * The daemon may run in another directory, so paths are sent absolute.
+ */
+void createRequest(
+        const std::string & filename,
+        uint32_t requestId,
+        int fd,
+        util::ImageRing * ring,
+        Responses & responses,
+        DecodeRequest & request) {
+    const cv::Mat image = cv::imread(filename,
+            (ring != NULL) ? CV_LOAD_IMAGE_COLOR : CV_LOAD_IMAGE_GRAYSCALE);
+    if (image.empty()) {
+        throw std::invalid_argument("could not load image: " + filename);
+    }
+
+    request.requestId = requestId;
+    if (ring != NULL) {
+        request.type = MSG_DECODE_SLOT;
+        publishImage(image, fd, *ring, responses, request.slotHandle);
+    } else if (FLAGS_bytes) {
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        request.type = MSG_DECODE_BYTES;
+        request.imageBytes.assign(
+                std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        char path[PATH_MAX];
+        if (realpath(filename.c_str(), path) == NULL) {
+            throw std::invalid_argument("could not resolve path: " + filename);
+        }
+        request.type = MSG_DECODE_FILE;
+        request.imagePath = path;
+    }
+
+    std::unique_ptr<DecodeOptions> decodeOptions = test::getDefaultDecodeOptions();
+    setRequestOptions(*decodeOptions, request);
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    test::getWellRectsForBoundingBox(
+            cv::Rect(0, 0, image.cols, image.rows),
+            FLAGS_rows,
+            FLAGS_cols,
+            LANDSCAPE,
+            TUBE_BOTTOMS,
+            wellRects);
+    setRequestLayout(wellRects, request);
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace dmscand;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" --socket=/tmp/dmscand.sock testImages/8x12/96tubes.bmp ...");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (argc < 2) {
+        std::cout << "image file names not specified." << std::endl;
+        return 1;
+    }
+
+    int fd;
+    std::unique_ptr<util::ImageRing> ring;
+    try {
+        fd = connectSocket(FLAGS_socket);
+        if (!FLAGS_ring.empty()) {
+            ring = util::ImageRing::open(FLAGS_ring);
+        }
+    } catch (const std::exception & ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    Responses responses;
+
+    for (int i = 1; i < argc; ++i) {
+        const uint32_t requestId = i;
+        try {
+            DecodeRequest request;
+            createRequest(argv[i], requestId, fd, ring.get(), responses, request);
+            if (ring.get() != NULL) {
+                responses.slotHandles[requestId] = request.slotHandle;
+            }
+
+            MessageWriter writer;
+            writeRequest(request, writer);
+            if (!writeFrame(fd, request.type, writer.getPayload())) {
+                std::cerr << "connection closed by the daemon" << std::endl;
+                responses.failed = true;
+                break;
+            }
+            responses.imageNames[requestId] = argv[i];
+        } catch (const std::exception & ex) {
+            std::cerr << argv[i] << ": " << ex.what() << std::endl;
+            responses.failed = true;
+        }
+    }
+
+    while (!responses.imageNames.empty() && responses.read(fd, ring.get())) {
+    }
+
+    if (!responses.imageNames.empty()) {
+        std::cerr << "connection closed with " << responses.imageNames.size()
+                  << " requests pending" << std::endl;
+        responses.failed = true;
+    }
+
+    close(fd);
+    return responses.failed ? 1 : 0;
+}
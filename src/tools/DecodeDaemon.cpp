@@ -0,0 +1,587 @@
+/*
+ * DecodeDaemon.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DaemonProtocol.h"
+#include "DecodeSession.h"
+#include "DmScanLib.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/DecodeResult.h"
+#include "decoder/ThreadMgr.h"
+#include "utils/ImageRing.h"
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <OpenThreads/Condition>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dmscanlib {
+
+namespace dmscand {
+
+std::string usage(
+        "Decodes pallet images for local clients. Keeps the decode threads and the "
+        "session started, and takes decode requests over a Unix domain socket. "
+        "Requests from all the clients are queued together and decoded a few "
+        "pallets at a time, the clients taking turns. Clients on the same host can "
+        "also pass images through a ring of shared memory slots, which the daemon "
+        "decodes in place. See src/tools/DaemonProtocol.h for the messages, and "
+        "dmscand-client for a client.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_string(socket, "/tmp/dmscand.sock", "path of the Unix domain socket.");
+DEFINE_int32(threads, 0, "decode threads shared by all the pallets, 0 uses the library default.");
+DEFINE_int32(pallets, 2, "pallets decoded at the same time.");
+DEFINE_int32(queue, 64, "pending requests, from all the clients, before new ones are refused.");
+DEFINE_int32(queueMB, 1024, "megabytes of pending requests, from all the clients, before new ones are refused.");
+DEFINE_int32(verbose, 0, "logging level.");
+DEFINE_string(ring, "/dmscand", "name of the shared memory image ring, empty for none.");
+DEFINE_int32(ringSlots, 4, "images the ring holds.");
+DEFINE_int32(ringSlotMB, 64, "size of an image slot in the ring, in megabytes.");
+
+const int POLL_MILLIS = 500;
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+/*
+ * A connected client. The responses to one request are written while holding
+ * writeMutex, so they are not interleaved with those of another request.
+ */
+class Client {
+public:
+    Client(int _fd, unsigned _id) :
+            fd(_fd),
+            id(_id)
+    {
+    }
+
+    ~Client() {
+        close(fd);
+    }
+
+    const int fd;
+    const unsigned id;
+    OpenThreads::Mutex writeMutex;
+
+private:
+    Client(const Client &);
+    Client & operator=(const Client &);
+};
+
+class PendingRequest {
+public:
+    PendingRequest() :
+            bytes(0)
+    {
+    }
+
+    std::shared_ptr<Client> client;
+    std::shared_ptr<const DecodeRequest> request;
+    // length of the request's frame
+    uint64_t bytes;
+};
+
+/*
+ * The requests waiting to be decoded. Each client has its own queue and the
+ * clients are served in turn, so one client sending many requests does not hold
+ * up the others.
+ *
+ * Both the number of requests and their total size are bounded: a frame may be
+ * up to MAX_FRAME_LENGTH, so the count alone does not bound the memory held by
+ * the queue. A request larger than the byte limit is still taken when nothing
+ * else is pending.
+ */
+class RequestQueue {
+public:
+    RequestQueue(unsigned _maxPending, uint64_t _maxPendingBytes) :
+            maxPending(_maxPending),
+            maxPendingBytes(_maxPendingBytes),
+            pendingCount(0),
+            pendingBytes(0),
+            stopped(false)
+    {
+    }
+
+    /*
+     * Returns false if the queue is full or stopped.
+     */
+    bool push(const PendingRequest & pending) {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        if (stopped || (pendingCount >= maxPending)
+                || ((pendingCount > 0) && (pendingBytes + pending.bytes > maxPendingBytes))) {
+            return false;
+        }
+
+        std::deque<PendingRequest> & clientQueue = clientQueues[pending.client->id];
+        if (clientQueue.empty()) {
+            clientOrder.push_back(pending.client->id);
+        }
+        clientQueue.push_back(pending);
+        ++pendingCount;
+        pendingBytes += pending.bytes;
+        condition.signal();
+        return true;
+    }
+
+    /*
+     * Waits for a request. Returns false once the queue is stopped.
+     */
+    bool pop(PendingRequest & pending) {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        while (!stopped && clientOrder.empty()) {
+            condition.wait(&mutex);
+        }
+        if (stopped) {
+            return false;
+        }
+
+        const unsigned clientId = clientOrder.front();
+        clientOrder.pop_front();
+        std::deque<PendingRequest> & clientQueue = clientQueues[clientId];
+        pending = clientQueue.front();
+        clientQueue.pop_front();
+        --pendingCount;
+        pendingBytes -= pending.bytes;
+
+        if (clientQueue.empty()) {
+            clientQueues.erase(clientId);
+        } else {
+            clientOrder.push_back(clientId);
+        }
+        return true;
+    }
+
+    /*
+     * Drops the requests of a client that has gone, and returns them.
+     */
+    void removeClient(unsigned clientId, std::deque<PendingRequest> & dropped) {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        std::map<unsigned, std::deque<PendingRequest> >::iterator it = clientQueues.find(clientId);
+        if (it == clientQueues.end()) {
+            return;
+        }
+        pendingCount -= it->second.size();
+        for (unsigned i = 0, n = it->second.size(); i < n; ++i) {
+            pendingBytes -= it->second[i].bytes;
+        }
+        dropped.swap(it->second);
+        clientQueues.erase(it);
+        clientOrder.erase(std::remove(clientOrder.begin(), clientOrder.end(), clientId),
+                clientOrder.end());
+    }
+
+    void stop() {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        stopped = true;
+        condition.broadcast();
+    }
+
+private:
+    const unsigned maxPending;
+    const uint64_t maxPendingBytes;
+    unsigned pendingCount;
+    uint64_t pendingBytes;
+    bool stopped;
+    std::map<unsigned, std::deque<PendingRequest> > clientQueues;
+    std::deque<unsigned> clientOrder;
+    OpenThreads::Mutex mutex;
+    OpenThreads::Condition condition;
+};
+
+void sendError(Client & client, uint32_t requestId, const std::string & message) {
+    ErrorResponse response;
+    response.requestId = requestId;
+    response.message = message;
+
+    MessageWriter writer;
+    writeErrorResponse(response, writer);
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(client.writeMutex);
+    writeFrame(client.fd, MSG_ERROR, writer.getPayload());
+}
+
+void sendResult(Client & client, uint32_t requestId, const DecodeResult & result) {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(client.writeMutex);
+
+    const std::vector<std::unique_ptr<const WellResult> > & wells = result.getWells();
+    for (unsigned i = 0, n = wells.size(); i < n; ++i) {
+        const WellResult & well = *wells[i];
+
+        WellResponse response;
+        response.requestId = requestId;
+        response.wellIndex = i;
+        response.decoded = well.message.empty() ? 0 : 1;
+        response.tier = well.tier;
+        response.symbolSize = well.symbolSize;
+        response.decodeNanos = static_cast<int64_t>(well.decodeNanos);
+        for (unsigned c = 0; c < 4; ++c) {
+            const bool hasQuad = (well.decodedQuad.size() == 4);
+            response.quad[2 * c] = hasQuad ? well.decodedQuad[c].x : 0;
+            response.quad[2 * c + 1] = hasQuad ? well.decodedQuad[c].y : 0;
+        }
+        response.label = well.label;
+        response.message = well.message;
+
+        MessageWriter writer;
+        writeWellResponse(response, writer);
+        if (!writeFrame(client.fd, MSG_WELL_RESULT, writer.getPayload())) {
+            // the client has gone
+            return;
+        }
+    }
+
+    DoneResponse done;
+    done.requestId = requestId;
+    done.result = result.getResult();
+    done.decodedWells = result.getDecodedWellCount();
+    done.totalNanos = static_cast<int64_t>(result.getTotalNanos());
+
+    MessageWriter writer;
+    writeDoneResponse(done, writer);
+    writeFrame(client.fd, MSG_DECODE_DONE, writer.getPayload());
+}
+
+/*
+ * Takes requests off the queue and decodes them. The session's decode() is
+ * reentrant, so the dispatchers share it, and its learned prior, while their
+ * wells share the library's worker pool.
+ */
+class Dispatcher : public OpenThreads::Thread {
+public:
+    Dispatcher(DecodeSession & _session, RequestQueue & _queue, util::ImageRing * _ring) :
+            session(_session),
+            queue(_queue),
+            ring(_ring)
+    {
+    }
+
+    void run() {
+        PendingRequest pending;
+        while (queue.pop(pending)) {
+            decode(*pending.client, *pending.request);
+            pending.client.reset();
+            pending.request.reset();
+        }
+    }
+
+private:
+    void decode(Client & client, const DecodeRequest & request) {
+        try {
+            std::unique_ptr<DecodeOptions> decodeOptions = createDecodeOptions(request);
+            std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+            createWellRects(request, wellRects);
+
+            std::unique_ptr<const DecodeResult> result;
+            if (request.type == MSG_DECODE_FILE) {
+                result = session.decode(request.imagePath.c_str(), *decodeOptions, wellRects);
+            } else if (request.type == MSG_DECODE_SLOT) {
+                result = decodeSlot(request.slotHandle, *decodeOptions, wellRects);
+            } else if (!request.imageBytes.empty()) {
+                result = session.decode(&request.imageBytes[0], request.imageBytes.size(),
+                        *decodeOptions, wellRects);
+            } else {
+                throw std::invalid_argument("decode request has no image");
+            }
+
+            VLOG(1) << "client " << client.id << " request " << request.requestId
+                    << ": " << result->getDecodedWellCount() << " wells decoded";
+            sendResult(client, request.requestId, *result);
+        } catch (const std::exception & ex) {
+            LOG(WARNING) << "client " << client.id << " request " << request.requestId
+                         << ": " << ex.what();
+            sendError(client, request.requestId, ex.what());
+        }
+    }
+
+    /*
+     * The decoder wraps the slot's pixels without copying them. The slot is freed
+     * as soon as the decode returns, before the results are sent.
+     */
+    std::unique_ptr<const DecodeResult> decodeSlot(
+            const util::ImageSlotHandle & handle,
+            const DecodeOptions & decodeOptions,
+            std::vector<std::unique_ptr<const WellRectangle> > & wellRects) {
+        std::unique_ptr<util::ImageSlot> slot;
+        if (ring != NULL) {
+            slot = ring->take(handle);
+        }
+        if (slot.get() == NULL) {
+            throw std::invalid_argument("image slot is not published");
+        }
+        return session.decode(slot->getPixels(), slot->width, slot->height, slot->stride,
+                slot->format, decodeOptions, wellRects);
+    }
+
+    DecodeSession & session;
+    RequestQueue & queue;
+    util::ImageRing * ring;
+};
+
+/*
+ * Reads the requests of one client and queues them. When the client goes, the
+ * requests it still has in the queue are dropped and their image slots freed.
+ */
+class ClientReader : public OpenThreads::Thread {
+public:
+    ClientReader(
+            const std::shared_ptr<Client> & _client,
+            RequestQueue & _queue,
+            util::ImageRing * _ring) :
+            client(_client),
+            queue(_queue),
+            ring(_ring),
+            finished(false)
+    {
+    }
+
+    void run() {
+        uint32_t type;
+        std::vector<unsigned char> payload;
+
+        while (readFrame(client->fd, type, payload)) {
+            if ((type != MSG_DECODE_FILE) && (type != MSG_DECODE_BYTES)
+                    && (type != MSG_DECODE_SLOT)) {
+                sendError(*client, 0, "unexpected message type");
+                break;
+            }
+
+            std::shared_ptr<DecodeRequest> request(new DecodeRequest());
+            try {
+                MessageReader reader(payload);
+                readRequest(type, reader, *request);
+            } catch (const std::exception & ex) {
+                sendError(*client, 0, ex.what());
+                break;
+            }
+
+            PendingRequest pending;
+            pending.client = client;
+            pending.request = request;
+            pending.bytes = payload.size();
+            if (!queue.push(pending)) {
+                sendError(*client, request->requestId, "too many pending requests");
+            }
+        }
+
+        VLOG(1) << "client " << client->id << " disconnected";
+        std::deque<PendingRequest> dropped;
+        queue.removeClient(client->id, dropped);
+        for (unsigned i = 0, n = dropped.size(); i < n; ++i) {
+            if ((ring != NULL) && (dropped[i].request->type == MSG_DECODE_SLOT)) {
+                ring->discard(dropped[i].request->slotHandle);
+            }
+        }
+        finished = true;
+    }
+
+    /*
+     * Closes the connection, so that run() returns.
+     */
+    void disconnect() {
+        shutdown(client->fd, SHUT_RDWR);
+    }
+
+    bool isFinished() const {
+        return finished;
+    }
+
+private:
+    std::shared_ptr<Client> client;
+    RequestQueue & queue;
+    util::ImageRing * ring;
+    std::atomic<bool> finished;
+};
+
+int openSocket(const std::string & path) {
+    sockaddr_un address;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("socket path is too long: " + path);
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("could not create socket: ") + strerror(errno));
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    unlink(path.c_str());
+    if ((bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+            || (listen(fd, SOMAXCONN) != 0)) {
+        const std::string error(strerror(errno));
+        close(fd);
+        throw std::runtime_error("could not listen on " + path + ": " + error);
+    }
+    return fd;
+}
+
+/*
+ * Decodes a blank image with one well per thread, so that the worker pool and
+ * OpenCV are started before the first client request.
+ */
+void warmUp(DecodeSession & session, unsigned wellCount) {
+    const unsigned wellSize = 64;
+    const unsigned width = wellSize * wellCount;
+    std::vector<unsigned char> pixels(width * wellSize, 255);
+
+    std::vector<std::unique_ptr<const DecodeProfile> > profiles;
+    profiles.push_back(std::unique_ptr<const DecodeProfile>(
+            new DecodeProfile(1, 0.1, 15, 5, 10)));
+    DecodeOptions decodeOptions(0.2, 0.3, profiles);
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    for (unsigned i = 0; i < wellCount; ++i) {
+        const std::string label = "W" + std::to_string(i + 1);
+        wellRects.push_back(std::unique_ptr<const WellRectangle>(
+                new WellRectangle(label.c_str(), i * wellSize, 0, wellSize, wellSize)));
+    }
+
+    session.decode(&pixels[0], width, wellSize, width, PIXEL_GRAY8, decodeOptions, wellRects);
+}
+
+void serve(int listenFd, RequestQueue & queue, util::ImageRing * ring) {
+    std::list<std::unique_ptr<ClientReader> > readers;
+    unsigned nextClientId = 1;
+
+    while (!stopRequested) {
+        pollfd pfd;
+        pfd.fd = listenFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        const int ready = poll(&pfd, 1, POLL_MILLIS);
+        if (ready <= 0) {
+            if ((ready < 0) && (errno != EINTR)) {
+                LOG(ERROR) << "poll failed: " << strerror(errno);
+                break;
+            }
+            continue;
+        }
+
+        const int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+
+        std::shared_ptr<Client> client(new Client(fd, nextClientId++));
+        VLOG(1) << "client " << client->id << " connected";
+        readers.push_back(std::unique_ptr<ClientReader>(new ClientReader(client, queue, ring)));
+        readers.back()->start();
+
+        for (std::list<std::unique_ptr<ClientReader> >::iterator it = readers.begin();
+                it != readers.end();) {
+            if ((*it)->isFinished()) {
+                (*it)->join();
+                it = readers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (std::list<std::unique_ptr<ClientReader> >::iterator it = readers.begin();
+            it != readers.end(); ++it) {
+        (*it)->disconnect();
+        (*it)->join();
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace dmscand;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" --socket=/tmp/dmscand.sock --pallets=2");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if ((FLAGS_pallets < 1) || (FLAGS_queue < 1) || (FLAGS_queueMB < 1) || (FLAGS_threads < 0)
+            || (FLAGS_ringSlotMB < 1) || (FLAGS_ringSlotMB > 4095)) {
+        std::cerr << "pallets, queue and queueMB must be at least 1, threads at least 0, "
+                  << "ringSlotMB from 1 to 4095." << std::endl;
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    unsigned threadCount = decoder::ThreadMgr::DEFAULT_THREAD_NUM;
+    if (FLAGS_threads > 0) {
+        threadCount = FLAGS_threads;
+        DmScanLib::setDecodeThreadCount(threadCount);
+    }
+
+    DecodeSession session(FLAGS_verbose);
+    warmUp(session, threadCount);
+
+    int listenFd;
+    std::unique_ptr<util::ImageRing> ring;
+    try {
+        if (!FLAGS_ring.empty()) {
+            // 4095 MB still fits in 32 bits, but not in a signed int
+            ring = util::ImageRing::create(FLAGS_ring, FLAGS_ringSlots,
+                    static_cast<unsigned>(FLAGS_ringSlotMB) << 20);
+        }
+        listenFd = openSocket(FLAGS_socket);
+    } catch (const std::exception & ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    LOG(INFO) << "listening on " << FLAGS_socket;
+
+    RequestQueue queue(FLAGS_queue, static_cast<uint64_t>(FLAGS_queueMB) << 20);
+    std::vector<std::unique_ptr<Dispatcher> > dispatchers;
+    for (int i = 0; i < FLAGS_pallets; ++i) {
+        dispatchers.push_back(std::unique_ptr<Dispatcher>(new Dispatcher(session, queue, ring.get())));
+        dispatchers.back()->start();
+    }
+
+    serve(listenFd, queue, ring.get());
+
+    queue.stop();
+    for (unsigned i = 0, n = dispatchers.size(); i < n; ++i) {
+        dispatchers[i]->join();
+    }
+
+    close(listenFd);
+    unlink(FLAGS_socket.c_str());
+    LOG(INFO) << "stopped";
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * DecodeReplay.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "CaptureReplay.h"
+#include "decoder/DecodeReport.h"
+
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace dmscanlib {
+
+namespace test {
+
+std::string usage(
+        "Decodes the images recorded in decode capture files again, with the "
+        "captured decode options and well rectangles, and compares the decoded "
+        "messages and the timings against the captured ones. Exits with 1 when "
+        "the messages differ and with 2 when a decode is slower than the "
+        "tolerance allows.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_int32(repetitions, 3, "decodes per capture, the median time is compared.");
+DEFINE_int32(threads, 0, "decode thread count, 0 uses the captured one.");
+DEFINE_double(tolerance, 0.2, "relative slowdown, against the capture, reported as a regression.");
+
+double toMillis(util::dmUint64 nanos) {
+    return static_cast<double>(nanos) / 1e6;
+}
+
+void printComparison(const Capture & capture, const ReplayResult & replayResult) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "  result " << capture.result << " -> " << replayResult.result
+              << ", wells same/" << replayResult.same
+              << " changed/" << replayResult.changed
+              << " gained/" << replayResult.gained
+              << " lost/" << replayResult.lost << std::endl;
+
+    std::cout << "  total " << toMillis(capture.totalNanos) << " ms -> "
+              << toMillis(replayResult.totalNanos) << " ms" << std::endl;
+    for (unsigned i = 0; i < STAGE_MAX; ++i) {
+        if ((capture.stageNanos[i] == 0) && (replayResult.stageNanos[i] == 0)) {
+            continue;
+        }
+        std::cout << "  " << std::setw(16) << std::left
+                  << DecodeReport::getStageName(static_cast<DecodeStage>(i)) << std::right
+                  << toMillis(capture.stageNanos[i]) << " ms -> "
+                  << toMillis(replayResult.stageNanos[i]) << " ms" << std::endl;
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace test;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" captures/capture-20261018-101500-0001.cap ...");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    if (argc < 2) {
+        std::cout << "capture file names not specified." << std::endl;
+        return 1;
+    }
+
+    const unsigned repetitions = static_cast<unsigned>(std::max(1, FLAGS_repetitions));
+    bool resultsDiffer = false;
+    bool slower = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::cout << argv[i] << std::endl;
+        try {
+            Capture capture(argv[i]);
+            ReplayResult replayResult;
+            replay(capture, repetitions,
+                    static_cast<unsigned>(std::max(0, FLAGS_threads)), replayResult);
+            printComparison(capture, replayResult);
+
+            if ((replayResult.result != capture.result) || !replayResult.resultsMatch()) {
+                resultsDiffer = true;
+            }
+            if (replayResult.totalNanos > capture.totalNanos * (1.0 + FLAGS_tolerance)) {
+                std::cout << "  REGRESSION: slower than the capture" << std::endl;
+                slower = true;
+            }
+        } catch (const std::exception & ex) {
+            std::cerr << "  " << ex.what() << std::endl;
+            resultsDiffer = true;
+        }
+    }
+
+    if (resultsDiffer) {
+        return 1;
+    }
+    return slower ? 2 : 0;
+}
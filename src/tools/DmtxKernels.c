@@ -0,0 +1,189 @@
+/*
+ * DmtxKernels.c
+ *
+ *  Created on: 2026-10-18
+ *
+ * Built as part of the libdmtx unity build so that its static functions can be
+ * timed in isolation.
+ */
+
+#include "dmtx.c"
+#include "DmtxKernels.h"
+
+/**
+ * \brief  Find the first region in the decode's image and prepare the kernel inputs
+ * \param  dec Decode over a well crop, its cache is reset
+ * \return Fixture, or NULL if no region was found or its modules could not be read
+ */
+extern DmtxKernelFixture *
+dmtxKernelFixtureCreate(DmtxDecode *dec)
+{
+   int i, width, height;
+   DmtxRegion *reg;
+   DmtxMessage *msg;
+   DmtxVector2 corners[4];
+   DmtxKernelFixture *fixture;
+
+   reg = dmtxRegionFindNext(dec, NULL);
+   if(reg == NULL)
+      return NULL;
+
+   fixture = (DmtxKernelFixture *)calloc(1, sizeof(DmtxKernelFixture));
+   if(fixture == NULL) {
+      dmtxRegionDestroy(&reg);
+      return NULL;
+   }
+   fixture->dec = dec;
+   fixture->reg = *reg;
+   dmtxRegionDestroy(&reg);
+
+   msg = dmtxDecodeMatrixRegionPopulate(dec, &fixture->reg);
+   if(msg == NULL) {
+      free(fixture);
+      return NULL;
+   }
+   ModulePlacementEcc200(msg->array, msg->code, fixture->reg.sizeIdx,
+         DmtxModuleOnRed | DmtxModuleOnGreen | DmtxModuleOnBlue);
+
+   fixture->codeSize = (int)msg->codeSize;
+   fixture->code = (unsigned char *)malloc(msg->codeSize);
+   fixture->scratch = (unsigned char *)malloc(msg->codeSize);
+   fixture->colors = (int *)malloc(fixture->reg.symbolCols * sizeof(int));
+   if(fixture->code == NULL || fixture->scratch == NULL || fixture->colors == NULL) {
+      dmtxMessageDestroy(&msg);
+      dmtxKernelFixtureDestroy(&fixture);
+      return NULL;
+   }
+   memcpy(fixture->code, msg->code, msg->codeSize);
+   dmtxMessageDestroy(&msg);
+
+   /* Same quadrilateral as dmtxDecodeMatrixRegionFinish() fills */
+   corners[0].X = corners[3].X = corners[0].Y = corners[1].Y = -0.1;
+   corners[1].X = corners[2].X = corners[3].Y = corners[2].Y = 1.1;
+   for(i = 0; i < 4; i++) {
+      dmtxMatrix3VMultiplyBy(&corners[i], fixture->reg.fit2raw);
+      fixture->quad[i].X = (int)(0.5 + corners[i].X);
+      fixture->quad[i].Y = (int)(0.5 + corners[i].Y);
+   }
+
+   /* A fresh trail along the first edge, for FindBestSolidLine() */
+   width = dmtxDecodeGetProp(dec, DmtxPropWidth);
+   height = dmtxDecodeGetProp(dec, DmtxPropHeight);
+   memset(dec->cache, 0x00, width * height);
+   if(TrailBlazeContinuous(dec, &fixture->trail, fixture->reg.flowBegin,
+         DmtxUndefined) == DmtxFail) {
+      dmtxKernelFixtureDestroy(&fixture);
+      return NULL;
+   }
+
+   return fixture;
+}
+
+/**
+ * \brief  Free a fixture, the decode it was created from is not destroyed
+ * \param  fixture
+ * \return void
+ */
+extern void
+dmtxKernelFixtureDestroy(DmtxKernelFixture **fixture)
+{
+   if(fixture == NULL || *fixture == NULL)
+      return;
+
+   free((*fixture)->code);
+   free((*fixture)->scratch);
+   free((*fixture)->colors);
+   free(*fixture);
+   *fixture = NULL;
+}
+
+extern int
+dmtxKernelGetPointFlow(DmtxKernelFixture *fixture)
+{
+   return GetPointFlow(fixture->dec, fixture->reg.flowBegin.plane,
+         fixture->reg.flowBegin.loc, dmtxNeighborNone).mag;
+}
+
+extern int
+dmtxKernelSeekEdge(DmtxKernelFixture *fixture)
+{
+   return MatrixRegionSeekEdge(fixture->dec, fixture->reg.flowBegin.loc).mag;
+}
+
+extern int
+dmtxKernelFindBestSolidLine(DmtxKernelFixture *fixture)
+{
+   return FindBestSolidLine(fixture->dec, &fixture->trail, 0, 0, +1, DmtxUndefined).mag;
+}
+
+/**
+ * Only sets bits that are already set after the first call, so the trail used
+ * by dmtxKernelFindBestSolidLine() is left as it was.
+ */
+extern void
+dmtxKernelCacheFillQuad(DmtxKernelFixture *fixture)
+{
+   CacheFillQuad(fixture->dec, fixture->quad[0], fixture->quad[1],
+         fixture->quad[2], fixture->quad[3]);
+}
+
+/**
+ * \brief  Read the colors of every module in the region, row by row, as
+ *         PopulateArrayFromMatrix() does
+ */
+extern void
+dmtxKernelReadModuleColors(DmtxKernelFixture *fixture)
+{
+   int row;
+   DmtxRegion *reg = &fixture->reg;
+
+   for(row = 0; row < reg->symbolRows; row++)
+      ReadModuleColorLine(fixture->dec, reg, row, 0, DmtxDirRight, reg->symbolCols,
+            reg->sizeIdx, reg->flowBegin.plane, fixture->dec->subPixel, fixture->colors);
+}
+
+/**
+ * \brief  Correct a copy of the fixture's codewords
+ * \param  fixture
+ * \param  errors Number of codewords to corrupt before correcting
+ * \return DmtxPass | DmtxFail
+ */
+extern DmtxPassFail
+dmtxKernelRsDecode(DmtxKernelFixture *fixture, int errors)
+{
+   int i;
+
+   memcpy(fixture->scratch, fixture->code, fixture->codeSize);
+   for(i = 0; i < errors; i++)
+      fixture->scratch[(i * 7) % fixture->codeSize] ^= 0x5a;
+
+   return RsDecode(fixture->scratch, NULL, fixture->reg.sizeIdx, DmtxUndefined, NULL);
+}
+
+/**
+ * \brief  Fill in the error codewords of a message whose data codewords are set
+ * \param  msg
+ * \param  sizeIdx
+ * \return DmtxPass | DmtxFail
+ */
+extern DmtxPassFail
+dmtxKernelRsEncode(DmtxMessage *msg, int sizeIdx)
+{
+   return RsEncode(msg, sizeIdx);
+}
+
+/**
+ * \brief  Correct codewords in place, as dmtxDecodeMatrixRegionFinish() does
+ * \param  code Data and error codewords in symbol order
+ * \param  unsure Number of unsure modules in each codeword, or NULL
+ * \param  sizeIdx
+ * \param  fix
+ * \param  corrected Set to the number of codewords repaired, or NULL
+ * \return DmtxPass | DmtxFail
+ */
+extern DmtxPassFail
+dmtxKernelRsDecodeCodewords(unsigned char *code, const unsigned char *unsure,
+      int sizeIdx, int fix, int *corrected)
+{
+   return RsDecode(code, unsure, sizeIdx, fix, corrected);
+}
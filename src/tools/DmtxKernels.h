@@ -0,0 +1,53 @@
+#ifndef DMTXKERNELS_H_
+#define DMTXKERNELS_H_
+
+/*
+ * DmtxKernels.h
+ *
+ *  Created on: 2026-10-18
+ *
+ * Entry points into the static libdmtx kernels for KernelBenchmark and the
+ * Reed-Solomon tests. DmtxKernels.c includes the libdmtx sources, so a program
+ * using it must not also link dmtx.c.
+ */
+
+#include <dmtx.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct DmtxKernelFixture
+ * @brief Inputs for the kernels, taken from the first region found in a well crop
+ */
+typedef struct DmtxKernelFixture_struct {
+   DmtxDecode     *dec;
+   DmtxRegion      reg;        /* Region found in the crop */
+   DmtxRegion      trail;      /* Trail blazed along the region's first edge */
+   DmtxPixelLoc    quad[4];    /* Pixel corners of the region, as filled in the cache */
+   unsigned char  *code;       /* Codewords read from the region */
+   unsigned char  *scratch;    /* Copy of the codewords that RsDecode() corrects */
+   int            *colors;     /* One row of module colors */
+   int             codeSize;
+} DmtxKernelFixture;
+
+extern DmtxKernelFixture *dmtxKernelFixtureCreate(DmtxDecode *dec);
+extern void dmtxKernelFixtureDestroy(DmtxKernelFixture **fixture);
+
+extern int dmtxKernelGetPointFlow(DmtxKernelFixture *fixture);
+extern int dmtxKernelSeekEdge(DmtxKernelFixture *fixture);
+extern int dmtxKernelFindBestSolidLine(DmtxKernelFixture *fixture);
+extern void dmtxKernelCacheFillQuad(DmtxKernelFixture *fixture);
+extern void dmtxKernelReadModuleColors(DmtxKernelFixture *fixture);
+extern DmtxPassFail dmtxKernelRsDecode(DmtxKernelFixture *fixture, int errors);
+
+extern DmtxPassFail dmtxKernelRsEncode(DmtxMessage *msg, int sizeIdx);
+extern DmtxPassFail dmtxKernelRsDecodeCodewords(unsigned char *code,
+      const unsigned char *unsure, int sizeIdx, int fix, int *corrected);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DMTXKERNELS_H_ */
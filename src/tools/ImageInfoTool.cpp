@@ -37,45 +37,6 @@ DEFINE_string(position, "bottom", "where the barcodes are on a tube: \"top\", \"
 DEFINE_string(palletSize, "8x12", "comma-seperated list of pallet sizes. "
 		"Valid sizes are \"8x12\", \"10x10\", \"12x12\", \"9x9\", and \"1x1\"");
 
-class ImageInfoWriter : public ImageInfo {
-public:
-    ImageInfoWriter(
-            const std::string & _imageFilename,
-            const cv::Rect & _boundingBox,
-            Orientation _orientation,
-            BarcodePosition _barcodePosition,
-            PalletSize _palletSize)  :
-                ImageInfo()
-    {
-        filename.assign("");
-        imageFilename.assign(_imageFilename);
-        fileValid = true;
-        boundingBox = std::unique_ptr<const cv::Rect>(new cv::Rect(_boundingBox));
-        orientation = _orientation;
-        barcodePosition = _barcodePosition;
-        palletSize = _palletSize;
-        decodedWellCount = 0;
-
-        switch (palletSize) {
-        case PSIZE_8x12: palletRows = 8; palletCols = 12; break;
-        case PSIZE_10x10: palletRows = 10; palletCols = 10; break;
-        case PSIZE_12x12: palletRows = 12; palletCols = 12; break;
-        case PSIZE_9x9: palletRows = 9; palletCols = 9; break;
-        case PSIZE_1x1: palletRows = 1; palletCols = 1; break;
-        default:
-            throw std::logic_error("invalid pallet size");
-        }
-
-    }
-
-    const void setBarcodeMsg(
-            const std::string & label,
-            const std::string & decodedMessage) {
-        wells.insert(std::make_pair(label, decodedMessage));
-    }
-
-};
-
 class ImageInfoTool {
 public:
 	ImageInfoTool(
@@ -165,7 +126,8 @@ void ImageInfoTool::generateWells() {
             boundingBox,
             orientation,
             position,
-            palletSize);
+            RowColsForPalletSize[palletSize].first,
+            RowColsForPalletSize[palletSize].second);
 
     const std::string empty;
 
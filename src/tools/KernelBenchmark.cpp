@@ -0,0 +1,366 @@
+/*
+ * KernelBenchmark.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+#include "Image.h"
+#include "decoder/DecodeOptions.h"
+#include "decoder/DecodeProfile.h"
+#include "decoder/WellRectangle.h"
+#include "test/TestCommon.h"
+#include "test/ImageInfo.h"
+#include "tools/DmtxKernels.h"
+#include "utils/DmClock.h"
+
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+/*
+ * Every heap allocation made by the process, including the ones made by libdmtx
+ * and OpenCV, goes through these. glibc only.
+ */
+namespace {
+
+std::atomic<bool> countAllocations(false);
+std::atomic<unsigned long long> allocationCount(0);
+std::atomic<unsigned long long> allocationBytes(0);
+
+inline void recordAllocation(size_t size) {
+    if (countAllocations.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+} /* namespace */
+
+extern "C" {
+
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+
+void * malloc(size_t size) {
+    recordAllocation(size);
+    return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size) {
+    recordAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size) {
+    recordAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void ** ptr, size_t alignment, size_t size) {
+    recordAllocation(size);
+    *ptr = __libc_memalign(alignment, size);
+    return (*ptr == NULL) ? 12 /* ENOMEM */ : 0;
+}
+
+} /* extern "C" */
+
+namespace dmscanlib {
+
+namespace test {
+
+std::string usage(
+        "Times the libdmtx and Image kernels on a well cropped from a corpus image, "
+        "and reports ns/op, bytes/op and allocations/op.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_string(info, "testImageInfo/8x12/96tubes.nfo", "image information file of the pallet.");
+DEFINE_string(well, "A1", "label of the well the libdmtx kernels run on.");
+DEFINE_string(filter, "", "only run the kernels whose name contains this string.");
+DEFINE_int32(minMillis, 200, "minimum measured time for each kernel.");
+DEFINE_string(output, "", "file the results are also written to, as JSON.");
+
+/*
+ * Inputs shared by the kernels. The pallet is grayscaled and filtered the way
+ * Decoder does it, and the well crop is taken from the filtered image.
+ */
+class KernelInputs {
+public:
+    KernelInputs() : dmtxImage(NULL), dec(NULL), fixture(NULL) {}
+
+    ~KernelInputs() {
+        dmtxKernelFixtureDestroy(&fixture);
+        if (dec != NULL) {
+            dmtxDecodeDestroy(&dec);
+        }
+        if (dmtxImage != NULL) {
+            dmtxImageDestroy(&dmtxImage);
+        }
+    }
+
+    bool load(const std::string & infoFilename, const std::string & label);
+
+    std::unique_ptr<Image> pallet;
+    Image grayscale;
+    Image filtered;
+    cv::Rect wellRect;
+    std::unique_ptr<const Image> well;
+    DmtxImage * dmtxImage;
+    DmtxDecode * dec;
+    DmtxKernelFixture * fixture;
+};
+
+bool KernelInputs::load(const std::string & infoFilename, const std::string & label) {
+    ImageInfo info(infoFilename);
+    if (!info.isValid()) {
+        std::cerr << "invalid image information file: " << infoFilename << std::endl;
+        return false;
+    }
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    getWellRectsForBoundingBox(
+            info.getBoundingBox(),
+            info.getPalletRows(),
+            info.getPalletCols(),
+            info.getOrientation(),
+            info.getBarcodePosition(),
+            wellRects);
+
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        if (wellRects[i]->getLabel() == label) {
+            wellRect = wellRects[i]->getRectangle();
+        }
+    }
+    if (wellRect.area() == 0) {
+        std::cerr << "no well labelled " << label << " in " << infoFilename << std::endl;
+        return false;
+    }
+
+    pallet = std::unique_ptr<Image>(new Image(info.getImageFilename()));
+    if (!pallet->isValid()) {
+        std::cerr << "could not load image: " << info.getImageFilename() << std::endl;
+        return false;
+    }
+    pallet->grayscale(grayscale);
+    grayscale.applyFilters(filtered);
+    well = filtered.crop(wellRect.x, wellRect.y, wellRect.width, wellRect.height);
+
+    // same properties as Decoder::createDmtxDecode() with the default options
+    std::unique_ptr<DecodeOptions> decodeOptions = getDefaultDecodeOptions();
+    const DecodeProfile & profile = *decodeOptions->getProfiles()[0];
+    const int mindim = std::min(wellRect.width, wellRect.height);
+
+    dmtxImage = well->dmtxImage();
+    dec = dmtxDecodeCreate(dmtxImage, profile.scale);
+    dmtxDecodeSetProp(dec, DmtxPropEdgeMin, static_cast<int>(decodeOptions->minEdgeFactor * mindim));
+    dmtxDecodeSetProp(dec, DmtxPropEdgeMax, static_cast<int>(decodeOptions->maxEdgeFactor * mindim));
+    dmtxDecodeSetProp(dec, DmtxPropScanGap, static_cast<int>(profile.scanGapFactor * mindim));
+    dmtxDecodeSetProp(dec, DmtxPropSymbolSize, DmtxSymbolSquareAuto);
+    dmtxDecodeSetProp(dec, DmtxPropSquareDevn, profile.squareDev);
+    dmtxDecodeSetProp(dec, DmtxPropEdgeThresh, profile.edgeThresh);
+    dmtxDecodeSetProp(dec, DmtxPropSubPixel, profile.subPixel ? 1 : 0);
+
+    fixture = dmtxKernelFixtureCreate(dec);
+    if (fixture == NULL) {
+        std::cerr << "no barcode region found in well " << label << std::endl;
+        return false;
+    }
+    return true;
+}
+
+typedef void (*KernelFunc)(KernelInputs & inputs);
+
+struct Kernel {
+    const char * name;
+    KernelFunc func;
+};
+
+// results are accumulated so the calls cannot be optimized away
+volatile int kernelSink = 0;
+
+void runGetPointFlow(KernelInputs & inputs) {
+    kernelSink += dmtxKernelGetPointFlow(inputs.fixture);
+}
+
+void runSeekEdge(KernelInputs & inputs) {
+    kernelSink += dmtxKernelSeekEdge(inputs.fixture);
+}
+
+void runFindBestSolidLine(KernelInputs & inputs) {
+    kernelSink += dmtxKernelFindBestSolidLine(inputs.fixture);
+}
+
+void runCacheFillQuad(KernelInputs & inputs) {
+    dmtxKernelCacheFillQuad(inputs.fixture);
+}
+
+void runReadModuleColors(KernelInputs & inputs) {
+    dmtxKernelReadModuleColors(inputs.fixture);
+    kernelSink += inputs.fixture->colors[0];
+}
+
+void runRsDecode(KernelInputs & inputs) {
+    kernelSink += dmtxKernelRsDecode(inputs.fixture, 0);
+}
+
+void runRsDecodeErrors(KernelInputs & inputs) {
+    kernelSink += dmtxKernelRsDecode(inputs.fixture, 2);
+}
+
+void runDecodeCreateDestroy(KernelInputs & inputs) {
+    DmtxDecode * dec = dmtxDecodeCreate(inputs.dmtxImage, 1);
+    dmtxDecodeDestroy(&dec);
+}
+
+void runGrayscale(KernelInputs & inputs) {
+    Image grayscale;
+    inputs.pallet->grayscale(grayscale);
+}
+
+void runApplyFilters(KernelInputs & inputs) {
+    Image filtered;
+    inputs.grayscale.applyFilters(filtered);
+}
+
+void runCrop(KernelInputs & inputs) {
+    const cv::Rect & rect = inputs.wellRect;
+    std::unique_ptr<const Image> well = inputs.filtered.crop(rect.x, rect.y, rect.width, rect.height);
+}
+
+// CacheFillQuad() last, it marks the cache the other kernels read
+const Kernel KERNELS[] = {
+        { "GetPointFlow", runGetPointFlow },
+        { "MatrixRegionSeekEdge", runSeekEdge },
+        { "FindBestSolidLine", runFindBestSolidLine },
+        { "ReadModuleColorLine", runReadModuleColors },
+        { "RsDecode", runRsDecode },
+        { "RsDecode_2errors", runRsDecodeErrors },
+        { "dmtxDecodeCreateDestroy", runDecodeCreateDestroy },
+        { "Image_grayscale", runGrayscale },
+        { "Image_applyFilters", runApplyFilters },
+        { "Image_crop", runCrop },
+        { "CacheFillQuad", runCacheFillQuad },
+};
+
+struct KernelResult {
+    const char * name;
+    unsigned long long iterations;
+    double nanosPerOp;
+    double bytesPerOp;
+    double allocationsPerOp;
+};
+
+util::dmUint64 timeIterations(const Kernel & kernel, KernelInputs & inputs,
+        unsigned long long iterations) {
+    const util::dmUint64 start = util::DmClock::nowNanos();
+    for (unsigned long long i = 0; i < iterations; ++i) {
+        kernel.func(inputs);
+    }
+    return util::DmClock::nowNanos() - start;
+}
+
+/*
+ * The iteration count is doubled until a run takes at least minMillis, the last
+ * run is the one reported.
+ */
+KernelResult runKernel(const Kernel & kernel, KernelInputs & inputs, unsigned minMillis) {
+    const util::dmUint64 minNanos = static_cast<util::dmUint64>(minMillis) * 1000000;
+    unsigned long long iterations = 1;
+    util::dmUint64 nanos;
+
+    // warm up
+    kernel.func(inputs);
+
+    for (;;) {
+        allocationCount.store(0);
+        allocationBytes.store(0);
+        countAllocations.store(true);
+        nanos = timeIterations(kernel, inputs, iterations);
+        countAllocations.store(false);
+
+        if (nanos >= minNanos) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    KernelResult result;
+    result.name = kernel.name;
+    result.iterations = iterations;
+    result.nanosPerOp = static_cast<double>(nanos) / iterations;
+    result.bytesPerOp = static_cast<double>(allocationBytes.load()) / iterations;
+    result.allocationsPerOp = static_cast<double>(allocationCount.load()) / iterations;
+    return result;
+}
+
+void writeJson(std::ostream & os, const std::vector<KernelResult> & results) {
+    os << "{\n  \"metrics\": {\n";
+    for (unsigned i = 0, n = results.size(); i < n; ++i) {
+        const KernelResult & result = results[i];
+        os << "    \"" << result.name << ".ns_per_op\": " << result.nanosPerOp << ",\n"
+           << "    \"" << result.name << ".bytes_per_op\": " << result.bytesPerOp << ",\n"
+           << "    \"" << result.name << ".allocs_per_op\": " << result.allocationsPerOp
+           << ((i + 1 < n) ? ",\n" : "\n");
+    }
+    os << "  }\n}\n";
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace test;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" [--info=<NFO_FILE>] [--well=<LABEL>] [--filter=<NAME>]");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    KernelInputs inputs;
+    if (!inputs.load(FLAGS_info, FLAGS_well)) {
+        return 1;
+    }
+
+    std::vector<KernelResult> results;
+    std::cout << std::left << std::setw(26) << "kernel" << std::right
+              << std::setw(14) << "ns/op" << std::setw(14) << "bytes/op"
+              << std::setw(14) << "allocs/op" << std::endl;
+
+    for (unsigned i = 0, n = sizeof(KERNELS) / sizeof(KERNELS[0]); i < n; ++i) {
+        const Kernel & kernel = KERNELS[i];
+        if (std::string(kernel.name).find(FLAGS_filter) == std::string::npos) {
+            continue;
+        }
+
+        KernelResult result = runKernel(kernel, inputs, FLAGS_minMillis);
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(26) << result.name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << result.nanosPerOp
+                  << std::setw(14) << result.bytesPerOp
+                  << std::setprecision(2) << std::setw(14) << result.allocationsPerOp
+                  << std::endl;
+    }
+
+    if (!FLAGS_output.empty()) {
+        std::ofstream output(FLAGS_output.c_str());
+        writeJson(output, results);
+        if (!output.good()) {
+            std::cerr << "could not write results to: " << FLAGS_output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,314 @@
+/*
+ * PalletGenerator.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+#include "decoder/WellRectangle.h"
+#include "test/TestCommon.h"
+#include "test/ImageInfo.h"
+
+#include <dmtx.h>
+#include <gflags/gflags.h>
+#include <opencv/cv.h>
+#include <opencv/highgui.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dmscanlib {
+
+namespace test {
+
+std::string usage(
+        "Renders a synthetic image of a pallet of DataMatrix tubes, using the "
+        "libdmtx encoder, and writes the matching image information file. The "
+        "image and the information file can then be used by the dmscanlib unit "
+        "tests and the decode benchmark.\n\n"
+        "Sample usage:\n"
+        );
+
+DEFINE_int32(rows, 8, "number of tube rows in the image.");
+DEFINE_int32(cols, 12, "number of tube columns in the image.");
+DEFINE_int32(dpi, 300, "resolution of the rendered image.");
+DEFINE_double(pitch, 0, "distance between tubes in mm, 0 fits the pallet to the SBS footprint.");
+DEFINE_string(symbolSize, "auto", "DataMatrix symbol size, for example \"12x12\" or \"auto\".");
+DEFINE_double(moduleSize, 0, "size of a DataMatrix module in mm, 0 fits the symbol to the tube.");
+DEFINE_double(rotation, 180, "largest rotation of a tube, in degrees either way.");
+DEFINE_double(blur, 0, "largest standard deviation, in pixels, of the blur applied to a tube.");
+DEFINE_double(noise, 0, "largest standard deviation, in grey levels, of the noise added to a tube.");
+DEFINE_double(contrast, 1, "smallest contrast of a tube, from 0 to 1.");
+DEFINE_int32(scratches, 0, "largest number of scratches across a tube.");
+DEFINE_double(emptyRatio, 0, "fraction of the wells that have no tube.");
+DEFINE_int32(seed, 1, "seed for the random tube parameters.");
+DEFINE_string(orientation, "landscape", "image orientation: \"landscape\" or \"portrait\"");
+DEFINE_string(position, "bottom", "where the barcodes are on a tube: \"top\", \"bottom\"");
+DEFINE_string(output, "synthetic", "base name of the image (.bmp) and information (.nfo) files.");
+
+/*
+ * The DataMatrix symbol for one tube message, one byte per module with zero for
+ * dark modules.
+ */
+class TubeSymbol {
+public:
+    TubeSymbol(const std::string & message, int sizeRequest) {
+        DmtxEncode * enc = dmtxEncodeCreate();
+        dmtxEncodeSetProp(enc, DmtxPropModuleSize, 1);
+        dmtxEncodeSetProp(enc, DmtxPropMarginSize, 0);
+        dmtxEncodeSetProp(enc, DmtxPropSizeRequest, sizeRequest);
+
+        std::vector<unsigned char> data(message.begin(), message.end());
+        if (dmtxEncodeDataMatrix(enc, data.size(), &data[0]) == DmtxFail) {
+            dmtxEncodeDestroy(&enc);
+            throw std::invalid_argument("message does not fit the symbol size: " + message);
+        }
+
+        // libdmtx images start at the bottom row
+        const int width = dmtxImageGetProp(enc->image, DmtxPropWidth);
+        const int height = dmtxImageGetProp(enc->image, DmtxPropHeight);
+        modules.create(height, width, CV_8UC1);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int value;
+                dmtxImageGetPixelValue(enc->image, x, y, 0, &value);
+                modules.at<unsigned char>(height - 1 - y, x) = (value < 128) ? 0 : 255;
+            }
+        }
+        dmtxEncodeDestroy(&enc);
+    }
+
+    cv::Mat modules;
+};
+
+class PalletGenerator {
+public:
+    PalletGenerator(Orientation _orientation, BarcodePosition _position, int _sizeRequest);
+    virtual ~PalletGenerator() {}
+
+    void generate(const std::string & basename);
+
+    static int getSizeRequestFromString(const std::string & symbolSizeStr);
+
+private:
+    void renderTube(cv::Mat & tile, const TubeSymbol & symbol);
+    void renderEmptyWell(cv::Mat & tile);
+
+    static const int RACK_LEVEL = 50;
+    static const int TUBE_LEVEL = 128;
+    static const int TUBE_SWING = 100;
+
+    // the SBS footprint fits 12 columns of tubes at a 9 mm pitch
+    static const double SBS_WELL_AREA_MM;
+
+    const Orientation orientation;
+    const BarcodePosition position;
+    const int sizeRequest;
+    double pitchPixels;
+    double modulePixels;
+    cv::RNG rng;
+};
+
+const double PalletGenerator::SBS_WELL_AREA_MM = 108.0;
+
+PalletGenerator::PalletGenerator(
+        Orientation _orientation,
+        BarcodePosition _position,
+        int _sizeRequest) :
+        orientation(_orientation),
+        position(_position),
+        sizeRequest(_sizeRequest),
+        pitchPixels(0),
+        modulePixels(0),
+        rng(FLAGS_seed)
+{
+    if ((FLAGS_rows <= 0) || (FLAGS_cols <= 0) || (FLAGS_dpi <= 0)) {
+        throw std::invalid_argument("rows, columns and dpi must be positive");
+    }
+
+    double pitch = FLAGS_pitch;
+    if (pitch <= 0) {
+        pitch = SBS_WELL_AREA_MM / std::max(FLAGS_cols, FLAGS_rows * 3 / 2);
+    }
+    pitchPixels = pitch * FLAGS_dpi / 25.4;
+
+    if (FLAGS_moduleSize > 0) {
+        modulePixels = FLAGS_moduleSize * FLAGS_dpi / 25.4;
+    }
+}
+
+int PalletGenerator::getSizeRequestFromString(const std::string & symbolSizeStr) {
+    if (symbolSizeStr.compare("auto") == 0) {
+        return DmtxSymbolSquareAuto;
+    }
+
+    for (int sizeIdx = 0; sizeIdx < DmtxSymbolSquareCount + DmtxSymbolRectCount; ++sizeIdx) {
+        std::ostringstream size;
+        size << dmtxGetSymbolAttribute(DmtxSymAttribSymbolRows, sizeIdx)
+                << "x" << dmtxGetSymbolAttribute(DmtxSymAttribSymbolCols, sizeIdx);
+        if (symbolSizeStr.compare(size.str()) == 0) {
+            return sizeIdx;
+        }
+    }
+    throw std::invalid_argument("invalid symbol size: " + symbolSizeStr);
+}
+
+void PalletGenerator::generate(const std::string & basename) {
+    const int margin = static_cast<int>(pitchPixels / 2);
+    const cv::Rect boundingBox(
+            margin,
+            margin,
+            static_cast<int>(FLAGS_cols * pitchPixels),
+            static_cast<int>(FLAGS_rows * pitchPixels));
+
+    cv::Mat image(boundingBox.height + 2 * margin, boundingBox.width + 2 * margin, CV_8UC1,
+            cv::Scalar(RACK_LEVEL));
+
+    std::vector<std::unique_ptr<const WellRectangle> > wellRects;
+    getWellRectsForBoundingBox(boundingBox, FLAGS_rows, FLAGS_cols, orientation, position,
+            wellRects);
+
+    const std::string imageFilename = basename + ".bmp";
+    ImageInfoWriter imageInfo(imageFilename, boundingBox, orientation, position, FLAGS_rows,
+            FLAGS_cols);
+
+    const unsigned firstMessage = static_cast<unsigned>(rng.uniform(0, 1000000000));
+
+    for (unsigned i = 0, n = wellRects.size(); i < n; ++i) {
+        const WellRectangle & wellRect = *wellRects[i];
+        cv::Mat tile = image(wellRect.getRectangle());
+
+        if (rng.uniform(0.0, 1.0) < FLAGS_emptyRatio) {
+            renderEmptyWell(tile);
+            imageInfo.setBarcodeMsg(wellRect.getLabel(), "");
+            continue;
+        }
+
+        std::ostringstream message;
+        message << std::setw(10) << std::setfill('0') << (firstMessage + i);
+
+        TubeSymbol symbol(message.str(), sizeRequest);
+        renderTube(tile, symbol);
+        imageInfo.setBarcodeMsg(wellRect.getLabel(), message.str());
+    }
+
+    if (!cv::imwrite(imageFilename, image)) {
+        throw std::runtime_error("could not write image: " + imageFilename);
+    }
+
+    const std::string infoFilename = basename + ".nfo";
+    std::ofstream infoFile(infoFilename.c_str());
+    infoFile << imageInfo;
+    if (!infoFile.good()) {
+        throw std::runtime_error("could not write image information: " + infoFilename);
+    }
+
+    std::cout << imageFilename << ": " << image.cols << "x" << image.rows << ", "
+            << imageInfo.getDecodedWellCount() << " tubes" << std::endl;
+}
+
+void PalletGenerator::renderEmptyWell(cv::Mat & tile) {
+    const cv::Point center(tile.cols / 2, tile.rows / 2);
+    const int radius = static_cast<int>(0.42 * pitchPixels);
+    cv::circle(tile, center, radius, cv::Scalar(RACK_LEVEL / 2), -1, CV_AA);
+}
+
+/*
+ * Each tube gets its own rotation, offset, contrast, scratches, blur and noise,
+ * drawn uniformly up to the limits given on the command line.
+ */
+void PalletGenerator::renderTube(cv::Mat & tile, const TubeSymbol & symbol) {
+    const double contrast = rng.uniform(std::max(0.0, std::min(FLAGS_contrast, 1.0)), 1.0);
+    const int light = TUBE_LEVEL + static_cast<int>(TUBE_SWING * contrast);
+    const int dark = TUBE_LEVEL - static_cast<int>(TUBE_SWING * contrast);
+
+    const cv::Point2f center(
+            tile.cols / 2.0f + static_cast<float>(rng.uniform(-0.05, 0.05) * pitchPixels),
+            tile.rows / 2.0f + static_cast<float>(rng.uniform(-0.05, 0.05) * pitchPixels));
+    const int radius = static_cast<int>(0.42 * pitchPixels);
+    cv::circle(tile, cv::Point(tile.cols / 2, tile.rows / 2), radius, cv::Scalar(light), -1,
+            CV_AA);
+
+    const cv::Mat & modules = symbol.modules;
+    double modulePx = modulePixels;
+    if (modulePx <= 0) {
+        modulePx = 0.5 * pitchPixels / std::max(modules.cols, modules.rows);
+    }
+
+    // upsample first so the rotated module edges are interpolated, not aliased
+    const int upsample = 8;
+    cv::Mat symbolImage;
+    cv::resize(modules, symbolImage, cv::Size(), upsample, upsample, cv::INTER_NEAREST);
+    symbolImage.convertTo(symbolImage, CV_8UC1, (light - dark) / 255.0, dark);
+
+    const double angle = (FLAGS_rotation > 0) ? rng.uniform(-FLAGS_rotation, FLAGS_rotation) : 0;
+    const cv::Point2f symbolCenter(symbolImage.cols / 2.0f, symbolImage.rows / 2.0f);
+    cv::Mat transform = cv::getRotationMatrix2D(symbolCenter, angle, modulePx / upsample);
+    transform.at<double>(0, 2) += center.x - symbolCenter.x;
+    transform.at<double>(1, 2) += center.y - symbolCenter.y;
+    cv::warpAffine(symbolImage, tile, transform, tile.size(), cv::INTER_LINEAR,
+            cv::BORDER_TRANSPARENT);
+
+    const int scratches = rng.uniform(0, std::max(FLAGS_scratches, 0) + 1);
+    for (int i = 0; i < scratches; ++i) {
+        const cv::Point from(
+                static_cast<int>(center.x + rng.uniform(-radius, radius)),
+                static_cast<int>(center.y + rng.uniform(-radius, radius)));
+        const cv::Point to(
+                static_cast<int>(center.x + rng.uniform(-radius, radius)),
+                static_cast<int>(center.y + rng.uniform(-radius, radius)));
+        const int level = (rng.uniform(0, 2) == 0) ? light : dark;
+        cv::line(tile, from, to, cv::Scalar(level),
+                std::max(1, static_cast<int>(modulePx / 3)), CV_AA);
+    }
+
+    if (FLAGS_blur > 0) {
+        const double sigma = rng.uniform(0.0, FLAGS_blur);
+        if (sigma > 0.1) {
+            cv::GaussianBlur(tile, tile, cv::Size(), sigma);
+        }
+    }
+
+    if (FLAGS_noise > 0) {
+        cv::Mat noise(tile.size(), CV_32FC1);
+        rng.fill(noise, cv::RNG::NORMAL, cv::Scalar(0), cv::Scalar(rng.uniform(0.0, FLAGS_noise)));
+
+        cv::Mat noisyTile;
+        tile.convertTo(noisyTile, CV_32FC1);
+        noisyTile += noise;
+        noisyTile.convertTo(tile, CV_8UC1);
+    }
+}
+
+} /* namespace */
+
+} /* namespace */
+
+using namespace dmscanlib;
+using namespace test;
+
+int main(int argc, char **argv) {
+    usage.append(argv[0]).append(" --rows=16 --cols=24 --dpi=600 --blur=1 --output=384tubes");
+
+    google::SetUsageMessage(usage);
+    google::ParseCommandLineFlags(&argc, &argv, true);
+
+    try {
+        Orientation orientation = DmScanLib::getOrientationFromString(FLAGS_orientation);
+        BarcodePosition position = DmScanLib::getBarcodePositionFromString(FLAGS_position);
+        int sizeRequest = PalletGenerator::getSizeRequestFromString(FLAGS_symbolSize);
+
+        PalletGenerator generator(orientation, position, sizeRequest);
+        generator.generate(FLAGS_output);
+    } catch (const std::exception & ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
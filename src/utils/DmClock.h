@@ -0,0 +1,46 @@
+#ifndef DMCLOCK_H_
+#define DMCLOCK_H_
+
+/*
+ * DmClock.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#if ! defined (WIN32) || defined(__MINGW32__)
+#include <stdint.h>
+#endif
+
+namespace dmscanlib {
+
+namespace util {
+
+#if defined (WIN32) && ! defined(__MINGW32__)
+typedef unsigned __int64 dmUint64;
+#else
+typedef uint64_t dmUint64;
+#endif
+
+/**
+ * Monotonic clock used to time the decode stages.
+ *
+ * Unlike DmTime, which reads the wall clock, the values returned here are not
+ * affected by changes to the system time and are only meaningful when
+ * subtracted from each other.
+ */
+class DmClock {
+public:
+    /*
+     * Nanoseconds since an arbitrary fixed point.
+     */
+    static dmUint64 nowNanos();
+
+private:
+    DmClock();
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* DMCLOCK_H_ */
@@ -0,0 +1,23 @@
+/*
+ * DmClockLinux.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmClock.h"
+
+#include <time.h>
+
+namespace dmscanlib {
+
+namespace util {
+
+dmUint64 DmClock::nowNanos() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<dmUint64>(ts.tv_sec) * 1000000000ULL + static_cast<dmUint64>(ts.tv_nsec);
+}
+
+} /* namespace */
+
+} /* namespace */
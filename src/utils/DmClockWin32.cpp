@@ -0,0 +1,32 @@
+/*
+ * DmClockWin32.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <windows.h>
+
+namespace dmscanlib {
+
+namespace util {
+
+dmUint64 DmClock::nowNanos() {
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+
+    // split the conversion to avoid overflowing 64 bits on long uptimes
+    const dmUint64 ticks = static_cast<dmUint64>(counter.QuadPart);
+    const dmUint64 freq = static_cast<dmUint64>(frequency.QuadPart);
+    return (ticks / freq) * 1000000000ULL + ((ticks % freq) * 1000000000ULL) / freq;
+}
+
+} /* namespace */
+
+} /* namespace */
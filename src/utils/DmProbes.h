@@ -0,0 +1,41 @@
+#ifndef DMPROBES_H_
+#define DMPROBES_H_
+
+/*
+ * DmProbes.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+/**
+ * USDT static probes, in the "dmscanlib" provider, for bpftrace, perf or
+ * SystemTap to attach to a running process, for example:
+ *
+ *   bpftrace -e 'usdt:./libdmscanlib.so:dmscanlib:well__end { @[arg2] = hist(arg3); }'
+ *
+ * A probe that nothing is attached to is a single nop. The probes are compiled
+ * in when the build defines HAVE_SYS_SDT_H, otherwise the macros are empty.
+ *
+ *   pallet__begin(unsigned wells)
+ *   pallet__end(int result, unsigned decodedWells, uint64 nanos)
+ *   well__begin(const char * label, unsigned tier)
+ *   well__end(const char * label, unsigned tier, int decoded, uint64 nanos)
+ *   message__decoded(const char * label, const char * message, unsigned tier)
+ *
+ * libdmtx has its own probes, see dmtxstatic.h.
+ */
+
+#if defined(HAVE_SYS_SDT_H)
+#   include <sys/sdt.h>
+#   define DM_PROBE1(name, a1) DTRACE_PROBE1(dmscanlib, name, a1)
+#   define DM_PROBE2(name, a1, a2) DTRACE_PROBE2(dmscanlib, name, a1, a2)
+#   define DM_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(dmscanlib, name, a1, a2, a3)
+#   define DM_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(dmscanlib, name, a1, a2, a3, a4)
+#else
+#   define DM_PROBE1(name, a1)
+#   define DM_PROBE2(name, a1, a2)
+#   define DM_PROBE3(name, a1, a2, a3)
+#   define DM_PROBE4(name, a1, a2, a3, a4)
+#endif
+
+#endif /* DMPROBES_H_ */
@@ -0,0 +1,295 @@
+/*
+ * ImageRing.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/ImageRing.h"
+
+#include <new>
+#include <stdexcept>
+
+namespace dmscanlib {
+
+namespace util {
+
+namespace {
+
+const uint32_t RING_MAGIC = 0x444d5247;
+const uint32_t RING_VERSION = 1;
+
+// the slots start on page boundaries
+const size_t RING_ALIGNMENT = 4096;
+
+enum SlotState {
+    SLOT_FREE,
+    SLOT_WRITING,
+    SLOT_PUBLISHED,
+    SLOT_DECODING
+};
+
+size_t roundUp(size_t size) {
+    return (size + RING_ALIGNMENT - 1) / RING_ALIGNMENT * RING_ALIGNMENT;
+}
+
+/*
+ * The generation is in the high half of a slot's state word, the state in the
+ * low half.
+ */
+uint64_t makeWord(uint32_t generation, uint32_t state) {
+    return (static_cast<uint64_t>(generation) << 32) | state;
+}
+
+uint32_t getGeneration(uint64_t word) {
+    return static_cast<uint32_t>(word >> 32);
+}
+
+uint32_t getState(uint64_t word) {
+    return static_cast<uint32_t>(word);
+}
+
+} /* namespace */
+
+/*
+ * The first page of the shared memory: the ring header, then one header per
+ * slot. The pixels of the slots follow on the next page boundary.
+ */
+class ImageRing::RingHeader {
+public:
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+};
+
+class ImageRing::SlotHeader {
+public:
+    SlotHeader() :
+            word(makeWord(0, SLOT_FREE)),
+            width(0),
+            height(0),
+            stride(0),
+            format(0)
+    {
+    }
+
+    std::atomic<uint64_t> word;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;
+};
+
+const unsigned ImageRing::MAX_SLOTS = 64;
+
+size_t ImageRing::getSlotOffset(uint32_t slotCount) {
+    return roundUp(sizeof(RingHeader) + slotCount * sizeof(SlotHeader));
+}
+
+size_t ImageRing::getRingSize(uint32_t slotCount, uint32_t slotSize) {
+    return getSlotOffset(slotCount) + slotCount * roundUp(slotSize);
+}
+
+ImageSlot::ImageSlot(
+        ImageRing & _ring,
+        const ImageSlotHandle & _handle,
+        const unsigned char * _pixels,
+        unsigned _width,
+        unsigned _height,
+        unsigned _stride,
+        PixelFormat _format) :
+        width(_width),
+        height(_height),
+        stride(_stride),
+        format(_format),
+        ring(_ring),
+        handle(_handle),
+        pixels(_pixels)
+{
+}
+
+ImageSlot::~ImageSlot() {
+    ring.release(handle);
+}
+
+ImageRing::ImageRing(const std::string & _name, bool _owner) :
+        name(_name),
+        owner(_owner),
+        header(NULL),
+        memory(NULL),
+        memorySize(0),
+        mapping(0)
+{
+}
+
+ImageRing::~ImageRing() {
+    unmapMemory();
+}
+
+std::unique_ptr<ImageRing> ImageRing::create(
+        const std::string & name,
+        unsigned slotCount,
+        unsigned slotSize) {
+    if ((slotCount == 0) || (slotCount > MAX_SLOTS) || (slotSize == 0)) {
+        throw std::invalid_argument("invalid image ring size");
+    }
+
+    std::unique_ptr<ImageRing> ring(new ImageRing(name, true));
+    if (!ring->mapMemory(getRingSize(slotCount, slotSize))) {
+        throw std::runtime_error("could not create image ring " + name + ": "
+                + ring->errorMessage);
+    }
+    ring->header = reinterpret_cast<RingHeader *>(ring->memory);
+
+    for (unsigned i = 0; i < slotCount; ++i) {
+        new (ring->getSlotHeader(i)) SlotHeader();
+    }
+
+    ring->header->version = RING_VERSION;
+    ring->header->slotCount = slotCount;
+    ring->header->slotSize = slotSize;
+
+    // a producer opening the ring only trusts it once the magic is there
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->header->magic = RING_MAGIC;
+    return ring;
+}
+
+std::unique_ptr<ImageRing> ImageRing::open(const std::string & name) {
+    std::unique_ptr<ImageRing> ring(new ImageRing(name, false));
+    if (!ring->mapMemory(0)) {
+        throw std::runtime_error("could not open image ring " + name + ": "
+                + ring->errorMessage);
+    }
+    ring->header = reinterpret_cast<RingHeader *>(ring->memory);
+
+    const RingHeader * header = ring->header;
+    if ((ring->memorySize < sizeof(RingHeader))
+            || (header->magic != RING_MAGIC)
+            || (header->version != RING_VERSION)
+            || (header->slotCount == 0)
+            || (header->slotCount > MAX_SLOTS)
+            || (ring->memorySize < getRingSize(header->slotCount, header->slotSize))) {
+        throw std::runtime_error("not an image ring: " + name);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return ring;
+}
+
+unsigned ImageRing::getSlotCount() const {
+    return header->slotCount;
+}
+
+unsigned ImageRing::getSlotSize() const {
+    return header->slotSize;
+}
+
+ImageRing::SlotHeader * ImageRing::getSlotHeader(uint32_t slot) const {
+    return reinterpret_cast<SlotHeader *>(memory + sizeof(RingHeader)) + slot;
+}
+
+unsigned char * ImageRing::getPixels(uint32_t slot) const {
+    return memory + getSlotOffset(header->slotCount) + slot * roundUp(header->slotSize);
+}
+
+bool ImageRing::isInState(const ImageSlotHandle & handle, uint32_t state) const {
+    return (handle.slot < header->slotCount)
+            && (getSlotHeader(handle.slot)->word.load() == makeWord(handle.generation, state));
+}
+
+bool ImageRing::changeState(const ImageSlotHandle & handle, uint32_t from, uint32_t to) {
+    if (handle.slot >= header->slotCount) {
+        return false;
+    }
+    uint64_t expected = makeWord(handle.generation, from);
+    return getSlotHeader(handle.slot)->word.compare_exchange_strong(
+            expected, makeWord(handle.generation, to));
+}
+
+bool ImageRing::acquire(ImageSlotHandle & handle) {
+    for (uint32_t i = 0, n = header->slotCount; i < n; ++i) {
+        SlotHeader * slotHeader = getSlotHeader(i);
+        uint64_t word = slotHeader->word.load();
+        if (getState(word) != SLOT_FREE) {
+            continue;
+        }
+
+        const uint32_t generation = getGeneration(word) + 1;
+        if (slotHeader->word.compare_exchange_strong(
+                word, makeWord(generation, SLOT_WRITING))) {
+            handle.slot = i;
+            handle.generation = generation;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned char * ImageRing::getSlotPixels(const ImageSlotHandle & handle) {
+    if (!isInState(handle, SLOT_WRITING)) {
+        throw std::invalid_argument("image slot is not acquired");
+    }
+    return getPixels(handle.slot);
+}
+
+void ImageRing::publish(
+        const ImageSlotHandle & handle,
+        unsigned width,
+        unsigned height,
+        unsigned stride,
+        PixelFormat format) {
+    if ((width == 0) || (height == 0) || (format >= PIXEL_FORMAT_MAX)
+            || (static_cast<uint64_t>(stride) * height > header->slotSize)) {
+        throw std::invalid_argument("image does not fit the slot");
+    }
+    if (!isInState(handle, SLOT_WRITING)) {
+        throw std::invalid_argument("image slot is not acquired");
+    }
+
+    SlotHeader * slotHeader = getSlotHeader(handle.slot);
+    slotHeader->width = width;
+    slotHeader->height = height;
+    slotHeader->stride = stride;
+    slotHeader->format = format;
+
+    // the compare and swap orders the pixels and the image size before the state
+    changeState(handle, SLOT_WRITING, SLOT_PUBLISHED);
+}
+
+bool ImageRing::discard(const ImageSlotHandle & handle) {
+    return changeState(handle, SLOT_WRITING, SLOT_FREE)
+            || changeState(handle, SLOT_PUBLISHED, SLOT_FREE);
+}
+
+/*
+ * The image size is copied out of the shared memory and checked again, a
+ * producer could change it after publishing.
+ */
+std::unique_ptr<ImageSlot> ImageRing::take(const ImageSlotHandle & handle) {
+    if (!changeState(handle, SLOT_PUBLISHED, SLOT_DECODING)) {
+        return std::unique_ptr<ImageSlot>();
+    }
+
+    const SlotHeader * slotHeader = getSlotHeader(handle.slot);
+    const uint32_t width = slotHeader->width;
+    const uint32_t height = slotHeader->height;
+    const uint32_t stride = slotHeader->stride;
+    const uint32_t format = slotHeader->format;
+
+    if ((format >= PIXEL_FORMAT_MAX)
+            || (static_cast<uint64_t>(stride) * height > header->slotSize)) {
+        release(handle);
+        return std::unique_ptr<ImageSlot>();
+    }
+
+    return std::unique_ptr<ImageSlot>(new ImageSlot(*this, handle, getPixels(handle.slot),
+            width, height, stride, static_cast<PixelFormat>(format)));
+}
+
+void ImageRing::release(const ImageSlotHandle & handle) {
+    changeState(handle, SLOT_DECODING, SLOT_FREE);
+}
+
+} /* namespace */
+
+} /* namespace */
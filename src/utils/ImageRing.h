@@ -0,0 +1,205 @@
+#ifndef IMAGERING_H_
+#define IMAGERING_H_
+
+/*
+ * ImageRing.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "DmScanLib.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace dmscanlib {
+
+namespace util {
+
+/*
+ * Identifies an image published in a ring. The generation changes every time
+ * the slot is reused, so a stale handle is refused instead of decoding the
+ * wrong image.
+ */
+class ImageSlotHandle {
+public:
+    ImageSlotHandle() :
+            slot(0),
+            generation(0)
+    {
+    }
+
+    uint32_t slot;
+    uint32_t generation;
+};
+
+class ImageRing;
+
+/**
+ * A published image taken by the decoder. The pixels stay in the shared memory
+ * and are used in place; the slot is released, and can be reused by the
+ * producer, when this object is destroyed.
+ */
+class ImageSlot {
+public:
+    virtual ~ImageSlot();
+
+    const unsigned char * getPixels() const {
+        return pixels;
+    }
+
+    const unsigned width;
+    const unsigned height;
+    const unsigned stride;
+    const PixelFormat format;
+
+private:
+    friend class ImageRing;
+
+    ImageSlot(
+            ImageRing & ring,
+            const ImageSlotHandle & handle,
+            const unsigned char * pixels,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format);
+
+    ImageSlot(const ImageSlot &);
+    ImageSlot & operator=(const ImageSlot &);
+
+    ImageRing & ring;
+    const ImageSlotHandle handle;
+    const unsigned char * pixels;
+};
+
+/**
+ * A fixed number of image slots in memory shared between processes, so that a
+ * capture process can hand large images to the decoder without copying them
+ * through a file or a socket.
+ *
+ * The decoder creates the ring and the producers open it by name. A producer
+ * acquires a free slot, writes the pixels into it and publishes it, then sends
+ * the handle to the decoder. The decoder takes the slot and decodes the pixels
+ * where they are. When it is done the slot is free again.
+ *
+ * A slot is free, being written, published or being decoded. Every change of
+ * state is an atomic compare and swap on a word in the shared memory, which
+ * also holds the slot's generation. If a producer dies holding a slot, that
+ * slot is lost until the ring is created again.
+ *
+ * On Linux the memory is a POSIX shared memory object, on Windows a named file
+ * mapping. Names start with a '/' on Linux, for example "/dmscand".
+ */
+class ImageRing {
+public:
+    /*
+     * Creates a ring, replacing any left over with the same name. Throws
+     * std::runtime_error if the shared memory cannot be created.
+     */
+    static std::unique_ptr<ImageRing> create(
+            const std::string & name,
+            unsigned slotCount,
+            unsigned slotSize);
+
+    /*
+     * Opens a ring created by another process. Throws std::runtime_error if there
+     * is no such ring.
+     */
+    static std::unique_ptr<ImageRing> open(const std::string & name);
+
+    /*
+     * The creator removes the ring's name, processes that still have it open can
+     * keep using it.
+     */
+    virtual ~ImageRing();
+
+    const std::string & getName() const {
+        return name;
+    }
+
+    unsigned getSlotCount() const;
+
+    // bytes of pixels a slot can hold
+    unsigned getSlotSize() const;
+
+    /*
+     * Producer side. Acquires a free slot to write an image into. Returns false
+     * if every slot is in use.
+     */
+    bool acquire(ImageSlotHandle & handle);
+
+    /*
+     * Where the pixels of an acquired slot are written.
+     */
+    unsigned char * getSlotPixels(const ImageSlotHandle & handle);
+
+    /*
+     * Makes an acquired slot available to the decoder. Throws
+     * std::invalid_argument if the image does not fit the slot.
+     */
+    void publish(
+            const ImageSlotHandle & handle,
+            unsigned width,
+            unsigned height,
+            unsigned stride,
+            PixelFormat format);
+
+    /*
+     * Frees a slot that was acquired or published but will not be decoded. Returns
+     * false if the decoder already took it or the handle is stale.
+     */
+    bool discard(const ImageSlotHandle & handle);
+
+    /*
+     * Decoder side. Takes a published slot, returns NULL if the handle is invalid,
+     * stale, or the slot is not published.
+     */
+    std::unique_ptr<ImageSlot> take(const ImageSlotHandle & handle);
+
+    static const unsigned MAX_SLOTS;
+
+private:
+    friend class ImageSlot;
+
+    class RingHeader;
+    class SlotHeader;
+
+    ImageRing(const std::string & name, bool owner);
+
+    ImageRing(const ImageRing &);
+    ImageRing & operator=(const ImageRing &);
+
+    /*
+     * Platform specific, see ImageRingLinux.cpp and ImageRingWin32.cpp. The owner
+     * creates the memory, others map all of an existing one when size is zero.
+     * Return false, with errorMessage set, when the memory cannot be mapped.
+     */
+    bool mapMemory(size_t size);
+    void unmapMemory();
+
+    static size_t getSlotOffset(uint32_t slotCount);
+    static size_t getRingSize(uint32_t slotCount, uint32_t slotSize);
+
+    SlotHeader * getSlotHeader(uint32_t slot) const;
+    unsigned char * getPixels(uint32_t slot) const;
+    bool isInState(const ImageSlotHandle & handle, uint32_t state) const;
+    bool changeState(const ImageSlotHandle & handle, uint32_t from, uint32_t to);
+    void release(const ImageSlotHandle & handle);
+
+    const std::string name;
+    const bool owner;
+    RingHeader * header;
+    unsigned char * memory;
+    size_t memorySize;
+    intptr_t mapping;
+    std::string errorMessage;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* IMAGERING_H_ */
@@ -0,0 +1,84 @@
+/*
+ * ImageRingLinux.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/ImageRing.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dmscanlib {
+
+namespace util {
+
+/*
+ * The memory is a POSIX shared memory object. Its pages are only allocated
+ * when they are first written, so a ring sized for the largest images costs
+ * nothing until it is used.
+ */
+bool ImageRing::mapMemory(size_t size) {
+    int fd;
+    if (owner) {
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if ((fd >= 0) && (ftruncate(fd, size) != 0)) {
+            errorMessage = strerror(errno);
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+    } else {
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+        struct stat status;
+        if ((fd >= 0) && (fstat(fd, &status) == 0)) {
+            size = status.st_size;
+        }
+    }
+
+    if (fd < 0) {
+        errorMessage = strerror(errno);
+        return false;
+    }
+    if (size == 0) {
+        errorMessage = "empty shared memory";
+        close(fd);
+        return false;
+    }
+
+    void * address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        errorMessage = strerror(errno);
+        close(fd);
+        if (owner) {
+            shm_unlink(name.c_str());
+        }
+        return false;
+    }
+
+    memory = static_cast<unsigned char *>(address);
+    memorySize = size;
+    mapping = fd;
+    return true;
+}
+
+void ImageRing::unmapMemory() {
+    if (memory == NULL) {
+        return;
+    }
+    munmap(memory, memorySize);
+    close(static_cast<int>(mapping));
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+    memory = NULL;
+}
+
+} /* namespace */
+
+} /* namespace */
@@ -0,0 +1,77 @@
+/*
+ * ImageRingWin32.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/ImageRing.h"
+
+#include <sstream>
+#include <windows.h>
+
+namespace dmscanlib {
+
+namespace util {
+
+namespace {
+
+std::string getErrorMessage() {
+    std::ostringstream msg;
+    msg << "error " << GetLastError();
+    return msg.str();
+}
+
+} /* namespace */
+
+/*
+ * The memory is a named file mapping backed by the paging file. Windows removes
+ * it when the last process that has it open closes it.
+ */
+bool ImageRing::mapMemory(size_t size) {
+    HANDLE handle;
+    if (owner) {
+        const unsigned long long size64 = size;
+        handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), name.c_str());
+    } else {
+        handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+    }
+
+    if (handle == NULL) {
+        errorMessage = getErrorMessage();
+        return false;
+    }
+
+    void * address = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, owner ? size : 0);
+    if (address == NULL) {
+        errorMessage = getErrorMessage();
+        CloseHandle(handle);
+        return false;
+    }
+
+    MEMORY_BASIC_INFORMATION info;
+    if (VirtualQuery(address, &info, sizeof(info)) == 0) {
+        errorMessage = getErrorMessage();
+        UnmapViewOfFile(address);
+        CloseHandle(handle);
+        return false;
+    }
+
+    memory = static_cast<unsigned char *>(address);
+    memorySize = owner ? size : info.RegionSize;
+    mapping = reinterpret_cast<intptr_t>(handle);
+    return true;
+}
+
+void ImageRing::unmapMemory() {
+    if (memory == NULL) {
+        return;
+    }
+    UnmapViewOfFile(memory);
+    CloseHandle(reinterpret_cast<HANDLE>(mapping));
+    memory = NULL;
+}
+
+} /* namespace */
+
+} /* namespace */
@@ -0,0 +1,244 @@
+/*
+ * MetricsRegistry.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/MetricsRegistry.h"
+
+#include <fstream>
+
+namespace dmscanlib {
+
+namespace util {
+
+namespace {
+
+const double PERCENTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+void writeCounter(std::ostream & os, const char * name, const char * help, dmUint64 value) {
+    os << "# HELP " << name << " " << help << "\n"
+       << "# TYPE " << name << " counter\n"
+       << name << " " << value << "\n";
+}
+
+void writeSummary(std::ostream & os, const char * name, const char * help,
+        const HistogramSnapshot & histogram) {
+    os << "# HELP " << name << " " << help << "\n"
+       << "# TYPE " << name << " summary\n";
+    for (unsigned i = 0; i < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); ++i) {
+        os << name << "{quantile=\"" << PERCENTILES[i] << "\"} "
+           << static_cast<double>(histogram.getPercentileNanos(PERCENTILES[i])) / 1e9 << "\n";
+    }
+    os << name << "_sum " << static_cast<double>(histogram.sumNanos) / 1e9 << "\n"
+       << name << "_count " << histogram.count << "\n";
+}
+
+} /* namespace */
+
+const unsigned LatencyHistogram::SUB_BUCKET_BITS;
+const unsigned LatencyHistogram::SUB_BUCKET_COUNT;
+const unsigned LatencyHistogram::BUCKET_COUNT;
+
+HistogramSnapshot::HistogramSnapshot(
+        const std::vector<dmUint64> & _counts,
+        dmUint64 _count,
+        dmUint64 _sumNanos,
+        dmUint64 _maxNanos) :
+        counts(_counts),
+        count(_count),
+        sumNanos(_sumNanos),
+        maxNanos(_maxNanos)
+{
+}
+
+dmUint64 HistogramSnapshot::getPercentileNanos(double fraction) const {
+    dmUint64 total = 0;
+    for (unsigned i = 0, n = counts.size(); i < n; ++i) {
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    dmUint64 rank = static_cast<dmUint64>(fraction * static_cast<double>(total) + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+
+    dmUint64 seen = 0;
+    for (unsigned i = 0, n = counts.size(); i < n; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            dmUint64 upper = LatencyHistogram::getBucketUpperBound(i);
+            return (upper < maxNanos) ? upper : maxNanos;
+        }
+    }
+    return maxNanos;
+}
+
+double HistogramSnapshot::getMeanNanos() const {
+    if (count == 0) {
+        return 0;
+    }
+    return static_cast<double>(sumNanos) / static_cast<double>(count);
+}
+
+LatencyHistogram::LatencyHistogram() {
+    for (unsigned i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = 0;
+    }
+    count = 0;
+    sumNanos = 0;
+    maxNanos = 0;
+}
+
+/*
+ * Values below 2 * SUB_BUCKET_COUNT have a bucket each. Above that, the bucket is
+ * chosen by the position of the highest set bit and the SUB_BUCKET_BITS bits that
+ * follow it.
+ */
+unsigned LatencyHistogram::getBucketIndex(dmUint64 value) {
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return static_cast<unsigned>(value);
+    }
+
+    unsigned msb = 0;
+    for (dmUint64 v = value; v > 1; v >>= 1) {
+        ++msb;
+    }
+    const unsigned shift = msb - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKET_COUNT
+            + static_cast<unsigned>((value >> shift) - SUB_BUCKET_COUNT);
+}
+
+dmUint64 LatencyHistogram::getBucketUpperBound(unsigned index) {
+    if (index < 2 * SUB_BUCKET_COUNT) {
+        return index;
+    }
+    const unsigned shift = index / SUB_BUCKET_COUNT - 1;
+    const dmUint64 lower =
+            static_cast<dmUint64>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lower + ((static_cast<dmUint64>(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(dmUint64 nanos) {
+    counts[getBucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+
+    dmUint64 prevMax = maxNanos.load(std::memory_order_relaxed);
+    while ((nanos > prevMax)
+            && !maxNanos.compare_exchange_weak(prevMax, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+std::unique_ptr<HistogramSnapshot> LatencyHistogram::snapshot() const {
+    std::vector<dmUint64> copy(BUCKET_COUNT);
+    for (unsigned i = 0; i < BUCKET_COUNT; ++i) {
+        copy[i] = counts[i].load(std::memory_order_relaxed);
+    }
+    return std::unique_ptr<HistogramSnapshot>(new HistogramSnapshot(
+            copy,
+            count.load(std::memory_order_relaxed),
+            sumNanos.load(std::memory_order_relaxed),
+            maxNanos.load(std::memory_order_relaxed)));
+}
+
+MetricsSnapshot::MetricsSnapshot(
+        dmUint64 _pallets,
+        dmUint64 _wellsAttempted,
+        dmUint64 _wellsDecoded,
+        dmUint64 _emptyWells,
+        dmUint64 _duplicates,
+        dmUint64 _retries,
+        std::unique_ptr<HistogramSnapshot> _palletLatency,
+        std::unique_ptr<HistogramSnapshot> _wellLatency) :
+        pallets(_pallets),
+        wellsAttempted(_wellsAttempted),
+        wellsDecoded(_wellsDecoded),
+        emptyWells(_emptyWells),
+        duplicates(_duplicates),
+        retries(_retries),
+        palletLatency(std::move(_palletLatency)),
+        wellLatency(std::move(_wellLatency))
+{
+}
+
+void MetricsSnapshot::writeText(std::ostream & os) const {
+    writeCounter(os, "dmscanlib_pallets_total", "Pallet images decoded.", pallets);
+    writeCounter(os, "dmscanlib_wells_attempted_total", "Wells submitted for decoding.",
+            wellsAttempted);
+    writeCounter(os, "dmscanlib_wells_decoded_total", "Wells decoded.", wellsDecoded);
+    writeCounter(os, "dmscanlib_wells_empty_total",
+            "Wells where no decode tier found a barcode region.", emptyWells);
+    writeCounter(os, "dmscanlib_duplicates_total",
+            "Pallets rejected because two wells decoded to the same message.", duplicates);
+    writeCounter(os, "dmscanlib_retries_total",
+            "Well decode attempts after the first decode tier.", retries);
+    writeSummary(os, "dmscanlib_pallet_latency_seconds", "Time to load and decode a pallet.",
+            *palletLatency);
+    writeSummary(os, "dmscanlib_well_latency_seconds",
+            "Time spent decoding a well, over all tiers.", *wellLatency);
+}
+
+MetricsRegistry MetricsRegistry::instance;
+
+MetricsRegistry::MetricsRegistry() {
+    pallets = 0;
+    wellsAttempted = 0;
+    wellsDecoded = 0;
+    emptyWells = 0;
+    duplicates = 0;
+    retries = 0;
+}
+
+void MetricsRegistry::addPallet(dmUint64 latencyNanos) {
+    pallets.fetch_add(1, std::memory_order_relaxed);
+    palletLatency.record(latencyNanos);
+}
+
+void MetricsRegistry::addWell(bool decoded, bool regionFound, dmUint64 latencyNanos) {
+    wellsAttempted.fetch_add(1, std::memory_order_relaxed);
+    if (decoded) {
+        wellsDecoded.fetch_add(1, std::memory_order_relaxed);
+    } else if (!regionFound) {
+        emptyWells.fetch_add(1, std::memory_order_relaxed);
+    }
+    wellLatency.record(latencyNanos);
+}
+
+void MetricsRegistry::addDuplicate() {
+    duplicates.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::addRetry() {
+    retries.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::unique_ptr<MetricsSnapshot> MetricsRegistry::snapshot() const {
+    return std::unique_ptr<MetricsSnapshot>(new MetricsSnapshot(
+            pallets.load(std::memory_order_relaxed),
+            wellsAttempted.load(std::memory_order_relaxed),
+            wellsDecoded.load(std::memory_order_relaxed),
+            emptyWells.load(std::memory_order_relaxed),
+            duplicates.load(std::memory_order_relaxed),
+            retries.load(std::memory_order_relaxed),
+            palletLatency.snapshot(),
+            wellLatency.snapshot()));
+}
+
+bool MetricsRegistry::writeTextFile(const std::string & filename) const {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    snapshot()->writeText(file);
+    return file.good();
+}
+
+} /* namespace */
+
+} /* namespace */
@@ -0,0 +1,183 @@
+#ifndef METRICSREGISTRY_H_
+#define METRICSREGISTRY_H_
+
+/*
+ * MetricsRegistry.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace dmscanlib {
+
+namespace util {
+
+/**
+ * A copy of a LatencyHistogram.
+ *
+ * The values are read one at a time while other threads may be recording, so
+ * while decodes are running the copy is approximate: count, sumNanos and the
+ * bucket counts may each include or miss the latest few values. Percentiles are
+ * computed from the bucket counts alone.
+ */
+class HistogramSnapshot {
+public:
+    HistogramSnapshot(
+            const std::vector<dmUint64> & counts,
+            dmUint64 count,
+            dmUint64 sumNanos,
+            dmUint64 maxNanos);
+
+    const std::vector<dmUint64> counts;
+    const dmUint64 count;
+    const dmUint64 sumNanos;
+    const dmUint64 maxNanos;
+
+    /*
+     * Returns the latency, in nanoseconds, at or below which the given fraction
+     * (0.0 to 1.0) of the recorded values fall. Reported values are accurate to
+     * within about 6%.
+     */
+    dmUint64 getPercentileNanos(double fraction) const;
+
+    double getMeanNanos() const;
+};
+
+/**
+ * Latency histogram with log-linear buckets, in the style of HdrHistogram.
+ *
+ * Each power of two is split into 16 linear buckets, so any latency from a
+ * nanosecond to centuries is kept with a relative error of at most 1/16.
+ * Recording is lock free and can be done from any thread.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(dmUint64 nanos);
+
+    std::unique_ptr<HistogramSnapshot> snapshot() const;
+
+    static unsigned getBucketIndex(dmUint64 value);
+
+    /*
+     * Returns the largest value that falls into a bucket.
+     */
+    static dmUint64 getBucketUpperBound(unsigned index);
+
+    static const unsigned SUB_BUCKET_BITS = 4;
+    static const unsigned SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const unsigned BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+private:
+    LatencyHistogram(const LatencyHistogram &);
+    LatencyHistogram & operator=(const LatencyHistogram &);
+
+    std::atomic<dmUint64> counts[BUCKET_COUNT];
+    std::atomic<dmUint64> count;
+    std::atomic<dmUint64> sumNanos;
+    std::atomic<dmUint64> maxNanos;
+};
+
+/**
+ * A copy of the values of all the metrics.
+ *
+ * Each value is read on its own, without stopping the threads that update them,
+ * so a snapshot taken while decodes are running is approximate: for example
+ * wellsDecoded and wellsAttempted may differ by a well from any one point in time.
+ * Once the decodes have finished the values are exact.
+ */
+class MetricsSnapshot {
+public:
+    MetricsSnapshot(
+            dmUint64 pallets,
+            dmUint64 wellsAttempted,
+            dmUint64 wellsDecoded,
+            dmUint64 emptyWells,
+            dmUint64 duplicates,
+            dmUint64 retries,
+            std::unique_ptr<HistogramSnapshot> palletLatency,
+            std::unique_ptr<HistogramSnapshot> wellLatency);
+
+    const dmUint64 pallets;
+    const dmUint64 wellsAttempted;
+    const dmUint64 wellsDecoded;
+    const dmUint64 emptyWells;
+    const dmUint64 duplicates;
+    const dmUint64 retries;
+    const std::unique_ptr<HistogramSnapshot> palletLatency;
+    const std::unique_ptr<HistogramSnapshot> wellLatency;
+
+    /*
+     * Writes the metrics in the Prometheus text exposition format.
+     */
+    void writeText(std::ostream & os) const;
+
+private:
+    MetricsSnapshot(const MetricsSnapshot &);
+    MetricsSnapshot & operator=(const MetricsSnapshot &);
+};
+
+/**
+ * Process wide decode metrics. The values are cumulative from the time the
+ * library was loaded.
+ */
+class MetricsRegistry {
+public:
+    static MetricsRegistry & getInstance() {
+        return instance;
+    }
+
+    void addPallet(dmUint64 latencyNanos);
+
+    /*
+     * A well that did not decode is counted as empty only when no barcode region
+     * was found in it, a region that failed to decode points at the image instead.
+     */
+    void addWell(bool decoded, bool regionFound, dmUint64 latencyNanos);
+
+    void addDuplicate();
+
+    void addRetry();
+
+    /*
+     * Recording stays lock free, so the snapshot is approximate while decodes are
+     * running, see MetricsSnapshot.
+     */
+    std::unique_ptr<MetricsSnapshot> snapshot() const;
+
+    /*
+     * Writes a snapshot to a file in the text exposition format. Returns false if
+     * the file could not be written.
+     */
+    bool writeTextFile(const std::string & filename) const;
+
+private:
+    MetricsRegistry();
+    MetricsRegistry(const MetricsRegistry &);
+    MetricsRegistry & operator=(const MetricsRegistry &);
+
+    static MetricsRegistry instance;
+
+    std::atomic<dmUint64> pallets;
+    std::atomic<dmUint64> wellsAttempted;
+    std::atomic<dmUint64> wellsDecoded;
+    std::atomic<dmUint64> emptyWells;
+    std::atomic<dmUint64> duplicates;
+    std::atomic<dmUint64> retries;
+    LatencyHistogram palletLatency;
+    LatencyHistogram wellLatency;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* METRICSREGISTRY_H_ */
@@ -0,0 +1,58 @@
+/*
+ * PerfCounters.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/PerfCounters.h"
+
+#include <iomanip>
+
+namespace dmscanlib {
+
+namespace util {
+
+std::atomic<bool> PerfCounters::enabled(false);
+
+void PerfCounters::setEnabled(bool enable) {
+    enabled.store(enable);
+}
+
+PerfCounterValues & PerfCounterValues::operator+=(const PerfCounterValues & that) {
+    cycles += that.cycles;
+    instructions += that.instructions;
+    cacheMisses += that.cacheMisses;
+    branchMisses += that.branchMisses;
+    return *this;
+}
+
+PerfCounterValues operator-(const PerfCounterValues & end, const PerfCounterValues & start) {
+    PerfCounterValues result;
+    result.cycles = end.cycles - start.cycles;
+    result.instructions = end.instructions - start.instructions;
+    result.cacheMisses = end.cacheMisses - start.cacheMisses;
+    result.branchMisses = end.branchMisses - start.branchMisses;
+    return result;
+}
+
+std::ostream & operator<<(std::ostream & os, const PerfCounterValues & m) {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+
+    const double ipc = (m.cycles > 0)
+            ? static_cast<double>(m.instructions) / static_cast<double>(m.cycles) : 0;
+
+    os << "cycles/" << m.cycles
+       << " instructions/" << m.instructions
+       << " ipc/" << std::fixed << std::setprecision(2) << ipc
+       << " cacheMisses/" << m.cacheMisses
+       << " branchMisses/" << m.branchMisses;
+
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+} /* namespace */
+
+} /* namespace */
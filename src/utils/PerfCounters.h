@@ -0,0 +1,102 @@
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+/*
+ * PerfCounters.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <atomic>
+#include <ostream>
+
+namespace dmscanlib {
+
+namespace util {
+
+struct PerfCounterValues {
+    PerfCounterValues() :
+            cycles(0),
+            instructions(0),
+            cacheMisses(0),
+            branchMisses(0)
+    {
+    }
+
+    PerfCounterValues & operator+=(const PerfCounterValues & that);
+
+    dmUint64 cycles;
+    dmUint64 instructions;
+    dmUint64 cacheMisses;
+    dmUint64 branchMisses;
+};
+
+PerfCounterValues operator-(const PerfCounterValues & end, const PerfCounterValues & start);
+
+/**
+ * Hardware performance counters for the calling thread: cycles, instructions,
+ * cache misses and branch misses, counted in user space only.
+ *
+ * On Linux the counters are opened with perf_event_open the first time a thread
+ * reads them and closed when the thread exits. When the kernel does not allow
+ * it, for example under a restrictive perf_event_paranoid setting or in a
+ * virtual machine without a PMU, read() returns false and the decode report
+ * only has timings. Counters the hardware does not have read as zero. On other
+ * platforms read() always returns false.
+ */
+class PerfCounters {
+public:
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool enable);
+
+    /*
+     * Returns false if the counters are off or cannot be opened on this thread.
+     */
+    static bool read(PerfCounterValues & values);
+
+private:
+    PerfCounters();
+
+    static std::atomic<bool> enabled;
+};
+
+/**
+ * The counters of the calling thread when it is constructed, if they are on and
+ * can be read.
+ */
+class PerfCounterStart {
+public:
+    PerfCounterStart() :
+            valid(PerfCounters::read(start))
+    {
+    }
+
+    /*
+     * The counts since construction. Returns false if nothing was counted.
+     */
+    bool getElapsed(PerfCounterValues & elapsed) const {
+        PerfCounterValues end;
+        if (!valid || !PerfCounters::read(end)) {
+            return false;
+        }
+        elapsed = end - start;
+        return true;
+    }
+
+private:
+    PerfCounterValues start;
+    const bool valid;
+};
+
+std::ostream & operator<<(std::ostream & os, const PerfCounterValues & m);
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* PERFCOUNTERS_H_ */
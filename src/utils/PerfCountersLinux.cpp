@@ -0,0 +1,142 @@
+/*
+ * PerfCountersLinux.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/PerfCounters.h"
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+namespace dmscanlib {
+
+namespace util {
+
+namespace {
+
+enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_MAX };
+
+const unsigned long long COUNTER_CONFIGS[COUNTER_MAX] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/*
+ * The counters are opened as one group, led by the cycle counter, so that a
+ * single read returns all of them. slots holds the position of each counter in
+ * the group, or -1 if it could not be opened.
+ */
+struct ThreadCounters {
+    int fds[COUNTER_MAX];
+    int slots[COUNTER_MAX];
+    unsigned groupSize;
+};
+
+pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+pthread_key_t countersKey;
+std::atomic<bool> unavailableLogged(false);
+
+void closeCounters(void * ptr) {
+    ThreadCounters * counters = static_cast<ThreadCounters *>(ptr);
+    for (unsigned i = 0; i < COUNTER_MAX; ++i) {
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+        }
+    }
+    delete counters;
+}
+
+void createCountersKey() {
+    pthread_key_create(&countersKey, closeCounters);
+}
+
+int openCounter(unsigned long long config, int groupFd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // this thread, on any CPU
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+ThreadCounters * openThreadCounters() {
+    ThreadCounters * counters = new ThreadCounters();
+    counters->groupSize = 0;
+    for (unsigned i = 0; i < COUNTER_MAX; ++i) {
+        counters->fds[i] = -1;
+        counters->slots[i] = -1;
+    }
+
+    for (unsigned i = 0; i < COUNTER_MAX; ++i) {
+        const int groupFd = counters->fds[CYCLES];
+        if ((i != CYCLES) && (groupFd < 0)) {
+            break;
+        }
+        counters->fds[i] = openCounter(COUNTER_CONFIGS[i], groupFd);
+        if (counters->fds[i] >= 0) {
+            counters->slots[i] = counters->groupSize++;
+        }
+    }
+
+    if ((counters->fds[CYCLES] < 0) && !unavailableLogged.exchange(true)) {
+        VLOG(1) << "hardware performance counters unavailable: " << strerror(errno)
+                << ", only timings are reported";
+    }
+    return counters;
+}
+
+} /* namespace */
+
+bool PerfCounters::read(PerfCounterValues & values) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    pthread_once(&keyOnce, createCountersKey);
+    ThreadCounters * counters = static_cast<ThreadCounters *>(pthread_getspecific(countersKey));
+    if (counters == NULL) {
+        counters = openThreadCounters();
+        pthread_setspecific(countersKey, counters);
+    }
+
+    if (counters->fds[CYCLES] < 0) {
+        return false;
+    }
+
+    // the group is read as the number of counters followed by their values
+    dmUint64 buffer[1 + COUNTER_MAX];
+    const ssize_t size = ::read(counters->fds[CYCLES], buffer, sizeof(buffer));
+    if ((size < static_cast<ssize_t>(sizeof(dmUint64))) || (buffer[0] != counters->groupSize)) {
+        return false;
+    }
+
+    dmUint64 * fields[COUNTER_MAX] = {
+            &values.cycles,
+            &values.instructions,
+            &values.cacheMisses,
+            &values.branchMisses
+    };
+    for (unsigned i = 0; i < COUNTER_MAX; ++i) {
+        *fields[i] = (counters->slots[i] >= 0) ? buffer[1 + counters->slots[i]] : 0;
+    }
+    return true;
+}
+
+} /* namespace */
+
+} /* namespace */
@@ -0,0 +1,23 @@
+/*
+ * PerfCountersWin32.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/PerfCounters.h"
+
+namespace dmscanlib {
+
+namespace util {
+
+/*
+ * Windows has no user space access to the hardware counters, only timings are
+ * reported.
+ */
+bool PerfCounters::read(PerfCounterValues & values) {
+    return false;
+}
+
+} /* namespace */
+
+} /* namespace */
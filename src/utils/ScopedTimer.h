@@ -0,0 +1,62 @@
+#ifndef SCOPEDTIMER_H_
+#define SCOPEDTIMER_H_
+
+/*
+ * ScopedTimer.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+#include "utils/PerfCounters.h"
+#include "utils/TraceRecorder.h"
+
+namespace dmscanlib {
+
+namespace util {
+
+/**
+ * Adds the time spent in the enclosing scope to one stage of a report, and traces
+ * the scope when a TraceRecorder is running. When the hardware performance
+ * counters are on, what they counted in the scope is added to the stage as well.
+ *
+ * The report type needs addStageTime(stage, nanos) and
+ * addStageCounters(stage, counters) members and a static getStageName(stage), see
+ * DecodeReport.
+ */
+template <typename Report, typename Stage>
+class ScopedTimer {
+public:
+    ScopedTimer(Report & _report, Stage _stage) :
+            report(_report),
+            stage(_stage),
+            trace(Report::getStageName(_stage)),
+            start(DmClock::nowNanos())
+    {
+    }
+
+    ~ScopedTimer() {
+        report.addStageTime(stage, DmClock::nowNanos() - start);
+
+        PerfCounterValues counters;
+        if (countersStart.getElapsed(counters)) {
+            report.addStageCounters(stage, counters);
+        }
+    }
+
+private:
+    ScopedTimer(const ScopedTimer &);
+    ScopedTimer & operator=(const ScopedTimer &);
+
+    Report & report;
+    const Stage stage;
+    const TraceScope trace;
+    const PerfCounterStart countersStart;
+    const dmUint64 start;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* SCOPEDTIMER_H_ */
@@ -0,0 +1,158 @@
+/*
+ * TraceRecorder.cpp
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/TraceRecorder.h"
+
+#include <fstream>
+#include <memory>
+#include <string.h>
+#include <vector>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#if defined (WIN32) && ! defined(__MINGW32__)
+#   define DM_THREAD_LOCAL __declspec(thread)
+#else
+#   define DM_THREAD_LOCAL __thread
+#endif
+
+namespace dmscanlib {
+
+namespace util {
+
+namespace {
+
+const unsigned EVENTS_RESERVED = 4096;
+
+// all the buffers of the current generation, only used to register a thread's
+// buffer and to write them out
+OpenThreads::Mutex buffersMutex;
+std::vector<std::unique_ptr<std::vector<TraceEvent> > > buffers;
+
+DM_THREAD_LOCAL std::vector<TraceEvent> * threadEvents = 0;
+DM_THREAD_LOCAL unsigned threadGeneration = 0;
+
+// the trace id of the decode the thread is working for
+DM_THREAD_LOCAL unsigned threadTraceId = 0;
+
+void writeEscaped(std::ostream & os, const char * str) {
+    for (; *str != '\0'; ++str) {
+        if ((*str == '"') || (*str == '\\')) {
+            os << '\\';
+        }
+        if (static_cast<unsigned char>(*str) >= 0x20) {
+            os << *str;
+        }
+    }
+}
+
+} /* namespace */
+
+std::atomic<bool> TraceRecorder::enabled(false);
+std::atomic<unsigned> TraceRecorder::generation(0);
+dmUint64 TraceRecorder::startNanos = 0;
+
+/*
+ * The threads that recorded into the old buffers worked for the previous traced
+ * decode, which has finished. The new generation is the trace id, threads notice
+ * it and register a new buffer.
+ */
+unsigned TraceRecorder::start() {
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+    unsigned traceId = generation.fetch_add(1) + 1;
+    if (traceId == 0) {
+        // zero is no trace, skipped when the ids wrap around
+        traceId = generation.fetch_add(1) + 1;
+    }
+    buffers.clear();
+    startNanos = DmClock::nowNanos();
+    enabled.store(true);
+    return traceId;
+}
+
+void TraceRecorder::stop() {
+    enabled.store(false);
+}
+
+unsigned TraceRecorder::getContext() {
+    return threadTraceId;
+}
+
+unsigned TraceRecorder::setContext(unsigned traceId) {
+    const unsigned previous = threadTraceId;
+    threadTraceId = traceId;
+    return previous;
+}
+
+bool TraceRecorder::isTracedThread() {
+    return (threadTraceId != 0)
+            && (threadTraceId == generation.load(std::memory_order_acquire));
+}
+
+/*
+ * Only the owning thread appends to its buffer. Callers check isEnabled() first.
+ */
+void TraceRecorder::record(char phase, const char * name, const char * detail) {
+    const unsigned currentGeneration = generation.load(std::memory_order_acquire);
+    if ((threadEvents == 0) || (threadGeneration != currentGeneration)) {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+        buffers.push_back(std::unique_ptr<std::vector<TraceEvent> >(
+                new std::vector<TraceEvent>()));
+        threadEvents = buffers.back().get();
+        threadEvents->reserve(EVENTS_RESERVED);
+        threadGeneration = currentGeneration;
+    }
+
+    TraceEvent event;
+    event.name = name;
+    event.detail[0] = '\0';
+    if (detail != 0) {
+        strncpy(event.detail, detail, sizeof(event.detail) - 1);
+        event.detail[sizeof(event.detail) - 1] = '\0';
+    }
+    event.phase = phase;
+    event.nanos = DmClock::nowNanos();
+    threadEvents->push_back(event);
+}
+
+bool TraceRecorder::writeJson(const std::string & filename) {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffersMutex);
+    bool first = true;
+
+    file << "{\"traceEvents\":[";
+    for (unsigned tid = 1, n = buffers.size(); tid <= n; ++tid) {
+        const std::vector<TraceEvent> & events = *buffers[tid - 1];
+
+        for (unsigned i = 0, m = events.size(); i < m; ++i) {
+            const TraceEvent & event = events[i];
+            const dmUint64 nanos = (event.nanos > startNanos) ? event.nanos - startNanos : 0;
+
+            file << (first ? "\n" : ",\n") << "{\"name\":\"";
+            writeEscaped(file, event.name);
+            file << "\",\"cat\":\"dmscanlib\",\"ph\":\"" << event.phase
+                 << "\",\"ts\":" << (nanos / 1000) << "." << ((nanos % 1000) / 100)
+                 << ",\"pid\":1,\"tid\":" << tid;
+            if (event.detail[0] != '\0') {
+                file << ",\"args\":{\"detail\":\"";
+                writeEscaped(file, event.detail);
+                file << "\"}";
+            }
+            file << "}";
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return file.good();
+}
+
+} /* namespace */
+
+} /* namespace */
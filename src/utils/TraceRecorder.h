@@ -0,0 +1,140 @@
+#ifndef TRACERECORDER_H_
+#define TRACERECORDER_H_
+
+/*
+ * TraceRecorder.h
+ *
+ *  Created on: 2026-10-18
+ */
+
+#include "utils/DmClock.h"
+
+#include <atomic>
+#include <string>
+
+namespace dmscanlib {
+
+namespace util {
+
+struct TraceEvent {
+    const char * name;
+    char detail[32];
+    char phase;
+    dmUint64 nanos;
+};
+
+/**
+ * Records begin and end events for the decode timeline and writes them in the
+ * Chrome trace event format, for chrome://tracing or Perfetto.
+ *
+ * One decode is traced at a time. Only the threads working for it, those inside a
+ * TraceContext for the id start() returned, record events, so decodes running at
+ * the same time are left out of the timeline and never touch its buffers. start()
+ * and writeJson() must not be called while the traced decode is running.
+ *
+ * Every thread appends to its own buffer, so recording takes no locks. When
+ * tracing is off the only cost is the isEnabled() test.
+ */
+class TraceRecorder {
+public:
+    /*
+     * True when tracing is on and the calling thread works for the traced decode.
+     */
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed) && isTracedThread();
+    }
+
+    /*
+     * Discards the events recorded so far, turns tracing on and returns the id of
+     * the new trace, which is never zero.
+     */
+    static unsigned start();
+
+    static void stop();
+
+    /*
+     * The trace id of the calling thread's TraceContext, or zero outside of one.
+     */
+    static unsigned getContext();
+
+    /*
+     * name must point to a string that outlives the recorder, normally a literal.
+     * detail is copied and may be truncated.
+     */
+    static void record(char phase, const char * name, const char * detail);
+
+    static bool writeJson(const std::string & filename);
+
+private:
+    TraceRecorder();
+
+    friend class TraceContext;
+
+    static bool isTracedThread();
+
+    /*
+     * Returns the id the thread had before.
+     */
+    static unsigned setContext(unsigned traceId);
+
+    static std::atomic<bool> enabled;
+    static std::atomic<unsigned> generation;
+    static dmUint64 startNanos;
+};
+
+/**
+ * Marks the calling thread as working for a decode while in scope, with the trace
+ * id the decode was started with. The thread's previous id is restored after.
+ */
+class TraceContext {
+public:
+    TraceContext(unsigned traceId) :
+            previous(TraceRecorder::setContext(traceId))
+    {
+    }
+
+    ~TraceContext() {
+        TraceRecorder::setContext(previous);
+    }
+
+private:
+    TraceContext(const TraceContext &);
+    TraceContext & operator=(const TraceContext &);
+
+    const unsigned previous;
+};
+
+/**
+ * Records a begin event when constructed and the matching end event when it
+ * goes out of scope, if tracing is on.
+ */
+class TraceScope {
+public:
+    TraceScope(const char * _name, const char * detail = 0) :
+            name(_name),
+            active(TraceRecorder::isEnabled())
+    {
+        if (active) {
+            TraceRecorder::record('B', name, detail);
+        }
+    }
+
+    ~TraceScope() {
+        if (active) {
+            TraceRecorder::record('E', name, 0);
+        }
+    }
+
+private:
+    TraceScope(const TraceScope &);
+    TraceScope & operator=(const TraceScope &);
+
+    const char * name;
+    const bool active;
+};
+
+} /* namespace */
+
+} /* namespace */
+
+#endif /* TRACERECORDER_H_ */
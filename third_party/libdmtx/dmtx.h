@@ -166,6 +166,7 @@ typedef enum {
    DmtxPropSquareDevn,
    DmtxPropSymbolSize,
    DmtxPropEdgeThresh,
+   DmtxPropSubPixel,
    /* Image properties */
    DmtxPropWidth             = 300,
    DmtxPropHeight,
@@ -432,6 +433,36 @@ typedef struct DmtxTime_struct {
    unsigned long   usec;
 } DmtxTime;
 
+/**
+ * @struct DmtxDecodeStats
+ * @brief Search effort counters, gathered over the life of a DmtxDecode
+ */
+typedef struct DmtxDecodeStats_struct {
+   long            gridLocations;    /* Scan grid locations popped */
+   long            seekEdgeCalls;    /* MatrixRegionSeekEdge() calls */
+   long            failOrientation;  /* Regions rejected finding the orientation */
+   long            failTopEdge;      /* Regions rejected aligning the top calibration edge */
+   long            failRightEdge;    /* Regions rejected aligning the right calibration edge */
+   long            failFindSize;     /* Regions rejected by MatrixRegionFindSize() */
+   long            failDecode;       /* Regions whose modules did not error correct */
+   long            regionsFound;     /* Regions returned by dmtxRegionFindNext() */
+   long            pixelsSampled;    /* Calls to dmtxDecodeGetPixelValue() */
+} DmtxDecodeStats;
+
+/**
+ * @struct DmtxDecodeSettings
+ * @brief Decoding behavior properties, set all at once by dmtxDecodeCreateWithSettings()
+ */
+typedef struct DmtxDecodeSettings_struct {
+   int             edgeMin;
+   int             edgeMax;
+   int             scanGap;
+   double          squareDevn;       /* Cosine of the allowed deviation */
+   int             sizeIdxExpected;
+   int             edgeThresh;
+   int             subPixel;
+} DmtxDecodeSettings;
+
 /**
  * @struct DmtxDecode
  * @brief DmtxDecode
@@ -444,6 +475,7 @@ typedef struct DmtxDecode_struct {
    double          squareDevn;
    int             sizeIdxExpected;
    int             edgeThresh;
+   int             subPixel;
 
    /* Image modifiers */
    int             xMin;
@@ -457,6 +489,7 @@ typedef struct DmtxDecode_struct {
    unsigned char  *cache;
    DmtxImage      *image;
    DmtxScanGrid    grid;
+   DmtxDecodeStats stats;
 } DmtxDecode;
 
 /**
@@ -534,15 +567,24 @@ extern DmtxPassFail dmtxEncodeDataMosaic(DmtxEncode *enc, int n, unsigned char *
 
 /* dmtxdecode.c */
 extern DmtxDecode *dmtxDecodeCreate(DmtxImage *img, int scale);
+extern DmtxDecode *dmtxDecodeCreateWithSettings(DmtxImage *img, int scale, const DmtxDecodeSettings *settings, const DmtxScanGrid *grid);
+extern DmtxPassFail dmtxDecodeSettingsInit(DmtxDecodeSettings *settings, int edgeMin, int edgeMax, int scanGap, int squareDevn, int sizeIdxExpected, int edgeThresh, int subPixel);
 extern DmtxPassFail dmtxDecodeDestroy(DmtxDecode **dec);
 extern DmtxPassFail dmtxDecodeSetProp(DmtxDecode *dec, int prop, int value);
 extern int dmtxDecodeGetProp(DmtxDecode *dec, int prop);
 extern /*@exposed@*/ unsigned char *dmtxDecodeGetCache(DmtxDecode *dec, int x, int y);
 extern DmtxPassFail dmtxDecodeGetPixelValue(DmtxDecode *dec, int x, int y, int channel, /*@out@*/ int *value);
+extern DmtxPassFail dmtxDecodeGetPixelValueBilinear(DmtxDecode *dec, double x, double y, int channel, /*@out@*/ int *value);
+extern DmtxDecodeStats dmtxDecodeGetStats(DmtxDecode *dec);
 extern DmtxMessage *dmtxDecodeMatrixRegion(DmtxDecode *dec, DmtxRegion *reg, int fix);
+extern DmtxMessage *dmtxDecodeMatrixRegionPopulate(DmtxDecode *dec, DmtxRegion *reg);
+extern DmtxMessage *dmtxDecodeMatrixRegionFinish(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg, int fix);
 extern DmtxMessage *dmtxDecodeMosaicRegion(DmtxDecode *dec, DmtxRegion *reg, int fix);
 extern unsigned char *dmtxDecodeCreateDiagnostic(DmtxDecode *dec, /*@out@*/ int *totalBytes, /*@out@*/ int *headerBytes, int style);
 
+/* dmtxscangrid.c */
+extern DmtxScanGrid dmtxScanGridCreate(int width, int height, int scale, int scanGap);
+
 /* dmtxregion.c */
 extern DmtxRegion *dmtxRegionCreate(DmtxRegion *reg);
 extern DmtxPassFail dmtxRegionDestroy(DmtxRegion **reg);
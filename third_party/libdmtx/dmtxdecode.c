@@ -19,6 +19,110 @@
  */
 extern DmtxDecode *
 dmtxDecodeCreate(DmtxImage *img, int scale)
+{
+   DmtxDecode *dec;
+
+   dec = DecodeAlloc(img, scale);
+   if(dec == NULL)
+      return NULL;
+
+   dec->grid = InitScanGrid(dec);
+
+   return dec;
+}
+
+/**
+ * \brief  Initialize decode struct with all decoding properties at once
+ *
+ * Setting the properties one at a time reinitializes the scan grid every
+ * time. Here it is initialized once, or copied from grid when that was made
+ * by dmtxScanGridCreate() for an image of the same size and scale.
+ *
+ * \param  img
+ * \param  scale
+ * \param  settings Filled in by dmtxDecodeSettingsInit()
+ * \param  grid Precomputed scan grid, or NULL
+ * \return Initialized DmtxDecode struct
+ */
+extern DmtxDecode *
+dmtxDecodeCreateWithSettings(DmtxImage *img, int scale, const DmtxDecodeSettings *settings,
+      const DmtxScanGrid *grid)
+{
+   DmtxDecode *dec;
+
+   dec = DecodeAlloc(img, scale);
+   if(dec == NULL)
+      return NULL;
+
+   dec->edgeMin = settings->edgeMin;
+   dec->edgeMax = settings->edgeMax;
+   dec->scanGap = settings->scanGap;
+   dec->squareDevn = settings->squareDevn;
+   dec->sizeIdxExpected = settings->sizeIdxExpected;
+   dec->edgeThresh = settings->edgeThresh;
+   dec->subPixel = settings->subPixel;
+
+   if(grid != NULL && grid->xMin == dec->xMin && grid->xMax == dec->xMax &&
+         grid->yMin == dec->yMin && grid->yMax == dec->yMax)
+      dec->grid = *grid;
+   else
+      dec->grid = InitScanGrid(dec);
+
+   return dec;
+}
+
+/**
+ * \brief  Fill in decoding properties, with the same checks as dmtxDecodeSetProp()
+ *
+ * A rejected scan gap, square deviation or edge threshold keeps the default
+ * that dmtxDecodeCreate() sets, the other properties are filled in regardless.
+ *
+ * \param  settings
+ * \param  squareDevn Allowed deviation from square, in degrees
+ * \return DmtxPass | DmtxFail if any property was rejected
+ */
+extern DmtxPassFail
+dmtxDecodeSettingsInit(DmtxDecodeSettings *settings, int edgeMin, int edgeMax, int scanGap,
+      int squareDevn, int sizeIdxExpected, int edgeThresh, int subPixel)
+{
+   DmtxPassFail result = DmtxPass;
+   double cosDevn;
+
+   settings->edgeMin = edgeMin;
+   settings->edgeMax = edgeMax;
+   settings->sizeIdxExpected = sizeIdxExpected;
+   settings->subPixel = (subPixel) ? DmtxTrue : DmtxFalse;
+
+   settings->scanGap = scanGap;
+   if(scanGap < 1) {
+      settings->scanGap = 1;
+      result = DmtxFail;
+   }
+
+   cosDevn = cos(squareDevn * (M_PI/180.0));
+   settings->squareDevn = cosDevn;
+   if(cosDevn <= 0.0 || cosDevn >= 1.0) {
+      settings->squareDevn = cos(50 * (M_PI/180));
+      result = DmtxFail;
+   }
+
+   settings->edgeThresh = edgeThresh;
+   if(edgeThresh < 1 || edgeThresh > 100) {
+      settings->edgeThresh = 10;
+      result = DmtxFail;
+   }
+
+   return result;
+}
+
+/**
+ * \brief  Allocate decode struct with default values, without a scan grid
+ * \param  img
+ * \param  scale
+ * \return Allocated DmtxDecode struct
+ */
+static DmtxDecode *
+DecodeAlloc(DmtxImage *img, int scale)
 {
    DmtxDecode *dec;
    int width, height;
@@ -36,6 +140,7 @@ dmtxDecodeCreate(DmtxImage *img, int scale)
    dec->squareDevn = cos(50 * (M_PI/180));
    dec->sizeIdxExpected = DmtxSymbolShapeAuto;
    dec->edgeThresh = 10;
+   dec->subPixel = DmtxFalse;
 
    dec->xMin = 0;
    dec->xMax = width - 1;
@@ -50,7 +155,6 @@ dmtxDecodeCreate(DmtxImage *img, int scale)
    }
 
    dec->image = img;
-   dec->grid = InitScanGrid(dec);
 
    return dec;
 }
@@ -105,6 +209,9 @@ dmtxDecodeSetProp(DmtxDecode *dec, int prop, int value)
       case DmtxPropEdgeThresh:
          dec->edgeThresh = value;
          break;
+      case DmtxPropSubPixel:
+         dec->subPixel = (value) ? DmtxTrue : DmtxFalse;
+         break;
       /* Min and Max values arrive unscaled */
       case DmtxPropXmin:
          dec->xMin = value / dec->scale;
@@ -159,6 +266,8 @@ dmtxDecodeGetProp(DmtxDecode *dec, int prop)
          return dec->sizeIdxExpected;
       case DmtxPropEdgeThresh:
          return dec->edgeThresh;
+      case DmtxPropSubPixel:
+         return dec->subPixel;
       case DmtxPropXmin:
          return dec->xMin;
       case DmtxPropXmax:
@@ -243,10 +352,57 @@ dmtxDecodeGetPixelValue(DmtxDecode *dec, int x, int y, int channel, int *value)
    return correctedPoint; */
 
    err = dmtxImageGetPixelValue(dec->image, xUnscaled, yUnscaled, channel, value);
+   dec->stats.pixelsSampled++;
 
    return err;
 }
 
+/**
+ * \brief  Return the search effort counters gathered since dmtxDecodeCreate()
+ * \param  dec
+ * \return Counters
+ */
+extern DmtxDecodeStats
+dmtxDecodeGetStats(DmtxDecode *dec)
+{
+   return dec->stats;
+}
+
+/**
+ * \brief  Read pixel value at a sub-pixel location by bilinear interpolation
+ *         of the 4 surrounding pixels
+ * \param  dec
+ * \param  x Scaled x coordinate
+ * \param  y Scaled y coordinate
+ * \param  channel
+ * \param  value
+ * \return DmtxPass | DmtxFail
+ */
+extern DmtxPassFail
+dmtxDecodeGetPixelValueBilinear(DmtxDecode *dec, double x, double y, int channel, int *value)
+{
+   int x0, y0;
+   int v00, v10, v01, v11;
+   double fx, fy;
+
+   x0 = (int)floor(x);
+   y0 = (int)floor(y);
+   fx = x - x0;
+   fy = y - y0;
+
+   /* Fall back to the nearest pixel along the image border */
+   if(dmtxDecodeGetPixelValue(dec, x0, y0, channel, &v00) == DmtxFail ||
+         dmtxDecodeGetPixelValue(dec, x0 + 1, y0, channel, &v10) == DmtxFail ||
+         dmtxDecodeGetPixelValue(dec, x0, y0 + 1, channel, &v01) == DmtxFail ||
+         dmtxDecodeGetPixelValue(dec, x0 + 1, y0 + 1, channel, &v11) == DmtxFail)
+      return dmtxDecodeGetPixelValue(dec, (int)(x + 0.5), (int)(y + 0.5), channel, value);
+
+   *value = (int)((1.0 - fy) * ((1.0 - fx) * v00 + fx * v10) +
+         fy * ((1.0 - fx) * v01 + fx * v11) + 0.5);
+
+   return DmtxPass;
+}
+
 /**
  * \brief  Fill the region covered by the quadrilateral given by (p0,p1,p2,p3) in the cache.
  */
@@ -317,8 +473,24 @@ extern DmtxMessage *
 dmtxDecodeMatrixRegion(DmtxDecode *dec, DmtxRegion *reg, int fix)
 {
    DmtxMessage *msg;
-   DmtxVector2 topLeft, topRight, bottomLeft, bottomRight;
-   DmtxPixelLoc pxTopLeft, pxTopRight, pxBottomLeft, pxBottomRight;
+
+   msg = dmtxDecodeMatrixRegionPopulate(dec, reg);
+   if(msg == NULL)
+      return NULL;
+
+   return dmtxDecodeMatrixRegionFinish(dec, reg, msg, fix);
+}
+
+/**
+ * \brief  Read module values of fitted Data Matrix region into a new message
+ * \param  dec
+ * \param  reg
+ * \return Message with populated module array, or NULL
+ */
+extern DmtxMessage *
+dmtxDecodeMatrixRegionPopulate(DmtxDecode *dec, DmtxRegion *reg)
+{
+   DmtxMessage *msg;
 
    msg = dmtxMessageCreate(reg->sizeIdx, DmtxFormatMatrix);
    if(msg == NULL)
@@ -329,14 +501,39 @@ dmtxDecodeMatrixRegion(DmtxDecode *dec, DmtxRegion *reg, int fix)
       return NULL;
    }
 
-   /* maybe place remaining logic into new dmtxDecodePopulatedArray()
-      function so other people can pass in their own arrays */
+   return msg;
+}
+
+/**
+ * \brief  Error correct and decode a message populated by
+ *         dmtxDecodeMatrixRegionPopulate()
+ * \param  dec
+ * \param  reg
+ * \param  msg Populated message, destroyed if decoding fails
+ * \param  fix
+ * \return Decoded message, or NULL
+ */
+extern DmtxMessage *
+dmtxDecodeMatrixRegionFinish(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg, int fix)
+{
+   DmtxVector2 topLeft, topRight, bottomLeft, bottomRight;
+   DmtxPixelLoc pxTopLeft, pxTopRight, pxBottomLeft, pxBottomRight;
+   unsigned char *unsure;
+   int corrected;
+   DmtxPassFail passFail;
 
    ModulePlacementEcc200(msg->array, msg->code,
          reg->sizeIdx, DmtxModuleOnRed | DmtxModuleOnGreen | DmtxModuleOnBlue);
 
-   if(RsDecode(msg->code, reg->sizeIdx, fix) == DmtxFail)
+   /* Unsure module counts per codeword let RsDecode() fall back to erasures */
+   unsure = CountUnsureModules(msg, reg->sizeIdx);
+   passFail = RsDecode(msg->code, unsure, reg->sizeIdx, fix, &corrected);
+   free(unsure);
+   DMTX_PROBE3(rs__corrections, reg->sizeIdx, corrected, passFail);
+
+   if(passFail == DmtxFail)
    {
+      dec->stats.failDecode++;
       dmtxMessageDestroy(&msg);
       return NULL;
    }
@@ -365,6 +562,52 @@ dmtxDecodeMatrixRegion(DmtxDecode *dec, DmtxRegion *reg, int fix)
    return msg;
 }
 
+/**
+ * \brief  Count modules marked unsure in each codeword
+ * \param  msg
+ * \param  sizeIdx
+ * \return Array of msg->codeSize counts, or NULL if no module is unsure
+ */
+static unsigned char *
+CountUnsureModules(DmtxMessage *msg, int sizeIdx)
+{
+   size_t i;
+   int bit, count;
+   unsigned char *array, *unsure;
+
+   for(i = 0; i < msg->arraySize; i++) {
+      if(msg->array[i] & DmtxModuleUnsure)
+         break;
+   }
+   if(i == msg->arraySize)
+      return NULL;
+
+   array = (unsigned char *)malloc(msg->arraySize);
+   unsure = (unsigned char *)calloc(msg->codeSize, sizeof(unsigned char));
+   if(array == NULL || unsure == NULL) {
+      free(array);
+      free(unsure);
+      return NULL;
+   }
+
+   /* Place the unsure flags as if they were module values, so each codeword
+      bit is set where its module was unsure */
+   for(i = 0; i < msg->arraySize; i++)
+      array[i] = DmtxModuleAssigned | ((msg->array[i] & DmtxModuleUnsure) ? DmtxModuleOnRed : 0);
+
+   ModulePlacementEcc200(array, unsure, sizeIdx, DmtxModuleOnRed);
+
+   for(i = 0; i < msg->codeSize; i++) {
+      for(count = 0, bit = unsure[i]; bit != 0; bit &= (bit - 1))
+         count++;
+      unsure[i] = (unsigned char)count;
+   }
+
+   free(array);
+
+   return unsure;
+}
+
 /**
  * \brief  Convert fitted Data Mosaic region into a decoded message
  * \param  dec
@@ -518,8 +761,8 @@ dmtxDecodeCreateDiagnostic(DmtxDecode *dec, int *totalBytes, int *headerBytes, i
 
 /**
  * \brief  Increment counters used to determine module values
- * \param  img
  * \param  reg
+ * \param  moduleColors Module colors read by PopulateArrayFromMatrix()
  * \param  tally
  * \param  xOrigin
  * \param  yOrigin
@@ -529,7 +772,7 @@ dmtxDecodeCreateDiagnostic(DmtxDecode *dec, int *totalBytes, int *headerBytes, i
  * \return void
  */
 static void
-TallyModuleJumps(DmtxDecode *dec, DmtxRegion *reg, int tally[][24], int xOrigin, int yOrigin, int mapWidth, int mapHeight, DmtxDirection dir)
+TallyModuleJumps(DmtxRegion *reg, int *moduleColors, int tally[][24], int xOrigin, int yOrigin, int mapWidth, int mapHeight, DmtxDirection dir)
 {
    int extent, weight;
    int travelStep;
@@ -583,7 +826,7 @@ TallyModuleJumps(DmtxDecode *dec, DmtxRegion *reg, int tally[][24], int xOrigin,
          decide status based on predictable barcode border pattern */
 
       *travel = travelStart;
-      color = ReadModuleColor(dec, reg, symbolRow, symbolCol, reg->sizeIdx, reg->flowBegin.plane);
+      color = moduleColors[symbolRow * reg->symbolCols + symbolCol];
       tModule = (darkOnLight) ? reg->offColor - color : color - reg->offColor;
 
       statusModule = (travelStep == 1 || (*line & 0x01) == 0) ? DmtxModuleOnRGB : DmtxModuleOff;
@@ -598,7 +841,7 @@ TallyModuleJumps(DmtxDecode *dec, DmtxRegion *reg, int tally[][24], int xOrigin,
          /* For normal data-bearing modules capture color and decide
             module status based on comparison to previous "known" module */
 
-         color = ReadModuleColor(dec, reg, symbolRow, symbolCol, reg->sizeIdx, reg->flowBegin.plane);
+         color = moduleColors[symbolRow * reg->symbolCols + symbolCol];
          tModule = (darkOnLight) ? reg->offColor - color : color - reg->offColor;
 
          if(statusPrev == DmtxModuleOnRGB) {
@@ -646,9 +889,24 @@ PopulateArrayFromMatrix(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg)
    int mapCol, mapRow;
    int colTmp, rowTmp, idx;
    int tally[24][24]; /* Large enough to map largest single region */
+   int *moduleColors;
+   int symbolRow;
+   int color, colorMid, colorRange;
+   double ratio;
 
 /* memset(msg->array, 0x00, msg->arraySize); */
 
+   /* Sample every module once, the tallies below visit each module from
+      all 4 directions */
+   moduleColors = (int *)malloc(reg->symbolRows * reg->symbolCols * sizeof(int));
+   if(moduleColors == NULL)
+      return DmtxFail;
+
+   for(symbolRow = 0; symbolRow < reg->symbolRows; symbolRow++)
+      ReadModuleColorLine(dec, reg, symbolRow, 0, DmtxDirRight, reg->symbolCols,
+            reg->sizeIdx, reg->flowBegin.plane, dec->subPixel,
+            &moduleColors[symbolRow * reg->symbolCols]);
+
    /* Capture number of regions present in barcode */
    xRegionTotal = dmtxGetSymbolAttribute(DmtxSymAttribHorizDataRegions, reg->sizeIdx);
    yRegionTotal = dmtxGetSymbolAttribute(DmtxSymAttribVertDataRegions, reg->sizeIdx);
@@ -660,6 +918,9 @@ PopulateArrayFromMatrix(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg)
    weightFactor = 2 * (mapHeight + mapWidth + 2);
    assert(weightFactor > 0);
 
+   colorMid = (reg->onColor + reg->offColor) / 2;
+   colorRange = abs(reg->onColor - reg->offColor) / 2;
+
    /* Tally module changes for each region in each direction */
    for(yRegionCount = 0; yRegionCount < yRegionTotal; yRegionCount++) {
 
@@ -672,10 +933,10 @@ PopulateArrayFromMatrix(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg)
          xOrigin = xRegionCount * (mapWidth + 2) + 1;
 
          memset(tally, 0x00, 24 * 24 * sizeof(int));
-         TallyModuleJumps(dec, reg, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirUp);
-         TallyModuleJumps(dec, reg, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirLeft);
-         TallyModuleJumps(dec, reg, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirDown);
-         TallyModuleJumps(dec, reg, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirRight);
+         TallyModuleJumps(reg, moduleColors, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirUp);
+         TallyModuleJumps(reg, moduleColors, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirLeft);
+         TallyModuleJumps(reg, moduleColors, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirDown);
+         TallyModuleJumps(reg, moduleColors, tally, xOrigin, yOrigin, mapWidth, mapHeight, DmtxDirRight);
 
          /* Decide module status based on final tallies */
          for(mapRow = 0; mapRow < mapHeight; mapRow++) {
@@ -686,16 +947,26 @@ PopulateArrayFromMatrix(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg)
                colTmp = (xRegionCount * mapWidth) + mapCol;
                idx = (rowTmp * xRegionTotal * mapWidth) + colTmp;
 
-               if(tally[mapRow][mapCol]/(double)weightFactor >= 0.5)
+               ratio = tally[mapRow][mapCol]/(double)weightFactor;
+               if(ratio >= 0.5)
                   msg->array[idx] = DmtxModuleOnRGB;
                else
                   msg->array[idx] = DmtxModuleOff;
 
                msg->array[idx] |= DmtxModuleAssigned;
+
+               /* Flag modules whose tallies disagree or whose color sits
+                  close to the midpoint between on and off */
+               color = moduleColors[(yOrigin + mapRow) * reg->symbolCols + xOrigin + mapCol];
+               if(fabs(ratio - 0.5) < DmtxUnsureTallyMargin ||
+                     abs(color - colorMid) < DmtxUnsureColorMargin * colorRange)
+                  msg->array[idx] |= DmtxModuleUnsure;
             }
          }
       }
    }
 
+   free(moduleColors);
+
    return DmtxPass;
 }
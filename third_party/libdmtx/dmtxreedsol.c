@@ -23,6 +23,7 @@
 
 #define NN                      255
 #define MAX_ERROR_WORD_COUNT     68
+#define RsMinCheckWords           2
 
 /* GF add (a + b) */
 #define GfAdd(a,b) \
@@ -137,23 +138,31 @@ RsEncode(DmtxMessage *message, int sizeIdx)
 /**
  * Decode xyz.
  * More detailed description.
+ * When a block has more errors than errors-only decoding can repair, and
+ * unsure counts are available, the block is decoded again treating its
+ * least reliable codewords as erasures.
  * \param code
+ * \param unsure Number of unsure modules in each codeword, or NULL
  * \param sizeIdx
- * \param fix
+ * \param fix Most codewords erasure repairs may change in the symbol, or DmtxUndefined
+ * \param corrected Set to the number of codewords repaired, or NULL
  * \return Function success (DmtxPass|DmtxFail)
  */
 #undef CHKPASS
 #define CHKPASS { if(passFail == DmtxFail) return DmtxFail; }
 static DmtxPassFail
-RsDecode(unsigned char *code, int sizeIdx, int fix)
+RsDecode(unsigned char *code, const unsigned char *unsure, int sizeIdx, int fix, int *corrected)
 {
    int i;
+   int repaired;
+   unsigned char value;
    int blockStride, blockIdx;
    int blockDataWords, blockErrorWords, blockTotalWords, blockMaxCorrectable;
    int symbolDataWords, symbolErrorWords, symbolTotalWords;
    DmtxBoolean error, repairable;
    DmtxPassFail passFail;
    unsigned char *word;
+   DmtxByte recUnsure[NN];
    DmtxByte elpStorage[MAX_ERROR_WORD_COUNT];
    DmtxByte synStorage[MAX_ERROR_WORD_COUNT+1];
    DmtxByte recStorage[NN];
@@ -169,6 +178,10 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
    symbolDataWords = dmtxGetSymbolAttribute(DmtxSymAttribSymbolDataWords, sizeIdx);
    symbolErrorWords = dmtxGetSymbolAttribute(DmtxSymAttribSymbolErrorWords, sizeIdx);
    symbolTotalWords = symbolDataWords + symbolErrorWords;
+   repaired = 0;
+
+   if(corrected != NULL)
+      *corrected = 0;
 
    /* For each interleaved block */
    for(blockIdx = 0; blockIdx < blockStride; blockIdx++)
@@ -184,6 +197,8 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
       word = code + symbolTotalWords + blockIdx - blockStride;
       for(i = 0; i < blockErrorWords; i++)
       {
+         if(unsure != NULL)
+            recUnsure[rec.length] = unsure[word - code];
          dmtxByteListPush(&rec, *word, &passFail); CHKPASS;
          word -= blockStride;
       }
@@ -192,6 +207,8 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
       word = code + blockIdx + (blockStride * (blockDataWords - 1));
       for(i = 0; i < blockDataWords; i++)
       {
+         if(unsure != NULL)
+            recUnsure[rec.length] = unsure[word - code];
          dmtxByteListPush(&rec, *word, &passFail); CHKPASS;
          word -= blockStride;
       }
@@ -204,16 +221,17 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
       {
          /* Find error locator polynomial (elp) */
          repairable = RsFindErrorLocatorPoly(&elp, &syn, blockErrorWords, blockMaxCorrectable);
-         if(!repairable)
-            return DmtxFail;
 
          /* Find error positions (loc) */
-         repairable = RsFindErrorLocations(&loc, &elp);
-         if(!repairable)
-            return DmtxFail;
+         if(repairable)
+            repairable = RsFindErrorLocations(&loc, &elp);
 
          /* Find error values and repair */
-         RsRepairErrors(&rec, &loc, &elp, &syn);
+         if(repairable)
+            RsRepairErrors(&rec, &loc, &elp, &syn);
+         else if(unsure == NULL || !RsRepairErasures(&rec, recUnsure, &syn, blockErrorWords,
+               (fix == DmtxUndefined) ? DmtxUndefined : max(fix - repaired, 0)))
+            return DmtxFail;
       }
 
       /*
@@ -224,7 +242,9 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
       word = code + blockIdx;
       for(i = 0; i < blockDataWords; i++)
       {
-         *word = dmtxByteListPop(&rec, &passFail); CHKPASS;
+         value = dmtxByteListPop(&rec, &passFail); CHKPASS;
+         repaired += (*word != value);
+         *word = value;
          word += blockStride;
       }
 
@@ -232,11 +252,16 @@ RsDecode(unsigned char *code, int sizeIdx, int fix)
       word = code + symbolDataWords + blockIdx;
       for(i = 0; i < blockErrorWords; i++)
       {
-         *word = dmtxByteListPop(&rec, &passFail); CHKPASS;
+         value = dmtxByteListPop(&rec, &passFail); CHKPASS;
+         repaired += (*word != value);
+         *word = value;
          word += blockStride;
       }
    }
 
+   if(corrected != NULL)
+      *corrected = repaired;
+
    return DmtxPass;
 }
 
@@ -493,3 +518,216 @@ RsRepairErrors(DmtxByteList *rec, const DmtxByteList *loc, const DmtxByteList *e
 
    return DmtxPass;
 }
+
+/**
+ * Repair a block using its unsure codewords as erasures.
+ * A block with s erasures and e errors can be repaired when 2e + s does not
+ * exceed the number of error words, so marking the codewords that were read
+ * with low confidence as erasures roughly doubles the damage that can be
+ * repaired. RsMinCheckWords error words are always kept out of 2e + s so that
+ * a wrong repair is still detected by the final syndrome check.
+ *
+ * Every attempt is one more chance for a damaged block to pass that check, so
+ * only two are made: all unsure codewords, most unsure first, then only the
+ * codewords with more than one unsure module.
+ * \param rec
+ * \param recUnsure Unsure count for each codeword in rec
+ * \param syn Syndromes computed for rec
+ * \param blockErrorWords
+ * \param maxFixed Most codewords the repair may change, or DmtxUndefined
+ * \return Is block repaired? (DmtxTrue|DmtxFalse)
+ */
+static DmtxBoolean
+RsRepairErasures(DmtxByteList *rec, const DmtxByte *recUnsure, const DmtxByteList *syn, int blockErrorWords, int maxFixed)
+{
+   int i, j, count, strong, maxErasures;
+   int erasures[NN];
+
+   /* Sort unsure positions by decreasing unsure count */
+   for(count = 0, i = 0; i < rec->length; i++)
+   {
+      if(recUnsure[i] == 0)
+         continue;
+
+      for(j = count++; j > 0 && recUnsure[erasures[j-1]] < recUnsure[i]; j--)
+         erasures[j] = erasures[j-1];
+      erasures[j] = i;
+   }
+
+   maxErasures = min(count, blockErrorWords - RsMinCheckWords);
+   if(maxErasures <= 0)
+      return DmtxFalse;
+
+   if(RsCorrectErasures(rec, erasures, maxErasures, syn, blockErrorWords, maxFixed))
+      return DmtxTrue;
+
+   for(strong = 0; strong < maxErasures && recUnsure[erasures[strong]] > 1; strong++)
+      ;
+
+   if(strong == 0 || strong == maxErasures)
+      return DmtxFalse;
+
+   return RsCorrectErasures(rec, erasures, strong, syn, blockErrorWords, maxFixed);
+}
+
+/**
+ * Errors-and-erasures decoding of a single block (Berlekamp-Massey on the
+ * Forney syndromes, Chien search and Forney's algorithm for the values).
+ * \param rec Received block, only modified when the repair succeeds
+ * \param erasures Erasure positions in rec
+ * \param erasureCount
+ * \param syn Syndromes computed for rec
+ * \param blockErrorWords
+ * \param maxFixed Most codewords the repair may change, or DmtxUndefined
+ * \return Is block repaired? (DmtxTrue|DmtxFalse)
+ */
+static DmtxBoolean
+RsCorrectErasures(DmtxByteList *rec, const int *erasures, int erasureCount, const DmtxByteList *syn, int blockErrorWords, int maxFixed)
+{
+   int i, j, k, m, n, fixedCount;
+   int lambdaDeg, gammaDeg, psiDeg, errorDeg;
+   int foundCount, found[MAX_ERROR_WORD_COUNT];
+   DmtxByte d, b, coef, value, num, den, xInv;
+   DmtxByte gamma[MAX_ERROR_WORD_COUNT+1];   /* Erasure locator */
+   DmtxByte forney[MAX_ERROR_WORD_COUNT+1];  /* Syndromes times erasure locator */
+   DmtxByte lambda[MAX_ERROR_WORD_COUNT+1];  /* Error locator */
+   DmtxByte prev[MAX_ERROR_WORD_COUNT+1];
+   DmtxByte tmp[MAX_ERROR_WORD_COUNT+1];
+   DmtxByte psi[MAX_ERROR_WORD_COUNT+1];     /* Errors and erasures locator */
+   DmtxByte omega[MAX_ERROR_WORD_COUNT+1];   /* Error evaluator */
+   DmtxByte fixed[NN];
+
+   assert(erasureCount > 0 && erasureCount <= blockErrorWords - RsMinCheckWords);
+
+   /* Erasure locator gamma(x) = product of (1 + X x) for each erasure X */
+   memset(gamma, 0x00, sizeof(gamma));
+   gamma[0] = 1;
+   for(gammaDeg = 0, k = 0; k < erasureCount; k++)
+   {
+      for(j = ++gammaDeg; j > 0; j--)
+         gamma[j] = GfAdd(gamma[j], GfMultAntilog(gamma[j-1], erasures[k]));
+   }
+
+   /* Forney syndromes: coefficients of S(x) * gamma(x) beyond the erasures */
+   for(i = 0; i < blockErrorWords; i++)
+   {
+      for(value = 0, j = 0; j <= min(i, gammaDeg); j++)
+         value = GfAdd(value, GfMult(gamma[j], syn->b[i-j+1]));
+      forney[i] = value;
+   }
+
+   /* Berlekamp-Massey for the error locator using the remaining syndromes */
+   memset(lambda, 0x00, sizeof(lambda));
+   memset(prev, 0x00, sizeof(prev));
+   lambda[0] = prev[0] = 1;
+   lambdaDeg = 0;
+   m = 1;
+   b = 1;
+   n = blockErrorWords - erasureCount;
+   for(i = 0; i < n; i++)
+   {
+      for(d = forney[i+erasureCount], j = 1; j <= lambdaDeg; j++)
+         d = GfAdd(d, GfMult(lambda[j], forney[i+erasureCount-j]));
+
+      if(d == 0)
+      {
+         m++;
+         continue;
+      }
+
+      coef = antilog301[(log301[d] + NN - log301[b]) % NN];
+      memcpy(tmp, lambda, sizeof(tmp));
+      for(j = 0; j + m <= MAX_ERROR_WORD_COUNT; j++)
+         lambda[j+m] = GfAdd(lambda[j+m], GfMult(coef, prev[j]));
+
+      if(2 * lambdaDeg <= i)
+      {
+         lambdaDeg = i + 1 - lambdaDeg;
+         memcpy(prev, tmp, sizeof(prev));
+         b = d;
+         m = 1;
+      }
+      else
+      {
+         m++;
+      }
+   }
+
+   /* Check words held in reserve are not spent on the repair */
+   errorDeg = lambdaDeg;
+   if(2 * errorDeg + erasureCount > blockErrorWords - RsMinCheckWords)
+      return DmtxFalse;
+
+   /* Combined locator psi(x) = lambda(x) * gamma(x) */
+   psiDeg = errorDeg + gammaDeg;
+   memset(psi, 0x00, sizeof(psi));
+   for(i = 0; i <= errorDeg; i++)
+      for(j = 0; j <= gammaDeg; j++)
+         psi[i+j] = GfAdd(psi[i+j], GfMult(lambda[i], gamma[j]));
+
+   /* Chien search: every root must fall inside the block */
+   for(foundCount = 0, k = 0; k < rec->length; k++)
+   {
+      xInv = antilog301[(NN - k) % NN];
+      for(value = 0, j = psiDeg; j >= 0; j--)
+         value = GfAdd(GfMult(value, xInv), psi[j]);
+
+      if(value == 0)
+      {
+         if(foundCount == psiDeg)
+            return DmtxFalse;
+         found[foundCount++] = k;
+      }
+   }
+
+   if(foundCount != psiDeg)
+      return DmtxFalse;
+
+   /* Error evaluator omega(x) = S(x) * psi(x) mod x^(blockErrorWords) */
+   for(i = 0; i < blockErrorWords; i++)
+   {
+      for(value = 0, j = 0; j <= min(i, psiDeg); j++)
+         value = GfAdd(value, GfMult(psi[j], syn->b[i-j+1]));
+      omega[i] = value;
+   }
+
+   /* Forney: value = omega(X^-1) / psi'(X^-1) */
+   memcpy(fixed, rec->b, rec->length);
+   for(fixedCount = 0, k = 0; k < foundCount; k++)
+   {
+      xInv = antilog301[(NN - found[k]) % NN];
+
+      for(num = 0, j = blockErrorWords - 1; j >= 0; j--)
+         num = GfAdd(GfMult(num, xInv), omega[j]);
+
+      /* Formal derivative keeps the odd powers only */
+      for(den = 0, j = psiDeg - (psiDeg % 2 == 0 ? 1 : 0); j >= 1; j -= 2)
+         den = GfAdd(GfMult(den, GfMult(xInv, xInv)), psi[j]);
+
+      if(den == 0)
+         return DmtxFalse;
+
+      if(num != 0)
+      {
+         value = antilog301[(log301[num] + NN - log301[den]) % NN];
+         fixed[found[k]] = GfAdd(fixed[found[k]], value);
+         fixedCount++;
+      }
+   }
+
+   if(maxFixed != DmtxUndefined && fixedCount > maxFixed)
+      return DmtxFalse;
+
+   /* Confirm the repaired block is a codeword before accepting it */
+   for(i = 1; i <= blockErrorWords; i++)
+   {
+      for(value = 0, j = 0; j < rec->length; j++)
+         value = GfAdd(value, GfMultAntilog(fixed[j], i*j));
+      if(value != 0)
+         return DmtxFalse;
+   }
+
+   memcpy(rec->b, fixed, rec->length);
+
+   return DmtxTrue;
+}
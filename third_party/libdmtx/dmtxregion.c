@@ -68,6 +68,7 @@ dmtxRegionFindNext(DmtxDecode *dec, DmtxTime *timeout)
       locStatus = PopGridLocation(&(dec->grid), &loc);
       if(locStatus == DmtxRangeEnd)
          break;
+      dec->stats.gridLocations++;
 
       /* Scan location for presence of valid barcode region */
       reg = dmtxRegionScanPixel(dec, loc.X, loc.Y);
@@ -107,6 +108,7 @@ dmtxRegionScanPixel(DmtxDecode *dec, int x, int y)
       return NULL;
 
    /* Test for presence of any reasonable edge at this location */
+   dec->stats.seekEdgeCalls++;
    flowBegin = MatrixRegionSeekEdge(dec, loc);
    if(flowBegin.mag < (int)(dec->edgeThresh * 7.65 + 0.5))
       return NULL;
@@ -114,30 +116,46 @@ dmtxRegionScanPixel(DmtxDecode *dec, int x, int y)
    memset(&reg, 0x00, sizeof(DmtxRegion));
 
    /* Determine barcode orientation */
-   if(MatrixRegionOrientation(dec, &reg, flowBegin) == DmtxFail)
-      return NULL;
-   if(dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail)
+   if(MatrixRegionOrientation(dec, &reg, flowBegin) == DmtxFail ||
+         dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail) {
+      dec->stats.failOrientation++;
+      DMTX_PROBE3(region__rejected, loc.X, loc.Y, DmtxRejectOrientation);
       return NULL;
+   }
 
    /* Define top edge */
-   if(MatrixRegionAlignCalibEdge(dec, &reg, DmtxEdgeTop) == DmtxFail)
-      return NULL;
-   if(dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail)
+   if(MatrixRegionAlignCalibEdge(dec, &reg, DmtxEdgeTop) == DmtxFail ||
+         dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail) {
+      dec->stats.failTopEdge++;
+      DMTX_PROBE3(region__rejected, loc.X, loc.Y, DmtxRejectTopEdge);
       return NULL;
+   }
 
    /* Define right edge */
-   if(MatrixRegionAlignCalibEdge(dec, &reg, DmtxEdgeRight) == DmtxFail)
-      return NULL;
-   if(dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail)
+   if(MatrixRegionAlignCalibEdge(dec, &reg, DmtxEdgeRight) == DmtxFail ||
+         dmtxRegionUpdateXfrms(dec, &reg) == DmtxFail) {
+      dec->stats.failRightEdge++;
+      DMTX_PROBE3(region__rejected, loc.X, loc.Y, DmtxRejectRightEdge);
       return NULL;
+   }
 
    CALLBACK_MATRIX(&reg);
 
    /* Calculate the best fitting symbol size */
-   if(MatrixRegionFindSize(dec, &reg) == DmtxFail)
+   if(MatrixRegionFindSize(dec, &reg) == DmtxFail) {
+      dec->stats.failFindSize++;
+      DMTX_PROBE3(region__rejected, loc.X, loc.Y, DmtxRejectFindSize);
       return NULL;
+   }
+
+   /* Integer edge walks are coarse at a few pixels per module, so the
+      outline is refined before modules are read */
+   if(dec->subPixel)
+      MatrixRegionRefineEdges(dec, &reg);
 
    /* Found a valid matrix region */
+   dec->stats.regionsFound++;
+   DMTX_PROBE3(region__found, loc.X, loc.Y, reg.sizeIdx);
    return dmtxRegionCreate(&reg);
 }
 
@@ -577,43 +595,229 @@ RightAngleTrueness(DmtxVector2 c0, DmtxVector2 c1, DmtxVector2 c2, double angle)
 }
 
 /**
- * \brief  Read color of Data Matrix module location
+ * \brief  Read the averaged colors of consecutive modules along a row or column
  * \param  dec
  * \param  reg
- * \param  symbolRow
- * \param  symbolCol
+ * \param  symbolRow Row of first module
+ * \param  symbolCol Column of first module
+ * \param  dir DmtxDirRight or DmtxDirUp
+ * \param  count Number of modules to read
  * \param  sizeIdx
- * \return Averaged module color
+ * \param  colorPlane
+ * \param  subPixel Interpolate samples bilinearly instead of rounding
+ * \param  colors Receives one averaged color per module
+ * \return void
+ *
+ * Each module color is the average of 5 samples taken around the module
+ * center. The sample points of the first module are transformed once and then
+ * stepped along the line in homogeneous coordinates, so each sample costs a
+ * few additions and one division instead of a full matrix multiply.
  */
-static int
-ReadModuleColor(DmtxDecode *dec, DmtxRegion *reg, int symbolRow, int symbolCol,
-      int sizeIdx, int colorPlane)
+static void
+ReadModuleColorLine(DmtxDecode *dec, DmtxRegion *reg, int symbolRow, int symbolCol,
+      DmtxDirection dir, int count, int sizeIdx, int colorPlane, int subPixel, int *colors)
 {
-   int err;
-   int i;
+   int i, k;
    int symbolRows, symbolCols;
    int color, colorTmp;
    double sampleX[] = { 0.5, 0.4, 0.5, 0.6, 0.5 };
    double sampleY[] = { 0.5, 0.5, 0.4, 0.5, 0.6 };
-   DmtxVector2 p;
+   double hX[5], hY[5], hW[5];
+   double stepX, stepY, stepW;
+   double fitX, fitY, dFitX, dFitY;
+   double x, y, w;
+
+   assert(dir == DmtxDirRight || dir == DmtxDirUp);
 
    symbolRows = dmtxGetSymbolAttribute(DmtxSymAttribSymbolRows, sizeIdx);
    symbolCols = dmtxGetSymbolAttribute(DmtxSymAttribSymbolCols, sizeIdx);
 
-   color = 0;
+   /* Homogeneous position of each sample point in the first module */
    for(i = 0; i < 5; i++) {
+      fitX = (1.0/symbolCols) * (symbolCol + sampleX[i]);
+      fitY = (1.0/symbolRows) * (symbolRow + sampleY[i]);
 
-      p.X = (1.0/symbolCols) * (symbolCol + sampleX[i]);
-      p.Y = (1.0/symbolRows) * (symbolRow + sampleY[i]);
+      hX[i] = fitX * reg->fit2raw[0][0] + fitY * reg->fit2raw[1][0] + reg->fit2raw[2][0];
+      hY[i] = fitX * reg->fit2raw[0][1] + fitY * reg->fit2raw[1][1] + reg->fit2raw[2][1];
+      hW[i] = fitX * reg->fit2raw[0][2] + fitY * reg->fit2raw[1][2] + reg->fit2raw[2][2];
+   }
 
-      dmtxMatrix3VMultiplyBy(&p, reg->fit2raw);
+   /* Homogeneous step between neighboring modules */
+   dFitX = (dir == DmtxDirRight) ? 1.0/symbolCols : 0.0;
+   dFitY = (dir == DmtxDirUp) ? 1.0/symbolRows : 0.0;
+
+   stepX = dFitX * reg->fit2raw[0][0] + dFitY * reg->fit2raw[1][0];
+   stepY = dFitX * reg->fit2raw[0][1] + dFitY * reg->fit2raw[1][1];
+   stepW = dFitX * reg->fit2raw[0][2] + dFitY * reg->fit2raw[1][2];
+
+   for(k = 0; k < count; k++) {
+      color = colorTmp = 0;
+      for(i = 0; i < 5; i++) {
+         w = hW[i] + k * stepW;
+         if(fabs(w) > DmtxAlmostZero) {
+            x = (hX[i] + k * stepX)/w;
+            y = (hY[i] + k * stepY)/w;
+            if(subPixel)
+               dmtxDecodeGetPixelValueBilinear(dec, x, y, colorPlane, &colorTmp);
+            else
+               dmtxDecodeGetPixelValue(dec, (int)(x + 0.5), (int)(y + 0.5),
+                     colorPlane, &colorTmp);
+         }
+         color += colorTmp;
+      }
+      colors[k] = color/5;
+   }
+}
+
+/**
+ * \brief  Refine the region outline to sub-pixel accuracy
+ *
+ * Samples across each of the 4 outer edges at every dark border module
+ * (all of the finder bars, alternate modules of the calibration bars),
+ * locates the on/off midpoint crossing by interpolation, fits a line to
+ * each edge and rebuilds the transforms from the line intersections. The
+ * region is left untouched if any edge cannot be refined.
+ * \param  dec
+ * \param  reg
+ * \return DmtxPass | DmtxFail
+ */
+static DmtxPassFail
+MatrixRegionRefineEdges(DmtxDecode *dec, DmtxRegion *reg)
+{
+   int edge, i, k, n, count;
+   int color, sPrev, s, colorMid, darkSign;
+   double offset, along, frac;
+   double mx, my, sxx, syy, sxy, angle;
+   DmtxVector2 pFit, pRaw, pts[DmtxModuleLineMax];
+   DmtxVector2 corners[4], expected[4];
+   DmtxRay2 rays[4];
+   DmtxMatrix3 fit2raw, raw2fit;
+
+   colorMid = (reg->onColor + reg->offColor) / 2;
+   darkSign = (reg->onColor > reg->offColor) ? 1 : -1;
+
+   /* Edges in order left, bottom, top, right */
+   for(edge = 0; edge < 4; edge++) {
+      n = (edge == 0 || edge == 3) ? reg->symbolRows : reg->symbolCols;
+
+      for(count = 0, i = 1; i < n - 1; i++) {
+
+         /* Calibration bars only touch the edge at even modules */
+         if(edge >= 2 && (i & 0x01) != 0)
+            continue;
 
-      err = dmtxDecodeGetPixelValue(dec, (int)(p.X + 0.5), (int)(p.Y + 0.5),
-            colorPlane, &colorTmp);
-      color += colorTmp;
+         along = (i + 0.5) / n;
+         sPrev = 0;
+
+         /* Step from half a module inside the edge to half a module outside */
+         for(k = 0; k <= DmtxRefineSteps; k++) {
+            offset = 0.5 - (double)k / DmtxRefineSteps;
+            RefineEdgeFitPoint(reg, edge, along, offset, &pFit);
+            dmtxMatrix3VMultiply(&pRaw, &pFit, reg->fit2raw);
+            if(dmtxDecodeGetPixelValueBilinear(dec, pRaw.X, pRaw.Y,
+                  reg->flowBegin.plane, &color) == DmtxFail)
+               break;
+
+            s = darkSign * (color - colorMid);
+            if(k == 0 && s <= 0)
+               break;
+
+            if(k > 0 && s <= 0) {
+               frac = (double)sPrev / (sPrev - s);
+               offset += (1.0 - frac) / DmtxRefineSteps;
+               RefineEdgeFitPoint(reg, edge, along, offset, &pFit);
+               dmtxMatrix3VMultiply(&pts[count++], &pFit, reg->fit2raw);
+               break;
+            }
+            sPrev = s;
+         }
+      }
+
+      if(count < 3)
+         return DmtxFail;
+
+      /* Least squares line through the edge points */
+      mx = my = 0.0;
+      for(i = 0; i < count; i++) {
+         mx += pts[i].X;
+         my += pts[i].Y;
+      }
+      mx /= count;
+      my /= count;
+
+      sxx = syy = sxy = 0.0;
+      for(i = 0; i < count; i++) {
+         sxx += (pts[i].X - mx) * (pts[i].X - mx);
+         syy += (pts[i].Y - my) * (pts[i].Y - my);
+         sxy += (pts[i].X - mx) * (pts[i].Y - my);
+      }
+      angle = 0.5 * atan2(2.0 * sxy, sxx - syy);
+
+      rays[edge].p.X = mx;
+      rays[edge].p.Y = my;
+      rays[edge].v.X = cos(angle);
+      rays[edge].v.Y = sin(angle);
+   }
+
+   /* Corners p00, p10, p11, p01 from neighboring edges */
+   if(dmtxRay2Intersect(&corners[0], &rays[0], &rays[1]) == DmtxFail ||
+         dmtxRay2Intersect(&corners[1], &rays[1], &rays[3]) == DmtxFail ||
+         dmtxRay2Intersect(&corners[2], &rays[3], &rays[2]) == DmtxFail ||
+         dmtxRay2Intersect(&corners[3], &rays[2], &rays[0]) == DmtxFail)
+      return DmtxFail;
+
+   /* Refinement should never move a corner by half a module or more */
+   for(i = 0; i < 4; i++) {
+      expected[i].X = (i == 1 || i == 2) ? 1.0 : 0.0;
+      expected[i].Y = (i >= 2) ? 1.0 : 0.0;
+      dmtxMatrix3VMultiply(&pFit, &corners[i], reg->raw2fit);
+      if(fabs(pFit.X - expected[i].X) * reg->symbolCols >= 0.5 ||
+            fabs(pFit.Y - expected[i].Y) * reg->symbolRows >= 0.5)
+         return DmtxFail;
+   }
+
+   dmtxMatrix3Copy(fit2raw, reg->fit2raw);
+   dmtxMatrix3Copy(raw2fit, reg->raw2fit);
+
+   if(dmtxRegionUpdateCorners(dec, reg, corners[0], corners[1], corners[2], corners[3]) == DmtxFail) {
+      dmtxMatrix3Copy(reg->fit2raw, fit2raw);
+      dmtxMatrix3Copy(reg->raw2fit, raw2fit);
+      return DmtxFail;
    }
 
-   return color/5;
+   return DmtxPass;
+}
+
+/**
+ * \brief  Locate a point near one of the outer edges in fitted coordinates
+ * \param  reg
+ * \param  edge 0 left, 1 bottom, 2 top, 3 right
+ * \param  along Position along the edge (0.0 - 1.0)
+ * \param  offset Distance inside the edge, in modules
+ * \param  p Fitted point
+ * \return void
+ */
+static void
+RefineEdgeFitPoint(DmtxRegion *reg, int edge, double along, double offset, DmtxVector2 *p)
+{
+   switch(edge) {
+      case 0:
+         p->X = offset / reg->symbolCols;
+         p->Y = along;
+         break;
+      case 1:
+         p->X = along;
+         p->Y = offset / reg->symbolRows;
+         break;
+      case 2:
+         p->X = along;
+         p->Y = 1.0 - offset / reg->symbolRows;
+         break;
+      default:
+         p->X = 1.0 - offset / reg->symbolCols;
+         p->Y = along;
+         break;
+   }
 }
 
 /**
@@ -634,6 +838,7 @@ MatrixRegionFindSize(DmtxDecode *dec, DmtxRegion *reg)
    int colorOnAvg, bestColorOnAvg;
    int colorOffAvg, bestColorOffAvg;
    int contrast, bestContrast;
+   int colors[DmtxModuleLineMax];
    DmtxImage *img;
 
    img = dec->image;
@@ -667,8 +872,10 @@ MatrixRegionFindSize(DmtxDecode *dec, DmtxRegion *reg)
 
       /* Sum module colors along horizontal calibration bar */
       row = symbolRows - 1;
+      ReadModuleColorLine(dec, reg, row, 0, DmtxDirRight, symbolCols, sizeIdx,
+            reg->flowBegin.plane, DmtxFalse, colors);
       for(col = 0; col < symbolCols; col++) {
-         color = ReadModuleColor(dec, reg, row, col, sizeIdx, reg->flowBegin.plane);
+         color = colors[col];
          if((col & 0x01) != 0x00)
             colorOffAvg += color;
          else
@@ -677,8 +884,10 @@ MatrixRegionFindSize(DmtxDecode *dec, DmtxRegion *reg)
 
       /* Sum module colors along vertical calibration bar */
       col = symbolCols - 1;
+      ReadModuleColorLine(dec, reg, 0, col, DmtxDirUp, symbolRows, sizeIdx,
+            reg->flowBegin.plane, DmtxFalse, colors);
       for(row = 0; row < symbolRows; row++) {
-         color = ReadModuleColor(dec, reg, row, col, sizeIdx, reg->flowBegin.plane);
+         color = colors[row];
          if((row & 0x01) != 0x00)
             colorOffAvg += color;
          else
@@ -775,6 +984,8 @@ CountJumpTally(DmtxDecode *dec, DmtxRegion *reg, int xStart, int yStart, DmtxDir
    int tModule, tPrev;
    int darkOnLight;
    int color;
+   int count, idx;
+   int colors[DmtxModuleLineMax];
 
    assert(xStart == 0 || yStart == 0);
    assert(dir == DmtxDirRight || dir == DmtxDirUp);
@@ -790,8 +1001,15 @@ CountJumpTally(DmtxDecode *dec, DmtxRegion *reg, int xStart, int yStart, DmtxDir
 
    darkOnLight = (int)(reg->offColor > reg->onColor);
    jumpThreshold = abs((int)(0.4 * (reg->onColor - reg->offColor) + 0.5));
-   color = ReadModuleColor(dec, reg, yStart, xStart, reg->sizeIdx, reg->flowBegin.plane);
+
+   count = (dir == DmtxDirRight) ? reg->symbolCols - xStart : reg->symbolRows - yStart;
+   assert(count <= DmtxModuleLineMax);
+   ReadModuleColorLine(dec, reg, yStart, xStart, dir, count, reg->sizeIdx,
+         reg->flowBegin.plane, DmtxFalse, colors);
+
+   color = colors[0];
    tModule = (darkOnLight) ? reg->offColor - color : color - reg->offColor;
+   idx = 1;
 
    for(x = xStart + xInc, y = yStart + yInc;
          (dir == DmtxDirRight && x < reg->symbolCols) ||
@@ -799,7 +1017,7 @@ CountJumpTally(DmtxDecode *dec, DmtxRegion *reg, int xStart, int yStart, DmtxDir
          x += xInc, y += yInc) {
 
       tPrev = tModule;
-      color = ReadModuleColor(dec, reg, y, x, reg->sizeIdx, reg->flowBegin.plane);
+      color = colors[idx++];
       tModule = (darkOnLight) ? reg->offColor - color : color - reg->offColor;
 
       if(state == DmtxModuleOff) {
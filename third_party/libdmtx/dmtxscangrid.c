@@ -20,19 +20,57 @@ static DmtxScanGrid
 InitScanGrid(DmtxDecode *dec)
 {
    int scale, smallestFeature;
+
+   scale = dmtxDecodeGetProp(dec, DmtxPropScale);
+   smallestFeature = dmtxDecodeGetProp(dec, DmtxPropScanGap) / scale;
+
+   return InitScanGridBounds(
+         dmtxDecodeGetProp(dec, DmtxPropXmin),
+         dmtxDecodeGetProp(dec, DmtxPropXmax),
+         dmtxDecodeGetProp(dec, DmtxPropYmin),
+         dmtxDecodeGetProp(dec, DmtxPropYmax),
+         smallestFeature);
+}
+
+/**
+ * \brief  Initialize the scan grid pattern that dmtxDecodeCreate() and
+ *         dmtxDecodeSetProp() would for an image of this size, so that it can
+ *         be computed once and passed to dmtxDecodeCreateWithSettings() for
+ *         every image of the same size
+ * \param  width Unscaled image width
+ * \param  height Unscaled image height
+ * \param  scale
+ * \param  scanGap
+ * \return Initialized grid
+ */
+extern DmtxScanGrid
+dmtxScanGridCreate(int width, int height, int scale, int scanGap)
+{
+   return InitScanGridBounds(0, width / scale - 1, 0, height / scale - 1, scanGap / scale);
+}
+
+/**
+ * \brief  Initialize scan grid pattern over scaled image bounds
+ * \param  xMin
+ * \param  xMax
+ * \param  yMin
+ * \param  yMax
+ * \param  smallestFeature
+ * \return Initialized grid
+ */
+static DmtxScanGrid
+InitScanGridBounds(int xMin, int xMax, int yMin, int yMax, int smallestFeature)
+{
    int xExtent, yExtent, maxExtent;
    int extent;
    DmtxScanGrid grid;
 
    memset(&grid, 0x00, sizeof(DmtxScanGrid));
 
-   scale = dmtxDecodeGetProp(dec, DmtxPropScale);
-   smallestFeature = dmtxDecodeGetProp(dec, DmtxPropScanGap) / scale;
-
-   grid.xMin = dmtxDecodeGetProp(dec, DmtxPropXmin);
-   grid.xMax = dmtxDecodeGetProp(dec, DmtxPropXmax);
-   grid.yMin = dmtxDecodeGetProp(dec, DmtxPropYmin);
-   grid.yMax = dmtxDecodeGetProp(dec, DmtxPropYmax);
+   grid.xMin = xMin;
+   grid.xMax = xMax;
+   grid.yMin = yMin;
+   grid.yMax = yMax;
 
    /* Values that get set once */
    xExtent = grid.xMax - grid.xMin;
@@ -17,6 +17,13 @@
 #define DmtxAlmostZero          0.000001
 #define DmtxAlmostInfinity            -1
 
+#define DmtxUnsureTallyMargin      0.15 /* Module tally ratio this close to 0.5 is unsure */
+#define DmtxUnsureColorMargin      0.25 /* Module color this close to midpoint (of half contrast) is unsure */
+
+#define DmtxRefineSteps                 8 /* Samples per module across an edge when refining */
+
+#define DmtxModuleLineMax            146 /* Largest symbol plus surrounding modules */
+
 #define DmtxValueC40Latch            230
 #define DmtxValueTextLatch           239
 #define DmtxValueX12Latch            238
@@ -55,6 +62,18 @@
 #undef max
 #define max(X,Y) (((X) > (Y)) ? (X) : (Y))
 
+/* USDT probes in the "libdmtx" provider, for bpftrace or perf, compiled in when
+   HAVE_SYS_SDT_H is defined:
+     region__found(int x, int y, int sizeIdx)
+     region__rejected(int x, int y, int stage), stage is a DmtxRejectStage
+     rs__corrections(int sizeIdx, int corrected, int passFail) */
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define DMTX_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(libdmtx, name, a1, a2, a3)
+#else
+#define DMTX_PROBE3(name, a1, a2, a3)
+#endif
+
 typedef enum {
    DmtxEncodeNormal,  /* Use normal scheme behavior (e.g., ASCII auto) */
    DmtxEncodeCompact, /* Use only compact format within scheme */
@@ -67,6 +86,13 @@ typedef enum {
    DmtxRangeEnd
 } DmtxRange;
 
+typedef enum {
+   DmtxRejectOrientation = 1,
+   DmtxRejectTopEdge,
+   DmtxRejectRightEdge,
+   DmtxRejectFindSize
+} DmtxRejectStage;
+
 typedef enum {
    DmtxEdgeTop               = 0x01 << 0,
    DmtxEdgeBottom            = 0x01 << 1,
@@ -126,8 +152,10 @@ static double RightAngleTrueness(DmtxVector2 c0, DmtxVector2 c1, DmtxVector2 c2,
 static DmtxPointFlow MatrixRegionSeekEdge(DmtxDecode *dec, DmtxPixelLoc loc0);
 static DmtxPassFail MatrixRegionOrientation(DmtxDecode *dec, DmtxRegion *reg, DmtxPointFlow flowBegin);
 static long DistanceSquared(DmtxPixelLoc a, DmtxPixelLoc b);
-static int ReadModuleColor(DmtxDecode *dec, DmtxRegion *reg, int symbolRow, int symbolCol, int sizeIdx, int colorPlane);
+static void ReadModuleColorLine(DmtxDecode *dec, DmtxRegion *reg, int symbolRow, int symbolCol, DmtxDirection dir, int count, int sizeIdx, int colorPlane, int subPixel, int *colors);
 
+static DmtxPassFail MatrixRegionRefineEdges(DmtxDecode *dec, DmtxRegion *reg);
+static void RefineEdgeFitPoint(DmtxRegion *reg, int edge, double along, double offset, DmtxVector2 *p);
 static DmtxPassFail MatrixRegionFindSize(DmtxDecode *dec, DmtxRegion *reg);
 static int CountJumpTally(DmtxDecode *dec, DmtxRegion *reg, int xStart, int yStart, DmtxDirection dir);
 static DmtxPointFlow GetPointFlow(DmtxDecode *dec, int colorPlane, DmtxPixelLoc loc, int arrive);
@@ -149,8 +177,10 @@ static DmtxPassFail BresLineStep(DmtxBresLine *line, int travel, int outward);
 /*static void WriteDiagnosticImage(DmtxDecode *dec, DmtxRegion *reg, char *imagePath);*/
 
 /* dmtxdecode.c */
-static void TallyModuleJumps(DmtxDecode *dec, DmtxRegion *reg, int tally[][24], int xOrigin, int yOrigin, int mapWidth, int mapHeight, DmtxDirection dir);
+static DmtxDecode *DecodeAlloc(DmtxImage *img, int scale);
+static void TallyModuleJumps(DmtxRegion *reg, int *moduleColors, int tally[][24], int xOrigin, int yOrigin, int mapWidth, int mapHeight, DmtxDirection dir);
 static DmtxPassFail PopulateArrayFromMatrix(DmtxDecode *dec, DmtxRegion *reg, DmtxMessage *msg);
+static unsigned char *CountUnsureModules(DmtxMessage *msg, int sizeIdx);
 
 /* dmtxdecodescheme.c */
 static void DecodeDataStream(DmtxMessage *msg, int sizeIdx, unsigned char *outputStart);
@@ -181,15 +211,18 @@ static void PlaceModule(unsigned char *modules, int mappingRows, int mappingCols
 
 /* dmtxreedsol.c */
 static DmtxPassFail RsEncode(DmtxMessage *message, int sizeIdx);
-static DmtxPassFail RsDecode(unsigned char *code, int sizeIdx, int fix);
+static DmtxPassFail RsDecode(unsigned char *code, const unsigned char *unsure, int sizeIdx, int fix, int *corrected);
 static DmtxPassFail RsGenPoly(DmtxByteList *gen, int errorWordCount);
 static DmtxBoolean RsComputeSyndromes(DmtxByteList *syn, const DmtxByteList *rec, int blockErrorWords);
 static DmtxBoolean RsFindErrorLocatorPoly(DmtxByteList *elp, const DmtxByteList *syn, int errorWordCount, int maxCorrectable);
 static DmtxBoolean RsFindErrorLocations(DmtxByteList *loc, const DmtxByteList *elp);
 static DmtxPassFail RsRepairErrors(DmtxByteList *rec, const DmtxByteList *loc, const DmtxByteList *elp, const DmtxByteList *syn);
+static DmtxBoolean RsRepairErasures(DmtxByteList *rec, const DmtxByte *recUnsure, const DmtxByteList *syn, int blockErrorWords, int maxFixed);
+static DmtxBoolean RsCorrectErasures(DmtxByteList *rec, const int *erasures, int erasureCount, const DmtxByteList *syn, int blockErrorWords, int maxFixed);
 
 /* dmtxscangrid.c */
 static DmtxScanGrid InitScanGrid(DmtxDecode *dec);
+static DmtxScanGrid InitScanGridBounds(int xMin, int xMax, int yMin, int yMax, int smallestFeature);
 static int PopGridLocation(DmtxScanGrid *grid, /*@out@*/ DmtxPixelLoc *locPtr);
 static int GetGridCoordinates(DmtxScanGrid *grid, /*@out@*/ DmtxPixelLoc *locPtr);
 static void SetDerivedFields(DmtxScanGrid *grid);